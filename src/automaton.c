@@ -11,6 +11,11 @@
 #include "parse_args.h"
 #include "cellular.h"
 #include "interactive.h"
+#include "engine.h"
+#include "frame.h"
+#include "mapped.h"
+#include "numa.h"
+#include "replicas.h"
 #include <string.h>
 
 /**
@@ -78,11 +83,16 @@ InitialState ReadStdin(struct Arguments *arguments ){
         // this function keeps the newline in the string 
         // to be able to verify if all row & col length are correct.
 
-        strcat(initialState_With_Newline,strncpy(substring2, ReadState, strlen(ReadState)));
+        size_t length = strlen(ReadState);
+        memcpy(substring2, ReadState, length);
+        substring2[length] = '\0';
+        strcat(initialState_With_Newline, substring2);
 
         //This function is used to remove newlines in the initial state
 
-        strcat(initialState,strncpy(substring, ReadState, strlen(ReadState)-1));
+        memcpy(substring, ReadState, length - 1);
+        substring[length - 1] = '\0';
+        strcat(initialState, substring);
 
        // the lenght of the row gives us the number of columns
        // we can compare this value to the lenght of other rows to see if evrything is correct.
@@ -113,6 +123,9 @@ InitialState ReadStdin(struct Arguments *arguments ){
             }
 
         }
+        cellularArray.row=row;
+        cellularArray.col=col;
+
         //Updating arguments rows and cols in the arguments.
         arguments->num_cols=col;
         arguments->num_rows=row;
@@ -122,23 +135,222 @@ InitialState ReadStdin(struct Arguments *arguments ){
  return cellularArray;
 }
 
+/**
+ * Stores the cells of an automaton with the layout chosen by the user.
+ *
+ * @param automaton  The automaton, freed if it is converted
+ * @param layout     The layout
+ * @return           The automaton with the layout
+ */
+struct CellularAutomaton *set_layout(struct CellularAutomaton *automaton,
+                                     enum CellularLayout layout) {
+    if (automaton->layout == layout) return automaton;
+    struct CellularAutomaton *copy = Cellular_duplicate_as(automaton, layout);
+    Cellular_free(automaton);
+    return copy;
+}
+
+/**
+ * Prints on stderr the statistics of the steps just computed by an engine.
+ *
+ * @param engine  The engine
+ * @param before  The tiles counted by the engine before these steps
+ * @param step    The last step computed
+ */
+void print_step_stats(const struct Engine *engine,
+                      const struct EngineStats *before,
+                      unsigned int step) {
+    struct EngineStats steps = {
+        engine->all_steps.num_active_tiles - before->num_active_tiles,
+        engine->all_steps.num_tiles - before->num_tiles
+    };
+    fprintf(stderr, "Step %d: %.1f%% of the tiles updated\n", step,
+            100 * Engine_active_fraction(&steps));
+    if (engine->type == ENGINE_MEMOIZED) {
+        struct MemoStats cache;
+        Engine_get_cache_stats(engine, &cache);
+        fprintf(stderr, "Step %d: %.1f%% of the tiles found in the "
+                "cache, %lu entries (%zu kB)\n", step,
+                cache.num_lookups > 0 ?
+                100.0 * cache.num_hits / cache.num_lookups : 0.0,
+                cache.num_entries, cache.memory_size / 1024);
+    }
+}
+
+/**
+ * Prints the successive states of a simulation to stdout.
+ *
+ * The steps are computed by an engine, which is only asked for the cells of
+ * the automaton when they are printed. Each printed step is formatted as a
+ * frame, written at once, and the steps between two printed ones are asked
+ * to the engine at once, so that the Hashlife, blocked and multi-process
+ * engines jump over them.
+ *
+ * @param automaton  The initial automaton
+ * @param arguments  The arguments given by the user
+ */
+void print_simulation(const struct CellularAutomaton *automaton,
+                      const struct Arguments *arguments) {
+    struct Engine *engine = Engine_init(automaton, arguments->engine,
+                                        arguments->num_threads);
+    Engine_set_block_depth(engine, arguments->block_depth);
+    if (arguments->numa) {
+        Engine_place(engine);
+    }
+    if (arguments->stats) {
+        Engine_print_placement(engine, stderr);
+    }
+    struct Frame *frame = Frame_init(arguments->num_threads);
+    unsigned int step = 0;
+    for (unsigned int printed = next_printed_step(arguments, 0);
+         printed < arguments->num_steps;
+         printed = next_printed_step(arguments, printed + 1)) {
+        if (printed > step) {
+            struct EngineStats before = engine->all_steps;
+            Engine_step(engine, printed - step);
+            if (engine->has_failed) {
+                fprintf(stderr, "Error: a worker process failed\n");
+                break;
+            }
+            if (arguments->stats) {
+                print_step_stats(engine, &before, printed - 1);
+            }
+            step = printed;
+        }
+        Frame_printf(frame, "Step %d\n", step);
+        Frame_add_grid(frame, Engine_get(engine));
+        Frame_write(frame, stdout);
+    }
+    Frame_free(frame);
+    Engine_free(engine);
+}
+
+/**
+ * Prints the successive states of a random simulation whose grids are mapped
+ * from files to stdout.
+ *
+ * @param arguments  The arguments given by the user
+ * @return           The status of the simulation
+ */
+enum Status print_mapped_simulation(const struct Arguments *arguments) {
+    struct Rule *rule = arguments->rule != NULL
+                      ? Rule_parse_life(arguments->rule) : NULL;
+    struct Mapped *mapped = Mapped_init(arguments->mapped_directory,
+                                        arguments->num_rows,
+                                        arguments->num_cols,
+                                        arguments->type,
+                                        arguments->boundary,
+                                        arguments->allowed_cells,
+                                        rule,
+                                        arguments->num_threads);
+    if (rule != NULL) Rule_free(rule);
+    if (mapped == NULL) {
+        fprintf(stderr, "Error: the grids cannot be mapped in %s\n",
+                arguments->mapped_directory);
+        return TP2_WRONG_DIRECTORY;
+    }
+    Mapped_set_random(mapped, arguments->distribution, arguments->seed);
+    unsigned int step = 0;
+    for (unsigned int printed = next_printed_step(arguments, 0);
+         printed < arguments->num_steps;
+         printed = next_printed_step(arguments, printed + 1)) {
+        Mapped_step(mapped, printed - step);
+        step = printed;
+        printf("Step %d\n", step);
+        Mapped_print(mapped);
+    }
+    Mapped_free(mapped);
+    return TP2_OK;
+}
+
+/**
+ * Prints the statistics of the populations of random replicas of a
+ * simulation to stdout, step by step.
+ *
+ * Each step prints a line per state: the step, the cell, then the mean, the
+ * minimum, the quartiles and the maximum of the number of cells in the state
+ * over the replicas. The grids of the last step follow if requested.
+ *
+ * @param arguments  The arguments given by the user
+ * @return           The status of the simulation
+ */
+enum Status print_replicas(const struct Arguments *arguments) {
+    struct CellularAutomaton *model = Cellular_init(arguments->num_rows,
+                                                    arguments->num_cols,
+                                                    arguments->type,
+                                                    arguments->boundary,
+                                                    arguments->allowed_cells);
+    if (arguments->rule != NULL) {
+        Cellular_set_rule(model, arguments->rule);
+    }
+    struct Replicas *replicas = Replicas_init(model, arguments->distribution,
+                                              arguments->num_members,
+                                              arguments->seed,
+                                              arguments->num_threads);
+    printf("# Replicas: %u, seed: %llu\n", arguments->num_members,
+           (unsigned long long)arguments->seed);
+    printf("# step cell mean min q1 median q3 max\n");
+    unsigned int step = 0;
+    for (unsigned int printed = next_printed_step(arguments, 0);
+         printed < arguments->num_steps;
+         printed = next_printed_step(arguments, printed + 1)) {
+        Replicas_step(replicas, printed - step);
+        step = printed;
+        for (unsigned int state = 0; state < replicas->num_states; ++state) {
+            struct ReplicasStats stats;
+            Replicas_get_stats(replicas, state, &stats);
+            printf("%u %c %.2f %lu %lu %lu %lu %lu\n", step,
+                   arguments->allowed_cells[state], stats.mean, stats.min,
+                   stats.first_quartile, stats.median, stats.third_quartile,
+                   stats.max);
+        }
+    }
+    if (arguments->final_grids) {
+        if (arguments->num_steps > step + 1) {
+            Replicas_step(replicas, arguments->num_steps - 1 - step);
+        }
+        for (unsigned int r = 0; r < arguments->num_members; ++r) {
+            printf("Replica %u\n", r);
+            Replicas_store(replicas, r, model);
+            Cellular_print(model, false);
+        }
+    }
+    Replicas_free(replicas);
+    Cellular_free(model);
+    return TP2_OK;
+}
+
 int main(int argc, char **argv) {
     struct Arguments *arguments = parse_arguments(argc, argv); //takes the arguments in the structure
     if (arguments->status != TP2_OK) {  //if it fails
         return arguments->status;
+    }
+    Numa_set_huge_pages(arguments->huge_pages);
+    if (arguments->mapped_directory != NULL) {
+        enum Status status = print_mapped_simulation(arguments);
+        free_arguments(arguments);
+        return status;
+    } else if (arguments->num_members > 0) {
+        enum Status status = print_replicas(arguments);
+        free_arguments(arguments);
+        return status;
     } else if (arguments->initialState) // if there is an initial state
     {
         InitialState cellularArray=ReadStdin(arguments);
+        Cellular_Valid_StateCells(arguments->allowed_cells,&cellularArray);
         
-        struct CellularAutomaton *automaton, *next; //next here means the next automaton step
+        struct CellularAutomaton *automaton;
         automaton = Cellular_init_with_state(arguments->num_rows, //initialisation of automaton, takes all the arguments
                                   arguments->num_cols, //num_rows and  num_cols are not set if --stdin is set
                                   arguments->type,
                                   arguments->boundary,
                                   arguments->allowed_cells,
                                   cellularArray);
+        if (arguments->rule != NULL) {
+            Cellular_set_rule(automaton, arguments->rule);
+        }
+        automaton = set_layout(automaton, arguments->layout);
 
-        Cellular_Valid_StateCells(arguments->allowed_cells,automaton);
         
         if (arguments->interactive) { //if the interactive mod is choosen
         freopen("/dev/tty", "rw", stdin);
@@ -148,39 +360,37 @@ int main(int argc, char **argv) {
             Interactive_free(application);
      
         } else { //if not
-            for (unsigned int step = 0; step < arguments->num_steps; ++step) {
-                printf("Step %d\n", step);
-                Cellular_print(automaton, false);// prints the State initialisation of automaton
-                next = Cellular_next(automaton);
-                Cellular_free(automaton);
-                automaton = next;
-            }
+            print_simulation(automaton, arguments);
         }
         Cellular_free(automaton);   
 
 
     
     } else {//if it pass
-        struct CellularAutomaton *automaton, *next; 
+        struct CellularAutomaton *automaton;
         automaton = Cellular_init(arguments->num_rows, 
                                   arguments->num_cols, 
                                   arguments->type,
                                   arguments->boundary,
                                   arguments->allowed_cells);
-        Cellular_set_random(automaton, arguments->distribution); //creates a random initial state
+        //creates a random initial state
+        Cellular_set_random_seeded(automaton, arguments->distribution,
+                                   arguments->seed, arguments->num_threads);
+        if (arguments->stats) {
+            fprintf(stderr, "Seed: %llu\n",
+                    (unsigned long long)arguments->seed);
+        }
+        if (arguments->rule != NULL) {
+            Cellular_set_rule(automaton, arguments->rule);
+        }
+        automaton = set_layout(automaton, arguments->layout);
         if (arguments->interactive) { //if the interactive mod is choosen
             struct InteractiveApplication *application =
                 Interactive_init(automaton, arguments->num_steps);
             Interactive_run(application);
             Interactive_free(application);
         } else { //if not
-            for (unsigned int step = 0; step < arguments->num_steps; ++step) {
-                printf("Step %d\n", step);
-                Cellular_print(automaton, false);// prints the random initialisation of automaton
-                next = Cellular_next(automaton);
-                Cellular_free(automaton);
-                automaton = next;
-            }
+            print_simulation(automaton, arguments);
         }
         Cellular_free(automaton);
     }
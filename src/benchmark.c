@@ -0,0 +1,264 @@
+/**
+ * Measures the throughput of a simulation.
+ *
+ * The accepted arguments are the same as for the main program. The automaton
+ * is randomly initialized and then updated `num_steps` times without printing
+ * anything. Only the elapsed time and the throughput are reported. With the
+ * generic engine, the simulation is run once per neighbor-counting kernel
+ * supported by the processor. With `--ensemble`, random grids are stepped
+ * together, bit-sliced, then one at a time by the engine.
+ *
+ * E.g.: bin/benchmark -r 4096 -c 4096 -n 100
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "parse_args.h"
+#include "cellular.h"
+#include "engine.h"
+#include "ensemble.h"
+#include "mapped.h"
+#include "numa.h"
+#include "random.h"
+#include "stencil.h"
+
+/**
+ * Returns the current time, in seconds.
+ *
+ * @return  The time given by a monotonic clock
+ */
+double benchmark_now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/**
+ * Runs a simulation with an engine and prints its throughput.
+ *
+ * @param automaton  The initial automaton
+ * @param arguments  The arguments given by the user
+ */
+void benchmark_run(const struct CellularAutomaton *automaton,
+                   const struct Arguments *arguments) {
+    unsigned int num_steps = arguments->num_steps;
+    struct Engine *engine = Engine_init(automaton, arguments->engine,
+                                        arguments->num_threads);
+    Engine_set_block_depth(engine, arguments->block_depth);
+    if (arguments->numa) {
+        Engine_place(engine);
+    }
+    if (arguments->stats) {
+        Engine_print_placement(engine, stderr);
+    }
+
+    double start = benchmark_now();
+    Engine_step(engine, num_steps);
+    Engine_get(engine);
+    double elapsed = benchmark_now() - start;
+    if (engine->has_failed) {
+        fprintf(stderr, "Error: a worker process failed\n");
+        Engine_free(engine);
+        return;
+    }
+
+    double num_cells = (double)automaton->num_rows * automaton->num_cols
+                     * num_steps;
+    if (engine->type == ENGINE_BLOCKED) {
+        printf("Engine:     %s (%s, depth %u)\n", Engine_name(engine),
+               Stencil_name(Stencil_current()), engine->blocking->depth);
+    } else if (engine->type == ENGINE_GENERIC ||
+               engine->type == ENGINE_TILED) {
+        printf("Engine:     %s (%s)\n", Engine_name(engine),
+               Stencil_name(Stencil_current()));
+    } else {
+        printf("Engine:     %s\n", Engine_name(engine));
+    }
+    printf("Time:       %.3f s\n", elapsed);
+    printf("Throughput: %.2f Mcells/s\n",
+           elapsed > 0 ? num_cells / elapsed * 1e-6 : 0.0);
+    if (engine->type == ENGINE_TILED) {
+        printf("Updated:    %.1f%% of the tiles\n",
+               100 * Engine_active_fraction(&engine->all_steps));
+    } else if (engine->type == ENGINE_MEMOIZED) {
+        struct MemoStats cache;
+        Engine_get_cache_stats(engine, &cache);
+        printf("Cache:      %.1f%% hits, %lu entries (%zu kB)\n",
+               cache.num_lookups > 0 ?
+               100.0 * cache.num_hits / cache.num_lookups : 0.0,
+               cache.num_entries, cache.memory_size / 1024);
+    }
+    Engine_free(engine);
+}
+
+/**
+ * Runs a simulation whose grids are mapped from files and prints its
+ * throughput.
+ *
+ * @param arguments  The arguments given by the user
+ * @return           The status of the simulation
+ */
+enum Status benchmark_mapped(const struct Arguments *arguments) {
+    struct Rule *rule = arguments->rule != NULL
+                      ? Rule_parse_life(arguments->rule) : NULL;
+    struct Mapped *mapped = Mapped_init(arguments->mapped_directory,
+                                        arguments->num_rows,
+                                        arguments->num_cols,
+                                        arguments->type,
+                                        arguments->boundary,
+                                        arguments->allowed_cells,
+                                        rule,
+                                        arguments->num_threads);
+    if (rule != NULL) Rule_free(rule);
+    if (mapped == NULL) {
+        fprintf(stderr, "Error: the grids cannot be mapped in %s\n",
+                arguments->mapped_directory);
+        return TP2_WRONG_DIRECTORY;
+    }
+    Mapped_set_random(mapped, arguments->distribution, arguments->seed);
+
+    double start = benchmark_now();
+    Mapped_step(mapped, arguments->num_steps);
+    double elapsed = benchmark_now() - start;
+
+    double num_cells = (double)mapped->num_rows * mapped->num_cols
+                     * arguments->num_steps;
+    printf("Engine:     mapped (%s, %s)\n", arguments->mapped_directory,
+           Stencil_name(Stencil_current()));
+    printf("Time:       %.3f s\n", elapsed);
+    printf("Throughput: %.2f Mcells/s\n",
+           elapsed > 0 ? num_cells / elapsed * 1e-6 : 0.0);
+    Mapped_free(mapped);
+    return TP2_OK;
+}
+
+/**
+ * Runs random simulations stepped together in an ensemble, then one at a time
+ * by the engine, and prints their throughputs.
+ *
+ * @param arguments  The arguments given by the user
+ * @return           The status of the simulations
+ */
+enum Status benchmark_ensemble(const struct Arguments *arguments) {
+    unsigned int num_members = arguments->num_members;
+    struct CellularAutomaton **members =
+        malloc(num_members * sizeof(struct CellularAutomaton*));
+    for (unsigned int m = 0; m < num_members; ++m) {
+        members[m] = Cellular_init(arguments->num_rows, arguments->num_cols,
+                                   arguments->type, arguments->boundary,
+                                   arguments->allowed_cells);
+        Cellular_set_random_seeded(members[m], arguments->distribution,
+                                   Random_get(arguments->seed, m), 1);
+        if (arguments->rule != NULL) {
+            Cellular_set_rule(members[m], arguments->rule);
+        }
+    }
+    printf("Grids:      %u\n", num_members);
+
+    struct Ensemble *ensemble =
+        Ensemble_init((const struct CellularAutomaton *const *)members,
+                      num_members);
+    double start = benchmark_now();
+    for (unsigned int step = 0; step < arguments->num_steps; ++step) {
+        Ensemble_step(ensemble);
+    }
+    double elapsed = benchmark_now() - start;
+    Ensemble_free(ensemble);
+    double num_cells = (double)arguments->num_rows * arguments->num_cols
+                     * arguments->num_steps * num_members;
+    printf("Engine:     ensemble (%s)\n", Stencil_name(Stencil_current()));
+    printf("Time:       %.3f s\n", elapsed);
+    printf("Throughput: %.2f Mcells/s\n",
+           elapsed > 0 ? num_cells / elapsed * 1e-6 : 0.0);
+
+    // The same grids, one at a time
+    const char *name = NULL;
+    start = benchmark_now();
+    for (unsigned int m = 0; m < num_members; ++m) {
+        struct Engine *engine = Engine_init(members[m], arguments->engine,
+                                            arguments->num_threads);
+        Engine_step(engine, arguments->num_steps);
+        Engine_get(engine);
+        name = Engine_name(engine);
+        Engine_free(engine);
+    }
+    elapsed = benchmark_now() - start;
+    printf("Engine:     %s (one grid at a time)\n", name);
+    printf("Time:       %.3f s\n", elapsed);
+    printf("Throughput: %.2f Mcells/s\n",
+           elapsed > 0 ? num_cells / elapsed * 1e-6 : 0.0);
+
+    for (unsigned int m = 0; m < num_members; ++m) {
+        Cellular_free(members[m]);
+    }
+    free(members);
+    return TP2_OK;
+}
+
+int main(int argc, char **argv) {
+    struct Arguments *arguments = parse_arguments(argc, argv);
+    if (arguments->status != TP2_OK) {
+        return arguments->status;
+    }
+    Numa_set_huge_pages(arguments->huge_pages);
+    if (arguments->mapped_directory != NULL) {
+        printf("Grid:       %u x %u\n", arguments->num_rows,
+               arguments->num_cols);
+        printf("Steps:      %u\n", arguments->num_steps);
+        printf("Threads:    %u\n", arguments->num_threads);
+        enum Status status = benchmark_mapped(arguments);
+        free_arguments(arguments);
+        return status;
+    }
+    if (arguments->num_members > 0) {
+        printf("Grid:       %u x %u\n", arguments->num_rows,
+               arguments->num_cols);
+        printf("Steps:      %u\n", arguments->num_steps);
+        printf("Threads:    %u\n", arguments->num_threads);
+        enum Status status = benchmark_ensemble(arguments);
+        free_arguments(arguments);
+        return status;
+    }
+    struct CellularAutomaton *automaton;
+    automaton = Cellular_init(arguments->num_rows,
+                              arguments->num_cols,
+                              arguments->type,
+                              arguments->boundary,
+                              arguments->allowed_cells);
+    double start = benchmark_now();
+    Cellular_set_random_seeded(automaton, arguments->distribution,
+                               arguments->seed, arguments->num_threads);
+    double random_time = benchmark_now() - start;
+    if (arguments->rule != NULL) {
+        Cellular_set_rule(automaton, arguments->rule);
+    }
+    if (arguments->layout == CELLULAR_MORTON) {
+        struct CellularAutomaton *tiles =
+            Cellular_duplicate_as(automaton, CELLULAR_MORTON);
+        Cellular_free(automaton);
+        automaton = tiles;
+    }
+
+    printf("Grid:       %u x %u\n", arguments->num_rows, arguments->num_cols);
+    printf("Steps:      %u\n", arguments->num_steps);
+    printf("Threads:    %u\n", arguments->num_threads);
+    printf("Layout:     %s\n", arguments->layout == CELLULAR_MORTON
+                                ? LAYOUT_MORTON : LAYOUT_ROW_MAJOR);
+    printf("Random:     %.3f s (seed %llu)\n", random_time,
+           (unsigned long long)arguments->seed);
+    if (arguments->engine == ENGINE_GENERIC) {
+        // Compares the neighbor-counting kernels supported by the processor
+        for (int kernel = 0; kernel < STENCIL_NUM_KERNELS; ++kernel) {
+            if (Stencil_use(kernel)) {
+                benchmark_run(automaton, arguments);
+            }
+        }
+    } else {
+        benchmark_run(automaton, arguments);
+    }
+
+    Cellular_free(automaton);
+    free_arguments(arguments);
+    return TP2_OK;
+}
@@ -0,0 +1,192 @@
+/**
+ * Implements bitlife.h.
+ *
+ * The eight neighbors of a cell are the west, center and east bits of the
+ * rows above and below, and the west and east bits of its own row. Shifting a
+ * whole word by one bit aligns the west (or east) neighbor of 64 cells at
+ * once. The eight resulting words are then summed with full adders, which
+ * yields the four bits of the number of live neighbors of each cell.
+ */
+#include "bitlife.h"
+#include <stdlib.h>
+#include <string.h>
+#include "numa.h"
+#include "utils.h"
+
+#define BITLIFE_WORD_SIZE 64
+#define BITLIFE_ALIGNMENT 64
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Returns a row of a grid.
+ *
+ * @param bitlife  The game of life
+ * @param grid     Either its current or next grid
+ * @param row      The row number, -1 and `num_rows` being the halo rows
+ * @return         The first word of the row
+ */
+static inline uint64_t *Bitlife_row(const struct Bitlife *bitlife,
+                                    uint64_t *grid,
+                                    int row) {
+    return grid + (size_t)(row + 1) * bitlife->stride;
+}
+
+/**
+ * Computes the next cells of a row.
+ *
+ * The cells outside the first and last columns are either dead or wrapped
+ * around, according to the boundary.
+ *
+ * @param bitlife  The game of life
+ * @param above    The row above
+ * @param row      The row to update
+ * @param below    The row below
+ * @param next     The updated row
+ */
+static void Bitlife_step_row(const struct Bitlife *bitlife,
+                             const uint64_t *above,
+                             const uint64_t *row,
+                             const uint64_t *below,
+                             uint64_t *next) {
+    const unsigned int num_words = bitlife->num_words;
+    const unsigned int last_bit = (bitlife->num_cols - 1) % BITLIFE_WORD_SIZE;
+    const bool wraps = bitlife->boundary == CELLULAR_WRAP_AROUND;
+    const unsigned int birth = bitlife->birth, survival = bitlife->survival;
+    const uint64_t *rows[3] = {above, row, below};
+    uint64_t west_carry[3], east_carry[3];
+    for (unsigned int r = 0; r < 3; ++r) {
+        west_carry[r] = wraps ? (rows[r][num_words - 1] >> last_bit) & 1 : 0;
+        east_carry[r] = wraps ? (rows[r][0] & 1) << last_bit : 0;
+    }
+    for (unsigned int w = 0; w < num_words; ++w) {
+        uint64_t west[3], east[3];
+        for (unsigned int r = 0; r < 3; ++r) {
+            west[r] = (rows[r][w] << 1)
+                    | (w > 0 ? rows[r][w - 1] >> 63 : west_carry[r]);
+            east[r] = (rows[r][w] >> 1)
+                    | (w + 1 < num_words ? rows[r][w + 1] << 63
+                                         : east_carry[r]);
+        }
+        const uint64_t center[3] = {above[w], row[w], below[w]};
+        next[w] = Bitlife_next_word(west, center, east, birth, survival);
+    }
+    next[num_words - 1] &= bitlife->last_mask;
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Bitlife *Bitlife_init(const struct CellularAutomaton *automaton) {
+    struct Bitlife *bitlife = malloc(sizeof(struct Bitlife));
+    bitlife->num_rows = automaton->num_rows;
+    bitlife->num_cols = automaton->num_cols;
+    bitlife->num_words = (automaton->num_cols + BITLIFE_WORD_SIZE - 1)
+                       / BITLIFE_WORD_SIZE;
+    unsigned int num_last_bits = automaton->num_cols % BITLIFE_WORD_SIZE;
+    bitlife->last_mask = num_last_bits == 0 ? ~(uint64_t)0
+                       : ((uint64_t)1 << num_last_bits) - 1;
+    bitlife->stride = (max(bitlife->num_words, 1) * sizeof(uint64_t)
+                       + BITLIFE_ALIGNMENT - 1)
+                    / BITLIFE_ALIGNMENT * BITLIFE_ALIGNMENT / sizeof(uint64_t);
+    bitlife->boundary = automaton->boundary;
+    bitlife->birth = automaton->rule->birth;
+    bitlife->survival = automaton->rule->survival;
+    size_t size = (size_t)(bitlife->num_rows + 2) * bitlife->stride
+                * sizeof(uint64_t);
+    bitlife->current = Numa_alloc(BITLIFE_ALIGNMENT, size);
+    bitlife->next = Numa_alloc(BITLIFE_ALIGNMENT, size);
+    memset(bitlife->current, 0, size);
+    memset(bitlife->next, 0, size);
+    for (unsigned int i = 0; i < bitlife->num_rows; ++i) {
+        uint64_t *row = Bitlife_row(bitlife, bitlife->current, i);
+        for (unsigned int j = 0; j < bitlife->num_cols; ++j) {
+            if (*Cellular_cell(automaton, i, j) == CELLULAR_GAME_OF_LIFE_LIVE) {
+                row[j / BITLIFE_WORD_SIZE] |=
+                    (uint64_t)1 << (j % BITLIFE_WORD_SIZE);
+            }
+        }
+    }
+    return bitlife;
+}
+
+void Bitlife_step(struct Bitlife *bitlife) {
+    Bitlife_step_begin(bitlife);
+    Bitlife_step_rows(bitlife, 0, bitlife->num_rows);
+    Bitlife_step_end(bitlife);
+}
+
+void Bitlife_step_begin(struct Bitlife *bitlife) {
+    const int num_rows = bitlife->num_rows;
+    if (num_rows == 0 || bitlife->num_cols == 0) return;
+    if (bitlife->boundary == CELLULAR_WRAP_AROUND) {
+        uint64_t *current = bitlife->current;
+        size_t row_size = bitlife->num_words * sizeof(uint64_t);
+        memcpy(Bitlife_row(bitlife, current, -1),
+               Bitlife_row(bitlife, current, num_rows - 1), row_size);
+        memcpy(Bitlife_row(bitlife, current, num_rows),
+               Bitlife_row(bitlife, current, 0), row_size);
+    }
+}
+
+void Bitlife_step_rows(const struct Bitlife *bitlife,
+                       unsigned int first_row,
+                       unsigned int num_rows) {
+    if (bitlife->num_cols == 0) return;
+    uint64_t *current = bitlife->current;
+    for (int i = first_row; i < (int)(first_row + num_rows); ++i) {
+        Bitlife_step_row(bitlife,
+                         Bitlife_row(bitlife, current, i - 1),
+                         Bitlife_row(bitlife, current, i),
+                         Bitlife_row(bitlife, current, i + 1),
+                         Bitlife_row(bitlife, bitlife->next, i));
+    }
+}
+
+void Bitlife_step_end(struct Bitlife *bitlife) {
+    uint64_t *current = bitlife->current;
+    bitlife->current = bitlife->next;
+    bitlife->next = current;
+}
+
+void Bitlife_store(const struct Bitlife *bitlife,
+                   struct CellularAutomaton *automaton) {
+    for (unsigned int i = 0; i < bitlife->num_rows; ++i) {
+        const uint64_t *row = Bitlife_row(bitlife, bitlife->current, i);
+        for (unsigned int j = 0; j < bitlife->num_cols; ++j) {
+            *Cellular_cell(automaton, i, j) =
+                (row[j / BITLIFE_WORD_SIZE] >> (j % BITLIFE_WORD_SIZE)) & 1 ?
+                CELLULAR_GAME_OF_LIFE_LIVE : CELLULAR_GAME_OF_LIFE_DEAD;
+        }
+    }
+}
+
+struct Bitlife *Bitlife_alloc_like(const struct Bitlife *bitlife) {
+    struct Bitlife *copy = malloc(sizeof(struct Bitlife));
+    *copy = *bitlife;
+    size_t size = (size_t)(bitlife->num_rows + 2) * bitlife->stride
+                * sizeof(uint64_t);
+    copy->current = Numa_alloc(BITLIFE_ALIGNMENT, size);
+    copy->next = Numa_alloc(BITLIFE_ALIGNMENT, size);
+    return copy;
+}
+
+void Bitlife_copy_band(const struct Bitlife *source,
+                       struct Bitlife *target,
+                       unsigned int index,
+                       unsigned int num_bands) {
+    size_t row_size = source->stride * sizeof(uint64_t);
+    Numa_copy_band(target->current, source->current, source->num_rows + 2,
+                   row_size, index, num_bands);
+    Numa_copy_band(target->next, source->next, source->num_rows + 2,
+                   row_size, index, num_bands);
+}
+
+void Bitlife_free(struct Bitlife *bitlife) {
+    free(bitlife->current);
+    free(bitlife->next);
+    free(bitlife);
+}
@@ -0,0 +1,196 @@
+/**
+ * Provides a bit-parallel implementation of the game of life.
+ *
+ * Each cell is stored as a single bit, so that a machine word holds 64
+ * consecutive cells of a row. The number of live neighbors of the 64 cells of
+ * a word is computed at once with bitwise carry-save adders, without any
+ * branch.
+ *
+ * Any Life-like rule is supported, i.e. any rule of the form "B.../S...". The
+ * produced states are exactly the same as the ones of a
+ * `CELLULAR_GAME_OF_LIFE` automaton with the same rule, for both boundaries.
+ */
+#ifndef BITLIFE_H
+#define BITLIFE_H
+
+#include <stdint.h>
+#include "cellular.h"
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A game of life whose cells are stored as bits.
+ *
+ * The bit `k` of the word `w` of a row is the cell at column `64 * w + k`.
+ * The bits beyond the last column are always 0. Each grid has an extra row
+ * above and below, which is the halo of the vertical neighbors. Consecutive
+ * rows are `stride` words apart, and every row starts on a cache line, so
+ * that disjoint bands of rows can be updated in parallel.
+ */
+struct Bitlife {
+    unsigned int num_rows;          /**< The number of rows */
+    unsigned int num_cols;          /**< The number of columns */
+    unsigned int num_words;         /**< The number of words per row */
+    unsigned int stride;            /**< The distance between two rows */
+    uint64_t last_mask;             /**< The valid bits of the last word */
+    enum CellularBoundary boundary; /**< The boundary type */
+    unsigned int birth;             /**< Bit k: a dead cell is born with k */
+    unsigned int survival;          /**< Bit k: a live cell survives with k */
+    uint64_t *current;              /**< The current cells, halo included */
+    uint64_t *next;                 /**< The next cells, halo included */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Adds three words bitwise, i.e. a full adder applied to 64 bits at once.
+ *
+ * @param a      The first word
+ * @param b      The second word
+ * @param c      The third word
+ * @param sum    The resulting bits of weight 1
+ * @param carry  The resulting bits of weight 2
+ */
+static inline void Bitlife_add(uint64_t a, uint64_t b, uint64_t c,
+                               uint64_t *sum, uint64_t *carry) {
+    uint64_t t = a ^ b;
+    *sum = t ^ c;
+    *carry = (a & b) | (t & c);
+}
+
+/**
+ * Computes the next state of 64 cells from their neighbors.
+ *
+ * The three words of each array are respectively taken from the row above,
+ * the row of the cells and the row below, the bit `k` of each word being the
+ * neighbor of the cell `k`.
+ *
+ * @param west      The west neighbors
+ * @param center    The north and south neighbors, and the cells themselves
+ * @param east      The east neighbors
+ * @param birth     Bit k: a dead cell is born with k live neighbors
+ * @param survival  Bit k: a live cell survives with k live neighbors
+ * @return          The next cells
+ */
+static inline uint64_t Bitlife_next_word(const uint64_t west[3],
+                                         const uint64_t center[3],
+                                         const uint64_t east[3],
+                                         unsigned int birth,
+                                         unsigned int survival) {
+    uint64_t above_sum, above_carry, below_sum, below_carry;
+    Bitlife_add(west[0], center[0], east[0], &above_sum, &above_carry);
+    Bitlife_add(west[2], center[2], east[2], &below_sum, &below_carry);
+    uint64_t side_sum = west[1] ^ east[1];
+    uint64_t side_carry = west[1] & east[1];
+    uint64_t ones, twos, fours, eights, carry;
+    Bitlife_add(above_sum, below_sum, side_sum, &ones, &carry);
+    Bitlife_add(above_carry, below_carry, side_carry, &twos, &fours);
+    eights = fours & twos & carry;
+    fours ^= twos & carry;
+    twos ^= carry;
+    if (birth == 1u << 3 && survival == (1u << 2 | 1u << 3)) {
+        // Live with 3 neighbors, or with 2 neighbors if already live
+        return twos & ~fours & ~eights & (ones | center[1]);
+    }
+    const uint64_t bits[4] = {ones, twos, fours, eights};
+    uint64_t born = 0, survives = 0;
+    for (unsigned int k = 0; k <= 8; ++k) {
+        if (((birth | survival) >> k & 1) == 0) continue;
+        uint64_t has_k = ~(uint64_t)0;
+        for (unsigned int b = 0; b < 4; ++b) {
+            has_k &= (k >> b & 1) ? bits[b] : ~bits[b];
+        }
+        if (birth >> k & 1) born |= has_k;
+        if (survival >> k & 1) survives |= has_k;
+    }
+    return (born & ~center[1]) | (survives & center[1]);
+}
+
+/**
+ * Creates a bit-parallel game of life from an automaton.
+ *
+ * @param automaton  The game-of-life-type automaton
+ * @return           The bit-parallel game of life
+ */
+struct Bitlife *Bitlife_init(const struct CellularAutomaton *automaton);
+
+/**
+ * Computes the next step of a bit-parallel game of life.
+ *
+ * @param bitlife  The game of life to update
+ */
+void Bitlife_step(struct Bitlife *bitlife);
+
+/**
+ * Prepares a step of a bit-parallel game of life computed by bands of rows.
+ *
+ * A step can be computed by calling `Bitlife_step_begin`, then
+ * `Bitlife_step_rows` on bands covering all the rows, possibly in parallel,
+ * and finally `Bitlife_step_end`.
+ *
+ * @param bitlife  The game of life to update
+ */
+void Bitlife_step_begin(struct Bitlife *bitlife);
+
+/**
+ * Computes the next step of a band of rows of a bit-parallel game of life.
+ *
+ * @param bitlife    The game of life to update
+ * @param first_row  The first row of the band
+ * @param num_rows   The number of rows of the band
+ */
+void Bitlife_step_rows(const struct Bitlife *bitlife,
+                       unsigned int first_row,
+                       unsigned int num_rows);
+
+/**
+ * Completes a step of a bit-parallel game of life computed by bands of rows.
+ *
+ * @param bitlife  The game of life to update
+ */
+void Bitlife_step_end(struct Bitlife *bitlife);
+
+/**
+ * Copies the cells of a bit-parallel game of life into an automaton.
+ *
+ * @param bitlife    The game of life
+ * @param automaton  The automaton receiving the cells, of the same size
+ */
+void Bitlife_store(const struct Bitlife *bitlife,
+                   struct CellularAutomaton *automaton);
+
+/**
+ * Creates a bit-parallel game of life like another one, whose cells are left
+ * unset and untouched (see `Cellular_alloc_like`).
+ *
+ * @param bitlife  The game of life
+ * @return         A game of life with the same size and rule
+ */
+struct Bitlife *Bitlife_alloc_like(const struct Bitlife *bitlife);
+
+/**
+ * Copies a band of rows of both grids of a bit-parallel game of life into
+ * another one, halo rows included.
+ *
+ * @param source     The game of life to copy
+ * @param target     A game of life created by `Bitlife_alloc_like`
+ * @param index      The index of the band
+ * @param num_bands  The number of bands
+ */
+void Bitlife_copy_band(const struct Bitlife *source,
+                       struct Bitlife *target,
+                       unsigned int index,
+                       unsigned int num_bands);
+
+/**
+ * Frees a bit-parallel game of life.
+ *
+ * @param bitlife  The game of life to free
+ */
+void Bitlife_free(struct Bitlife *bitlife);
+
+#endif
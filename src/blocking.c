@@ -0,0 +1,180 @@
+/**
+ * Implements blocking.h.
+ */
+#include "blocking.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * The number of rows of a buffer.
+ */
+#define BLOCKING_BUFFER_ROWS (BLOCKING_TILE_ROWS + 2 * BLOCKING_MAX_DEPTH)
+
+/**
+ * The number of columns of a buffer.
+ */
+#define BLOCKING_BUFFER_COLS (BLOCKING_TILE_COLS + 2 * BLOCKING_MAX_DEPTH)
+
+/**
+ * Loads a segment of a row of an automaton into a row of a buffer.
+ *
+ * The columns outside of the grid are the opposite ones if the boundary
+ * wraps around, and are in state 0 otherwise.
+ *
+ * @param automaton  The automaton
+ * @param index      The index of the row in the automaton
+ * @param first_col  The first column of the segment, possibly negative
+ * @param num_cols   The number of columns of the segment
+ * @param row        The row of the buffer
+ */
+void Blocking_load_row(const struct CellularAutomaton *automaton,
+                       unsigned int index,
+                       int first_col,
+                       int num_cols,
+                       unsigned char *row) {
+    int size = automaton->num_cols;
+    bool wraps = automaton->boundary == CELLULAR_WRAP_AROUND;
+    int last_col = first_col + num_cols;
+    int first = first_col > 0 ? first_col : 0;
+    if (first > last_col) first = last_col;
+    int last = last_col < size ? last_col : size;
+    if (last < first) last = first;
+    for (int j = first_col; j < first; ++j) {
+        row[j - first_col] = wraps ? *Cellular_cell(automaton, index,
+                                                    mod(j, size)) : 0;
+    }
+    Cellular_get_states(automaton, index, first, last - first,
+                        row + first - first_col);
+    for (int j = last; j < last_col; ++j) {
+        row[j - first_col] = wraps ? *Cellular_cell(automaton, index,
+                                                    mod(j, size)) : 0;
+    }
+}
+
+/**
+ * Loads a rectangle of cells of an automaton into a buffer.
+ *
+ * @param automaton  The automaton
+ * @param first_row  The first row of the rectangle, possibly negative
+ * @param num_rows   The number of rows of the rectangle
+ * @param first_col  The first column of the rectangle, possibly negative
+ * @param num_cols   The number of columns of the rectangle
+ * @param buffer     The buffer
+ * @param stride     The distance between two rows of the buffer
+ */
+void Blocking_load(const struct CellularAutomaton *automaton,
+                   int first_row,
+                   int num_rows,
+                   int first_col,
+                   int num_cols,
+                   unsigned char *buffer,
+                   size_t stride) {
+    int size = automaton->num_rows;
+    bool wraps = automaton->boundary == CELLULAR_WRAP_AROUND;
+    for (int i = 0; i < num_rows; ++i) {
+        int row = first_row + i;
+        if (0 <= row && row < size) {
+            Blocking_load_row(automaton, row, first_col, num_cols,
+                              buffer + i * stride);
+        } else if (wraps) {
+            Blocking_load_row(automaton, mod(row, size), first_col, num_cols,
+                              buffer + i * stride);
+        } else {
+            memset(buffer + i * stride, 0, num_cols);
+        }
+    }
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Blocking *Blocking_init(unsigned int depth, unsigned int num_threads) {
+    struct Blocking *blocking = malloc(sizeof(struct Blocking));
+    blocking->depth = min(max(depth, 1), BLOCKING_MAX_DEPTH);
+    blocking->num_threads = num_threads;
+    // Each row starts with up to a cache line before the cells of the tile
+    blocking->stride = (BLOCKING_BUFFER_COLS + 2 * CELLULAR_ALIGNMENT - 1)
+                     / CELLULAR_ALIGNMENT * CELLULAR_ALIGNMENT;
+    blocking->buffer_size = BLOCKING_BUFFER_ROWS * blocking->stride;
+    blocking->buffers = aligned_alloc(CELLULAR_ALIGNMENT,
+                                      2 * num_threads * blocking->buffer_size);
+    return blocking;
+}
+
+unsigned int Blocking_num_tiles(unsigned int num_rows, unsigned int num_cols) {
+    return (num_rows + BLOCKING_TILE_ROWS - 1) / BLOCKING_TILE_ROWS
+         * ((num_cols + BLOCKING_TILE_COLS - 1) / BLOCKING_TILE_COLS);
+}
+
+void Blocking_step_tile(struct Blocking *blocking,
+                        unsigned int index,
+                        const struct CellularAutomaton *src,
+                        struct CellularAutomaton *dst,
+                        unsigned int tile,
+                        unsigned int num_steps) {
+    const size_t stride = blocking->stride;
+    const int k = num_steps;
+    int num_tile_cols = (src->num_cols + BLOCKING_TILE_COLS - 1)
+                      / BLOCKING_TILE_COLS;
+    int first_row = tile / num_tile_cols * BLOCKING_TILE_ROWS;
+    int first_col = tile % num_tile_cols * BLOCKING_TILE_COLS;
+    int num_rows = min(BLOCKING_TILE_ROWS, src->num_rows - first_row);
+    int num_cols = min(BLOCKING_TILE_COLS, src->num_cols - first_col);
+    int height = num_rows + 2 * k, width = num_cols + 2 * k;
+    // The cells of the tile start on a cache line, as the rows of `src`
+    unsigned char *buffer = blocking->buffers
+                          + 2 * index * blocking->buffer_size
+                          + CELLULAR_ALIGNMENT - k;
+    unsigned char *next = buffer + blocking->buffer_size;
+    Blocking_load(src, first_row - k, height, first_col - k, width,
+                  buffer, stride);
+
+    // The cells outside of a truncated grid stay in state 0 in both buffers
+    int min_row = 0, max_row = height, min_col = 0, max_col = width;
+    if (src->boundary != CELLULAR_WRAP_AROUND) {
+        if (first_row < k) min_row = k - first_row;
+        if (max_row > k - first_row + (int)src->num_rows) {
+            max_row = k - first_row + src->num_rows;
+        }
+        if (first_col < k) min_col = k - first_col;
+        if (max_col > k - first_col + (int)src->num_cols) {
+            max_col = k - first_col + src->num_cols;
+        }
+        if (min_row > 0 || max_row < height ||
+            min_col > 0 || max_col < width) {
+            memcpy(next, buffer, (height - 1) * stride + width);
+        }
+    }
+
+    // The valid region shrinks by one cell on each side at each step
+    for (int step = 1; step <= k; ++step) {
+        int first = step > min_row ? step : min_row;
+        int last = height - step < max_row ? height - step : max_row;
+        int left = step > min_col ? step : min_col;
+        int right = width - step < max_col ? width - step : max_col;
+        for (int i = first; i < last; ++i) {
+            const unsigned char *row = buffer + i * stride + left;
+            Cellular_step_cells(src->rule, row - stride, row, row + stride,
+                                right - left, next + i * stride + left);
+        }
+        unsigned char *previous = buffer;
+        buffer = next;
+        next = previous;
+    }
+    for (int i = 0; i < num_rows; ++i) {
+        Cellular_set_states(dst, first_row + i, first_col, num_cols,
+                            buffer + (i + k) * stride + k);
+    }
+}
+
+void Blocking_free(struct Blocking *blocking) {
+    free(blocking->buffers);
+    free(blocking);
+}
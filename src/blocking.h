@@ -0,0 +1,100 @@
+/**
+ * Provides the temporal blocking of the steps of a cellular automaton.
+ *
+ * Computing one step at a time streams the whole grid through memory at each
+ * step, which is bandwidth bound as soon as the grid exceeds the cache.
+ * Instead, the grid is split into tiles of `BLOCKING_TILE_ROWS` by
+ * `BLOCKING_TILE_COLS` cells, and each tile is loaded with a halo of `k`
+ * cells into a buffer small enough to stay in the cache. The buffer is then
+ * advanced by `k` steps, the valid region shrinking by one cell on each side
+ * at each step, after which the tile itself is exact and written back.
+ *
+ * The halos of neighboring tiles overlap, so that their cells are computed
+ * redundantly, but the tiles are independent and can be computed in
+ * parallel. The deeper the blocking, the fewer passes over the grid, but the
+ * more redundant cells: the depth is a tradeoff to measure.
+ */
+#ifndef BLOCKING_H
+#define BLOCKING_H
+
+#include <stddef.h>
+#include "cellular.h"
+
+#define BLOCKING_TILE_ROWS 64
+#define BLOCKING_TILE_COLS 256
+#define BLOCKING_DEFAULT_DEPTH 4
+#define BLOCKING_MAX_DEPTH 32
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * The buffers of a temporally blocked computation.
+ *
+ * Each thread has its own pair of buffers, large enough for a tile and a
+ * halo of `BLOCKING_MAX_DEPTH` cells.
+ */
+struct Blocking {
+    unsigned int depth;             /**< The number of steps per pass */
+    unsigned int num_threads;       /**< The number of threads */
+    size_t stride;                  /**< The distance between two rows */
+    size_t buffer_size;             /**< The size of a buffer */
+    unsigned char *buffers;         /**< The two buffers of each thread */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates the buffers of a temporally blocked computation.
+ *
+ * @param depth        The number of steps per pass, at most
+ *                     `BLOCKING_MAX_DEPTH`
+ * @param num_threads  The number of threads
+ * @return             The blocking
+ */
+struct Blocking *Blocking_init(unsigned int depth, unsigned int num_threads);
+
+/**
+ * Returns the number of tiles of a grid.
+ *
+ * The tiles are numbered row by row.
+ *
+ * @param num_rows  The number of rows of cells
+ * @param num_cols  The number of columns of cells
+ * @return          The number of tiles
+ */
+unsigned int Blocking_num_tiles(unsigned int num_rows, unsigned int num_cols);
+
+/**
+ * Writes a tile of an automaton after some steps into another automaton.
+ *
+ * Contrary to `Cellular_step_tile`, the halo of `src` is not used, so that it
+ * does not need to be refreshed. The cells of `dst` outside of the tile are
+ * left untouched, so that distinct tiles can be computed in parallel by
+ * distinct threads.
+ *
+ * @param blocking   The blocking
+ * @param index      The index of the calling thread
+ * @param src        The automaton to update
+ * @param dst        The automaton receiving the updated tile
+ * @param tile       The index of the tile
+ * @param num_steps  The number of steps, at most `blocking->depth`
+ */
+void Blocking_step_tile(struct Blocking *blocking,
+                        unsigned int index,
+                        const struct CellularAutomaton *src,
+                        struct CellularAutomaton *dst,
+                        unsigned int tile,
+                        unsigned int num_steps);
+
+/**
+ * Frees the buffers of a temporally blocked computation.
+ *
+ * @param blocking  The blocking to free
+ */
+void Blocking_free(struct Blocking *blocking);
+
+#endif
@@ -5,16 +5,37 @@
  */
 #include "cellular.h"
 #include "utils.h"
+#include "numa.h"
+#include "stencil.h"
+#include "rule.h"
+#include "random.h"
+#include "pool.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
-#include <time.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CELLULAR_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * A random grid drawn by bands of rows.
+ */
+struct CellularRandom {
+    struct CellularAutomaton *automaton; /**< The automaton to set */
+    uint64_t seed;                  /**< The seed of the grid */
+    struct RandomAlias alias;       /**< The distribution of the states */
+};
 
 // ------- //
 // Private //
 // ------- //
 
+#define CELLULAR_SEGMENT_SIZE 256
+
 #define CELLULAR_PANDEMY_STRING "\
 Pandemy-type cellular automaton\n\
   %c -> unoccupied,\n\
@@ -58,65 +79,142 @@ void Cellular_print_type(const struct CellularAutomaton *automaton) {
 }
 
 /**
- * Returns the cell at given row and column.
+ * Refreshes the halo of an automaton with a truncated boundary.
  *
- * If the row or column number is invalid, a boundary strategy is used. See
- * `enum CellularBoundary` for more details.
+ * The halo is the border of cells surrounding the grid. It makes the
+ * neighborhood of every cell directly accessible, without any test on the
+ * boundary. Here, it is filled with the first state.
  *
- * @param automaton  The automaton
- * @param row        The row number
- * @param col        The column number
- * @return           The cell
+ * Note: the halo does not belong to the state of the automaton and is only
+ * derived from its cells. This is why it can be refreshed through a constant
+ * automaton.
+ *
+ * @param automaton  The automaton whose halo is refreshed
  */
-char Cellular_safe_get(
-    const struct CellularAutomaton *automaton,
-    int row,
-    int col
+static inline void Cellular_refresh_truncate_halo(
+    const struct CellularAutomaton *automaton
 ) {
-    switch (automaton->boundary) {
-        case CELLULAR_TRUNCATE:
-            if (row < 0 || col < 0 || row >= (int)automaton->num_rows ||
-                col >= (int)automaton->num_cols) {
-                return automaton->allowed_cells[0];
-            } else {
-                return automaton->cells[row][col];
-            }
-        case CELLULAR_WRAP_AROUND:
-            return automaton->cells[mod(row, automaton->num_rows)]
-                                   [mod(col, automaton->num_cols)];
-        default:
-            return UNINITIALIZED_CELL;
+    unsigned int num_rows = automaton->num_rows;
+    unsigned int num_cols = automaton->num_cols;
+    if (num_rows == 0 || num_cols == 0) return;
+    unsigned char **cells = automaton->cells;
+    memset(cells[0] - automaton->stride - 1, 0, num_cols + 2);
+    memset(cells[num_rows - 1] + automaton->stride - 1, 0, num_cols + 2);
+    for (unsigned int i = 0; i < num_rows; ++i) {
+        cells[i][-1] = 0;
+        cells[i][num_cols] = 0;
     }
 }
 
 /**
- * Returns the number of neighbors of a cell having given type.
+ * Refreshes the halo of an automaton with a periodic boundary.
+ *
+ * The halo is a copy of the opposite edges, corners included. See
+ * `Cellular_refresh_truncate_halo` for more details.
  *
- * @param automaton  The cellular automaton
- * @param row        The row number
- * @param col        The column number
- * @param cell       The type of the cell
- * @param diagonals  If true, include diagonal neighbors
+ * @param automaton  The automaton whose halo is refreshed
  */
-unsigned int Cellular_num_neighbors(
-    const struct CellularAutomaton *automaton,
-    int row,
-    int col,
-    char cell,
-    bool diagonals
+static inline void Cellular_refresh_wrap_around_halo(
+    const struct CellularAutomaton *automaton
 ) {
-    unsigned int num_cells = 0;
-    for (int drow = -1; drow <= 1; ++drow) {
-        for (int dcol = -1; dcol <= 1; ++dcol) {
-            unsigned int dist = abs(drow) + abs(dcol);
-            bool is_neighbor = dist == 1 || (dist == 2 && diagonals);
-            if (is_neighbor &&
-                Cellular_safe_get(automaton, row + drow, col + dcol) == cell) {
-                ++num_cells;
+    unsigned int num_rows = automaton->num_rows;
+    unsigned int num_cols = automaton->num_cols;
+    if (num_rows == 0 || num_cols == 0) return;
+    unsigned char **cells = automaton->cells;
+    for (unsigned int i = 0; i < num_rows; ++i) {
+        cells[i][-1] = cells[i][num_cols - 1];
+        cells[i][num_cols] = cells[i][0];
+    }
+    memcpy(cells[0] - automaton->stride - 1, cells[num_rows - 1] - 1,
+           num_cols + 2);
+    memcpy(cells[num_rows - 1] + automaton->stride - 1, cells[0] - 1,
+           num_cols + 2);
+}
+
+/**
+ * Wraps an index of a cell around the grid, if it lies outside of it.
+ *
+ * @param automaton  The automaton
+ * @param index      The index, possibly out of bounds, replaced with the
+ *                   index of the same cell in the grid
+ * @param size       The number of cells along the dimension
+ * @return           False if the cell is outside of a non-periodic grid
+ */
+static inline bool Cellular_wrap(const struct CellularAutomaton *automaton,
+                                 int *index,
+                                 unsigned int size) {
+    if (0 <= *index && *index < (int)size) return true;
+    if (automaton->boundary != CELLULAR_WRAP_AROUND) return false;
+    *index = mod(*index, size);
+    return true;
+}
+
+/**
+ * Returns the number of tiles of an automaton with the Morton layout.
+ *
+ * @param automaton  The automaton
+ * @return           Its number of tiles
+ */
+static inline unsigned int Cellular_num_tiles(
+    const struct CellularAutomaton *automaton
+) {
+    const unsigned int size = CELLULAR_MORTON_TILE_SIZE;
+    return (automaton->num_rows + size - 1) / size * automaton->num_tile_cols;
+}
+
+/**
+ * Refreshes the halos of the tiles of an automaton with the Morton layout.
+ *
+ * The halo of each tile is made of the cells just outside of it, which are
+ * copied from the neighboring tiles, or from the opposite edges of the grid
+ * according to the boundary. See `Cellular_refresh_truncate_halo` for more
+ * details.
+ *
+ * @param automaton  The automaton whose halo is refreshed
+ */
+void Cellular_refresh_morton_halo(const struct CellularAutomaton *automaton) {
+    const unsigned int size = CELLULAR_MORTON_TILE_SIZE;
+    const size_t stride = automaton->stride;
+    unsigned int num_tiles = Cellular_num_tiles(automaton);
+    for (unsigned int tile = 0; tile < num_tiles; ++tile) {
+        unsigned char *cells = automaton->data
+                             + automaton->tile_offsets[tile];
+        int first_row = tile / automaton->num_tile_cols * size;
+        int first_col = tile % automaton->num_tile_cols * size;
+        int num_rows = min(size, automaton->num_rows - first_row);
+        int num_cols = min(size, automaton->num_cols - first_col);
+        int rows[] = {first_row - 1, first_row + num_rows};
+        int cols[] = {first_col - 1, first_col + num_cols};
+        bool has_rows[2], has_cols[2];
+        for (unsigned int k = 0; k < 2; ++k) {
+            has_rows[k] = Cellular_wrap(automaton, rows + k,
+                                        automaton->num_rows);
+            has_cols[k] = Cellular_wrap(automaton, cols + k,
+                                        automaton->num_cols);
+        }
+        for (unsigned int k = 0; k < 2; ++k) {
+            // The rows above and below, corners included
+            unsigned char *halo = cells + k * (num_rows + 1) * stride;
+            if (has_rows[k]) {
+                memcpy(halo + 1, Cellular_cell(automaton, rows[k], first_col),
+                       num_cols);
+            } else {
+                memset(halo + 1, 0, num_cols);
+            }
+            for (unsigned int l = 0; l < 2; ++l) {
+                halo[l * (num_cols + 1)] = has_rows[k] && has_cols[l]
+                    ? *Cellular_cell(automaton, rows[k], cols[l]) : 0;
+            }
+
+            // The columns on the left and on the right
+            halo = cells + stride + k * (num_cols + 1);
+            const unsigned char *neighbors = has_cols[k]
+                ? Cellular_cell(automaton, first_row, cols[k]) : NULL;
+            for (int i = 0; i < num_rows; ++i) {
+                halo[i * stride] = has_cols[k] ? neighbors[i * stride] : 0;
             }
         }
     }
-    return num_cells;
 }
 
 /**
@@ -137,70 +235,25 @@ unsigned int Cellular_num_neighbors(
  * 5. If a cell has less than 2 or more than 3 neighbors, then it becomes
  *    unoccupied: It dies from loneliness or from suffocation.
  *
- * @param automaton  The automaton
- * @param row        The row number
- * @param col        The column number
- * @return           The cell obtained by applying the rule
+ * @param current    The current cell
+ * @param histogram  The histogram of the states of its neighbors
+ * @return           The state obtained by applying the rule
  */
-char Cellular_next_cell_pandemy(
-    const struct CellularAutomaton *automaton,
-    unsigned int row,
-    unsigned int col
-) {
-    char empty = automaton->allowed_cells[0];
-    char sick = automaton->allowed_cells[1];
-    char healthy = automaton->allowed_cells[2];
-    unsigned int num_healthy = Cellular_num_neighbors(
-        automaton, row, col, healthy, true);
-    unsigned int num_sick = Cellular_num_neighbors(
-        automaton, row, col, sick, true);
+unsigned char Cellular_next_cell_pandemy(unsigned char current,
+                                         uint16_t histogram) {
+    unsigned int num_sick =
+        STENCIL_HISTOGRAM_COUNT(histogram, CELLULAR_PANDEMY_SICK);
+    unsigned int num_healthy =
+        STENCIL_HISTOGRAM_COUNT(histogram, CELLULAR_PANDEMY_HEALTHY);
     unsigned int num_alive = num_healthy + num_sick;
-    char current = automaton->cells[row][col];
-    if (current == empty && num_alive == 3) {
-        return num_sick > num_healthy ? sick : healthy;
-    } else if (current != empty && (num_alive == 2 || num_alive == 3)) {
-        return num_sick >= num_healthy ? sick : current;
-    } else {
-        return empty;
-    }
-}
-
-/**
- * Returns the next cell according to its neighborhood in the game of life
- * case.
- *
- * The rules are the following (from Wikipedia):
- *
- * 1. A cell is either live or dead.
- * 2. The neighbordhood of a cell includes diagonals.
- * 3. Any live cell with fewer than two live neighbors dies, as if by under
- *    population.
- * 4. Any live cell with two or three live neighbors lives on to the next
- *    generation.
- * 5. Any live cell with more than three live neighbors dies, as if by
- *    overpopulation.
- * 6. Any dead cell with exactly three live neighbors becomes a live cell, as
- *    if by reproduction.
- *
- * @param automaton  The automaton
- * @param row        The row number
- * @param col        The column number
- * @return           The cell obtained by applying the rule
- */
-char Cellular_next_cell_game_of_life(
-    const struct CellularAutomaton *automaton,
-    unsigned int row,
-    unsigned int col
-) {
-    char dead = automaton->allowed_cells[0];
-    char live = automaton->allowed_cells[1];
-    char current = automaton->cells[row][col];
-    unsigned int num_lives =
-        Cellular_num_neighbors(automaton, row, col, live, true);
-    if (current == live) {
-        return num_lives == 2 || num_lives == 3 ? live : dead;
+    if (current == CELLULAR_PANDEMY_EMPTY && num_alive == 3) {
+        return num_sick > num_healthy ? CELLULAR_PANDEMY_SICK
+                                      : CELLULAR_PANDEMY_HEALTHY;
+    } else if (current != CELLULAR_PANDEMY_EMPTY &&
+               (num_alive == 2 || num_alive == 3)) {
+        return num_sick >= num_healthy ? CELLULAR_PANDEMY_SICK : current;
     } else {
-        return num_lives == 3 ? live : dead;
+        return CELLULAR_PANDEMY_EMPTY;
     }
 }
 
@@ -219,88 +272,462 @@ char Cellular_next_cell_game_of_life(
  * 5. A burning cell becomes a burnt cell in the next step.
  * 6. A burnt cell becomes a growing cell in the next step.
  *
- * @param automaton  The automaton
- * @param row        The row number
- * @param col        The column number
- * @return           The cell obtained by applying the rule
+ * @param current    The current cell
+ * @param histogram  The histogram of the states of its neighbors
+ * @return           The state obtained by applying the rule
  */
-char Cellular_next_cell_fire(
-    const struct CellularAutomaton *automaton,
-    unsigned int row,
-    unsigned int col
-) {
-    char growing = automaton->allowed_cells[0];
-    char ignitable = automaton->allowed_cells[1];
-    char burning = automaton->allowed_cells[2];
-    char burnt = automaton->allowed_cells[3];
-    char current = automaton->cells[row][col];
-    if (current == ignitable) {
-        if (Cellular_num_neighbors(automaton, row, col, burning, true) >= 1) {
-            return burning;
+unsigned char Cellular_next_cell_fire(unsigned char current,
+                                      uint16_t histogram) {
+    if (current == CELLULAR_FIRE_IGNITABLE) {
+        if (STENCIL_HISTOGRAM_COUNT(histogram, CELLULAR_FIRE_BURNING) >= 1) {
+            return CELLULAR_FIRE_BURNING;
         } else {
-            return ignitable;
+            return CELLULAR_FIRE_IGNITABLE;
         }
-    } else if (current == burning) {
-        return burnt;
-    } else if (current == burnt) {
-        return growing;
+    } else if (current == CELLULAR_FIRE_BURNING) {
+        return CELLULAR_FIRE_BURNT;
+    } else if (current == CELLULAR_FIRE_BURNT) {
+        return CELLULAR_FIRE_GROWING;
     } else {
-        return ignitable;
+        return CELLULAR_FIRE_IGNITABLE;
     }
 }
 
 /**
- * Returns the next cell according to its neighborhood.
+ * Computes the next cells of a segment of a row.
  *
- * The rule for updating the cell depends on the automaton type. See `enum
- * CellularType` for more details.
+ * The segment must have at most `CELLULAR_SEGMENT_SIZE` cells, and its
+ * neighbors must be readable, as for `Stencil_count`. With two states, the
+ * histogram of a cell is simply its number of neighbors in state 1.
+ *
+ * @param rule       The rule
+ * @param above      The segment of the row above
+ * @param row        The segment of the row
+ * @param below      The segment of the row below
+ * @param num_cells  The number of cells of the segment
+ * @param next       The resulting cells
+ */
+static inline void Cellular_next_segment(const struct Rule *rule,
+                                         const unsigned char *above,
+                                         const unsigned char *row,
+                                         const unsigned char *below,
+                                         unsigned int num_cells,
+                                         unsigned char *next) {
+    const unsigned char *table = rule->table;
+    const unsigned int shift = rule->shift;
+    if (rule->num_states == 2) {
+        unsigned char counts[CELLULAR_SEGMENT_SIZE];
+        Stencil_count(above, row, below, num_cells, 1, counts);
+        for (unsigned int j = 0; j < num_cells; ++j) {
+            next[j] = table[(row[j] & (RULE_MAX_NUM_STATES - 1)) << shift
+                            | counts[j]];
+        }
+    } else {
+        uint16_t histograms[CELLULAR_SEGMENT_SIZE];
+        Stencil_histogram(above, row, below, num_cells, histograms);
+        for (unsigned int j = 0; j < num_cells; ++j) {
+            next[j] = table[(row[j] & (RULE_MAX_NUM_STATES - 1)) << shift
+                            | histograms[j]];
+        }
+    }
+}
+
+/**
+ * Updates a rectangle of cells of an automaton with the Morton layout.
+ *
+ * The rectangle is processed tile by tile. A band of full rows is processed
+ * in the order of the tiles in memory, so that the whole grid is traversed
+ * along the Z-order curve.
+ *
+ * @param src        The current automaton
+ * @param dst        The automaton receiving the next cells
+ * @param first_row  The first row of the rectangle
+ * @param num_rows   The number of rows of the rectangle
+ * @param first_col  The first column of the rectangle
+ * @param num_cols   The number of columns of the rectangle
+ */
+void Cellular_next_morton_cells(const struct CellularAutomaton *src,
+                                struct CellularAutomaton *dst,
+                                unsigned int first_row,
+                                unsigned int num_rows,
+                                unsigned int first_col,
+                                unsigned int num_cols) {
+    const unsigned int size = CELLULAR_MORTON_TILE_SIZE;
+    const ptrdiff_t stride = src->stride;
+    unsigned int last_row = first_row + num_rows;
+    unsigned int last_col = first_col + num_cols;
+    unsigned int first_tile_row = first_row / size;
+    unsigned int first_tile_col = first_col / size;
+    unsigned int num_tile_rows = (last_row + size - 1) / size - first_tile_row;
+    unsigned int num_tile_cols = (last_col + size - 1) / size - first_tile_col;
+    bool is_band = num_cols == src->num_cols;
+    unsigned int num_tiles = is_band ? Cellular_num_tiles(src)
+                                     : num_tile_rows * num_tile_cols;
+    for (unsigned int k = 0; k < num_tiles; ++k) {
+        unsigned int tile = is_band
+            ? src->tile_order[k]
+            : (first_tile_row + k / num_tile_cols) * src->num_tile_cols
+              + first_tile_col + k % num_tile_cols;
+        unsigned int top = tile / src->num_tile_cols * size;
+        unsigned int left = tile % src->num_tile_cols * size;
+        unsigned int first = max(first_row, top);
+        unsigned int last = min(last_row, top + size);
+        unsigned int first_cell = max(first_col, left);
+        unsigned int last_cell = min(last_col, left + size);
+        if (first >= last || first_cell >= last_cell) continue;
+        size_t offset = (first - top + 1) * stride + first_cell - left + 1;
+        const unsigned char *row = src->data + src->tile_offsets[tile]
+                                 + offset;
+        unsigned char *next = dst->data + dst->tile_offsets[tile] + offset;
+        for (unsigned int i = first; i < last; ++i) {
+            Cellular_next_segment(src->rule, row - stride, row, row + stride,
+                                  last_cell - first_cell, next);
+            row += stride;
+            next += stride;
+        }
+    }
+}
+
+/**
+ * Updates a rectangle of cells of an automaton, by applying its rule to
+ * every cell.
+ *
+ * The rows are processed by segments of `CELLULAR_SEGMENT_SIZE` cells, whose
+ * neighbor counts are computed by the vectorized kernels of `stencil.h` and
+ * stay in the L1 cache until the rule is applied.
+ *
+ * Note: the halo of `src` must be up to date.
+ *
+ * @param src        The current automaton
+ * @param dst        The automaton receiving the next cells
+ * @param first_row  The first row of the rectangle
+ * @param num_rows   The number of rows of the rectangle
+ * @param first_col  The first column of the rectangle
+ * @param num_cols   The number of columns of the rectangle
+ */
+static inline void Cellular_next_cells(const struct CellularAutomaton *src,
+                                       struct CellularAutomaton *dst,
+                                       unsigned int first_row,
+                                       unsigned int num_rows,
+                                       unsigned int first_col,
+                                       unsigned int num_cols) {
+    if (src->layout == CELLULAR_MORTON) {
+        Cellular_next_morton_cells(src, dst, first_row, num_rows, first_col,
+                                   num_cols);
+        return;
+    }
+    const ptrdiff_t stride = src->stride;
+    for (unsigned int i = first_row; i < first_row + num_rows; ++i) {
+        const unsigned char *row = src->cells[i] + first_col;
+        unsigned char *next = dst->cells[i] + first_col;
+        for (unsigned int j = 0; j < num_cols; j += CELLULAR_SEGMENT_SIZE) {
+            Cellular_next_segment(src->rule,
+                                  row + j - stride, row + j, row + j + stride,
+                                  min(CELLULAR_SEGMENT_SIZE, num_cols - j),
+                                  next + j);
+        }
+    }
+}
+
+/**
+ * A function refreshing the halo of an automaton.
+ */
+typedef void (*CellularHaloRefresher)(
+    const struct CellularAutomaton *automaton
+);
+
+/**
+ * The functions refreshing the halo, indexed by boundary.
+ */
+const CellularHaloRefresher CELLULAR_HALO_REFRESHERS[] = {
+    [CELLULAR_TRUNCATE] = Cellular_refresh_truncate_halo,
+    [CELLULAR_WRAP_AROUND] = Cellular_refresh_wrap_around_halo,
+    [CELLULAR_UNBOUNDED] = Cellular_refresh_truncate_halo
+};
+
+/**
+ * Draws the cells of a band of rows of a random grid.
+ *
+ * @param data         The random grid
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Cellular_set_random_band(void *data,
+                              unsigned int index,
+                              unsigned int num_threads) {
+    const struct CellularRandom *random = data;
+    struct CellularAutomaton *automaton = random->automaton;
+    unsigned long num_rows = automaton->num_rows;
+    unsigned int first_row = num_rows * index / num_threads;
+    unsigned int last_row = num_rows * (index + 1) / num_threads;
+    unsigned char *states = malloc(max(automaton->num_cols, 1));
+    for (unsigned int i = first_row; i < last_row; ++i) {
+        Random_fill(&random->alias, random->seed,
+                    (uint64_t)i * automaton->num_cols, automaton->num_cols,
+                    states);
+        Cellular_set_states(automaton, i, 0, automaton->num_cols, states);
+    }
+    free(states);
+}
+
+/**
+ * Fills the table translating the allowed cells into states.
+ *
+ * The state of a cell is the index of the cell in the allowed cells. The
+ * characters which are not allowed are mapped to
+ * `CELLULAR_UNINITIALIZED_STATE`.
+ *
+ * @param allowed_cells  The allowed cells
+ * @param states         The table to fill, indexed by character
+ */
+void Cellular_fill_states(const char *allowed_cells,
+                          unsigned char states[CELLULAR_NUM_CHARS]) {
+    memset(states, CELLULAR_UNINITIALIZED_STATE, CELLULAR_NUM_CHARS);
+    for (unsigned int k = 0; allowed_cells[k] != '\0'; ++k) {
+        states[(unsigned char)allowed_cells[k]] = k;
+    }
+}
+
+/**
+ * Fills the table translating states into allowed cells.
+ *
+ * The states that do not correspond to any allowed cell are mapped to
+ * `UNINITIALIZED_CELL`.
  *
  * @param automaton  The automaton
- * @param row        The row number
- * @param col        The column number
- * @return           The cell obtained by applying some rule
+ * @param cells      The table to fill, indexed by state
  */
-char Cellular_next_cell(
-    const struct CellularAutomaton *automaton,
-    unsigned int row,
-    unsigned int col
+void Cellular_fill_cells(const struct CellularAutomaton *automaton,
+                         char cells[CELLULAR_NUM_CHARS]) {
+    unsigned int num_cells = Cellular_num_cells(automaton->type);
+    memset(cells, UNINITIALIZED_CELL, CELLULAR_NUM_CHARS);
+    memcpy(cells, automaton->allowed_cells, num_cells);
+}
+
+/**
+ * Translates states into their cells, in place, through a table.
+ *
+ * @param cells       The cell of each state
+ * @param text        The states, replaced by their cells
+ * @param num_states  The number of states
+ */
+void Cellular_translate_scalar(const char cells[CELLULAR_NUM_CHARS],
+                               char *text,
+                               size_t num_states) {
+    for (size_t j = 0; j < num_states; ++j) {
+        text[j] = cells[(unsigned char)text[j]];
+    }
+}
+
+#ifdef CELLULAR_X86
+/**
+ * Translates states into their cells, in place, 16 at a time, with SSE2
+ * instructions.
+ *
+ * Each allowed cell is selected by comparing the states to its index, the
+ * other states giving `UNINITIALIZED_CELL`, as through the table.
+ *
+ * @param automaton   The automaton
+ * @param cells       The cell of each state
+ * @param text        The states, replaced by their cells
+ * @param num_states  The number of states
+ */
+__attribute__((target("sse2")))
+void Cellular_translate_sse2(const struct CellularAutomaton *automaton,
+                             const char cells[CELLULAR_NUM_CHARS],
+                             char *text,
+                             size_t num_states) {
+    const unsigned int num_cells = Cellular_num_cells(automaton->type);
+    __m128i indices[RULE_MAX_NUM_STATES], values[RULE_MAX_NUM_STATES];
+    for (unsigned int k = 0; k < num_cells; ++k) {
+        indices[k] = _mm_set1_epi8(k);
+        values[k] = _mm_set1_epi8(automaton->allowed_cells[k]);
+    }
+    const __m128i uninitialized = _mm_set1_epi8(UNINITIALIZED_CELL);
+    size_t j = 0;
+    for (; j + 16 <= num_states; j += 16) {
+        __m128i states = _mm_loadu_si128((const __m128i *)(text + j));
+        __m128i result = uninitialized;
+        for (unsigned int k = 0; k < num_cells; ++k) {
+            __m128i is_cell = _mm_cmpeq_epi8(states, indices[k]);
+            result = _mm_or_si128(_mm_andnot_si128(is_cell, result),
+                                  _mm_and_si128(is_cell, values[k]));
+        }
+        _mm_storeu_si128((__m128i *)(text + j), result);
+    }
+    Cellular_translate_scalar(cells, text + j, num_states - j);
+}
+#endif
+
+/**
+ * Returns the position of a tile along the Z-order curve.
+ *
+ * The bits of the row and of the column are interleaved, the row giving the
+ * odd bits.
+ *
+ * @param row  The row of the tile
+ * @param col  The column of the tile
+ * @return     Its Morton code
+ */
+uint64_t Cellular_morton_code(uint32_t row, uint32_t col) {
+    uint64_t code = 0;
+    for (unsigned int b = 0; b < 32; ++b) {
+        code |= (uint64_t)(col >> b & 1) << (2 * b)
+              | (uint64_t)(row >> b & 1) << (2 * b + 1);
+    }
+    return code;
+}
+
+/**
+ * Compares two integers of 64 bits, for `qsort`.
+ *
+ * @param a  The first integer
+ * @param b  The second integer
+ * @return   A negative, zero or positive value if `a` is smaller, equal or
+ *           greater than `b`
+ */
+int Cellular_compare_keys(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Returns the distance between two tiles of an automaton with the Morton
+ * layout.
+ *
+ * A tile holds its cells and its halo, and starts on a cache line.
+ *
+ * @return  The size of a tile
+ */
+static inline size_t Cellular_tile_size() {
+    size_t size = (CELLULAR_MORTON_TILE_SIZE + 2)
+                * (CELLULAR_MORTON_TILE_SIZE + 2);
+    return (size + CELLULAR_ALIGNMENT - 1) / CELLULAR_ALIGNMENT
+         * CELLULAR_ALIGNMENT;
+}
+
+/**
+ * Returns the size of the storage of the states of an automaton.
+ *
+ * @param automaton  The automaton
+ * @return           The size of `data`
+ */
+static inline size_t Cellular_data_size(
+    const struct CellularAutomaton *automaton
 ) {
-    switch (automaton->type) {
-        case CELLULAR_PANDEMY:
-            return Cellular_next_cell_pandemy(automaton, row, col);
-        case CELLULAR_GAME_OF_LIFE:
-            return Cellular_next_cell_game_of_life(automaton, row, col);
-        case CELLULAR_FIRE:
-            return Cellular_next_cell_fire(automaton, row, col);
-        default:
-            return UNINITIALIZED_CELL;
+    if (automaton->layout == CELLULAR_MORTON) {
+        return max(Cellular_num_tiles(automaton), 1) * Cellular_tile_size();
     }
+    return (automaton->num_rows + 2) * automaton->stride;
 }
 
 /**
- * Returns a random cell according to a probability distribution.
+ * Allocates the tiles of an automaton with the Morton layout.
  *
- * @param automaton     The automaton
- * @param distribution  The distribution
- * @return              A random cell
+ * The tiles are sorted along the Z-order curve, and stored in this order.
+ *
+ * @param automaton  The automaton, whose dimensions are set
  */
-char Cellular_get_random_cell(
-    const struct CellularAutomaton *automaton,
-    const unsigned int *distribution
+void Cellular_alloc_tiles(struct CellularAutomaton *automaton) {
+    const unsigned int size = CELLULAR_MORTON_TILE_SIZE;
+    automaton->num_tile_cols = (automaton->num_cols + size - 1) / size;
+    automaton->stride = size + 2;
+    unsigned int num_tiles = Cellular_num_tiles(automaton);
+    uint64_t *keys = malloc(max(num_tiles, 1) * sizeof(uint64_t));
+    for (unsigned int tile = 0; tile < num_tiles; ++tile) {
+        keys[tile] = Cellular_morton_code(tile / automaton->num_tile_cols,
+                                          tile % automaton->num_tile_cols)
+                     << 32 | tile;
+    }
+    qsort(keys, num_tiles, sizeof(uint64_t), Cellular_compare_keys);
+    automaton->tile_order = malloc(max(num_tiles, 1) * sizeof(unsigned int));
+    automaton->tile_offsets = malloc(max(num_tiles, 1) * sizeof(size_t));
+    for (unsigned int k = 0; k < num_tiles; ++k) {
+        unsigned int tile = keys[k] & UINT32_MAX;
+        automaton->tile_order[k] = tile;
+        automaton->tile_offsets[tile] = k * Cellular_tile_size();
+    }
+    free(keys);
+    automaton->cells = NULL;
+    automaton->data = Numa_alloc(CELLULAR_ALIGNMENT,
+                                 Cellular_data_size(automaton));
+}
+
+/**
+ * Allocates a cellular automaton whose cells are left unset.
+ *
+ * With the row-major layout, the rows are stored one after the other in a
+ * single buffer, with an extra row above and below the grid for the halo.
+ * Each row is preceded by `CELLULAR_ALIGNMENT` bytes, the last of which is
+ * the left halo cell, and is followed by the right halo cell. The stride is
+ * rounded up to a multiple of `CELLULAR_ALIGNMENT`, so that every row starts
+ * on a cache line.
+ *
+ * @param num_rows       Its number of rows
+ * @param num_cols       Its number of columns
+ * @param type           Its type
+ * @param boundary       How to process the boundaries
+ * @param allowed_cells  The allowed cells
+ * @param rule           Its rule, copied, or NULL for the default rule
+ * @param layout         The layout of its states
+ * @return               The automaton, or NULL if the arguments are invalid
+ */
+struct CellularAutomaton *Cellular_alloc(
+    unsigned int num_rows,
+    unsigned int num_cols,
+    enum CellularType type,
+    enum CellularBoundary boundary,
+    const char *allowed_cells,
+    const struct Rule *rule,
+    enum CellularLayout layout
 ) {
-    unsigned int num_cells = strlen(automaton->allowed_cells);
-    unsigned int sum = 0;
-    for (unsigned int k = 0; k < num_cells; ++k) {
-        sum += distribution[k];
+    if (!Cellular_is_valid(type, allowed_cells)) return NULL;
+    struct CellularAutomaton *automaton
+        = malloc(sizeof(struct CellularAutomaton));
+    automaton->num_rows = num_rows;
+    automaton->num_cols = num_cols;
+    automaton->type = type;
+    automaton->boundary = boundary;
+    automaton->allowed_cells = strdupli(allowed_cells);
+    automaton->rule = rule != NULL ? Rule_duplicate(rule)
+                                   : Cellular_default_rule(type);
+    automaton->layout = layout;
+    automaton->num_tile_cols = 0;
+    automaton->tile_offsets = NULL;
+    automaton->tile_order = NULL;
+    if (layout == CELLULAR_MORTON) {
+        Cellular_alloc_tiles(automaton);
+        return automaton;
     }
-    unsigned int p = rand() % sum;
-    unsigned int k = 0;
-    unsigned int q = distribution[0];
-    while (q <= p) {
-        ++k;
-        q += distribution[k];
+    automaton->stride = ((size_t)num_cols + 2 * CELLULAR_ALIGNMENT)
+                      / CELLULAR_ALIGNMENT * CELLULAR_ALIGNMENT;
+    automaton->data = Numa_alloc(CELLULAR_ALIGNMENT,
+                                 Cellular_data_size(automaton));
+    automaton->cells = calloc(max(num_rows, 1), sizeof(unsigned char*));
+    for (unsigned int i = 0; i < num_rows; ++i) {
+        automaton->cells[i] = automaton->data + (i + 1) * automaton->stride
+                            + CELLULAR_ALIGNMENT;
     }
-    return automaton->allowed_cells[k];
+    return automaton;
+}
+
+/**
+ * Returns the number of consecutive cells of a row that are contiguous in
+ * memory.
+ *
+ * @param automaton  The automaton
+ * @param col        The column of the first cell
+ * @param num_cols   The number of cells asked for
+ * @return           The number of contiguous cells, at most `num_cols`
+ */
+static inline unsigned int Cellular_segment_length(
+    const struct CellularAutomaton *automaton,
+    unsigned int col,
+    unsigned int num_cols
+) {
+    if (automaton->layout == CELLULAR_ROW_MAJOR) return num_cols;
+    return min(num_cols, CELLULAR_MORTON_TILE_SIZE
+                         - col % CELLULAR_MORTON_TILE_SIZE);
 }
 
 // ------ //
@@ -314,25 +741,15 @@ struct CellularAutomaton *Cellular_init(
     enum CellularBoundary boundary,
     const char *allowed_cells
 ) {
-    if (Cellular_is_valid(type, allowed_cells)) {
-        struct CellularAutomaton *automaton
-            = malloc(sizeof(struct CellularAutomaton));
-        automaton->num_rows = num_rows;
-        automaton->num_cols = num_cols;
-        automaton->type = type;
-        automaton->boundary = boundary;
-        automaton->allowed_cells = strdupli(allowed_cells);
-        automaton->cells = calloc(num_rows, sizeof(char*));
-        for (unsigned int i = 0; i < automaton->num_rows; ++i) {
-            automaton->cells[i] = calloc(num_cols, sizeof(char));
-            for (unsigned int j = 0; j < automaton->num_cols; ++j) {
-                automaton->cells[i][j] = UNINITIALIZED_CELL;
-            }
-        }
-        return automaton;
-    } else {
-        return NULL;
+    struct CellularAutomaton *automaton = Cellular_alloc(
+        num_rows, num_cols, type, boundary, allowed_cells, NULL,
+        CELLULAR_ROW_MAJOR
+    );
+    if (automaton != NULL) {
+        memset(automaton->data, CELLULAR_UNINITIALIZED_STATE,
+               Cellular_data_size(automaton));
     }
+    return automaton;
 }
 
 struct CellularAutomaton *Cellular_init_with_state(
@@ -343,87 +760,293 @@ struct CellularAutomaton *Cellular_init_with_state(
     const char *allowed_cells,
     InitialState cellularArray
 ) {
-    if (Cellular_is_valid(type, allowed_cells)) {
-        struct CellularAutomaton *automaton
-            = malloc(sizeof(struct CellularAutomaton));
-        automaton->num_rows = num_rows;
-        automaton->num_cols = num_cols;
-        automaton->type = type;
-        automaton->boundary = boundary;
-        automaton->allowed_cells = strdupli(allowed_cells);
-        automaton->cells = calloc(num_rows, sizeof(char*));
+    struct CellularAutomaton *automaton = Cellular_alloc(
+        num_rows, num_cols, type, boundary, allowed_cells, NULL,
+        CELLULAR_ROW_MAJOR
+    );
+    if (automaton != NULL) {
+        unsigned char states[CELLULAR_NUM_CHARS];
+        Cellular_fill_states(allowed_cells, states);
         for (unsigned int i = 0; i < automaton->num_rows; ++i) {
-            automaton->cells[i] = calloc(num_cols, sizeof(char));
             for (unsigned int j = 0; j < automaton->num_cols; ++j) {
-                automaton->cells[i][j] = cellularArray.elemets[i][j];
+                *Cellular_cell(automaton, i, j) =
+                    states[(unsigned char)cellularArray.elemets[i][j]];
             }
         }
-        return automaton;
-    } else {
-        return NULL;
     }
+    return automaton;
 }
 
 struct CellularAutomaton *Cellular_duplicate(
     const struct CellularAutomaton *automaton
 ) {
-    struct CellularAutomaton *copy = Cellular_init(
+    struct CellularAutomaton *copy = Cellular_alloc(
         automaton->num_rows, automaton->num_cols, automaton->type,
-        automaton->boundary, automaton->allowed_cells
+        automaton->boundary, automaton->allowed_cells, automaton->rule,
+        automaton->layout
     );
+    memcpy(copy->data, automaton->data, Cellular_data_size(automaton));
+    return copy;
+}
+
+struct CellularAutomaton *Cellular_alloc_like(
+    const struct CellularAutomaton *automaton
+) {
+    return Cellular_alloc(
+        automaton->num_rows, automaton->num_cols, automaton->type,
+        automaton->boundary, automaton->allowed_cells, automaton->rule,
+        automaton->layout
+    );
+}
+
+void Cellular_copy_band(const struct CellularAutomaton *source,
+                        struct CellularAutomaton *target,
+                        unsigned int index,
+                        unsigned int num_bands) {
+    if (source->layout == CELLULAR_MORTON) {
+        Numa_copy_band(target->data, source->data,
+                       max(Cellular_num_tiles(source), 1),
+                       Cellular_tile_size(), index, num_bands);
+    } else {
+        Numa_copy_band(target->data, source->data, source->num_rows + 2,
+                       source->stride, index, num_bands);
+    }
+}
+
+struct CellularAutomaton *Cellular_duplicate_as(
+    const struct CellularAutomaton *automaton,
+    enum CellularLayout layout
+) {
+    struct CellularAutomaton *copy = Cellular_alloc(
+        automaton->num_rows, automaton->num_cols, automaton->type,
+        automaton->boundary, automaton->allowed_cells, automaton->rule,
+        layout
+    );
+    memset(copy->data, CELLULAR_UNINITIALIZED_STATE, Cellular_data_size(copy));
+    unsigned char *states = malloc(automaton->num_cols + 1);
     for (unsigned int i = 0; i < automaton->num_rows; ++i) {
-        for (unsigned int j = 0; j < automaton->num_cols; ++j) {
-            copy->cells[i][j] = automaton->cells[i][j];
-        }
+        Cellular_get_states(automaton, i, 0, automaton->num_cols, states);
+        Cellular_set_states(copy, i, 0, automaton->num_cols, states);
     }
+    free(states);
     return copy;
 }
 
+void Cellular_get_states(const struct CellularAutomaton *automaton,
+                         unsigned int row,
+                         unsigned int first_col,
+                         unsigned int num_cols,
+                         unsigned char *states) {
+    for (unsigned int j = 0; j < num_cols;) {
+        unsigned int length = Cellular_segment_length(automaton, first_col + j,
+                                                      num_cols - j);
+        memcpy(states + j, Cellular_cell(automaton, row, first_col + j),
+               length);
+        j += length;
+    }
+}
+
+void Cellular_set_states(struct CellularAutomaton *automaton,
+                         unsigned int row,
+                         unsigned int first_col,
+                         unsigned int num_cols,
+                         const unsigned char *states) {
+    for (unsigned int j = 0; j < num_cols;) {
+        unsigned int length = Cellular_segment_length(automaton, first_col + j,
+                                                      num_cols - j);
+        memcpy(Cellular_cell(automaton, row, first_col + j), states + j,
+               length);
+        j += length;
+    }
+}
+
 void Cellular_set_random(
     struct CellularAutomaton *automaton,
     const unsigned int *distribution
 ) {
-	time_t t;
-	srand((unsigned) time(&t));
-    for (unsigned int i = 0; i < automaton->num_rows; ++i) {
-        for (unsigned int j = 0; j < automaton->num_cols; ++j) {
-	        automaton->cells[i][j] =
-                Cellular_get_random_cell(automaton, distribution);
-        }
+    // The grids set within the same run, or in the same second, differ
+    static uint64_t seed;
+    static uint64_t num_grids = 0;
+    if (num_grids == 0) seed = Random_time_seed();
+    Cellular_set_random_seeded(automaton, distribution,
+                               Random_get(seed, num_grids++), 1);
+}
+
+void Cellular_set_random_seeded(
+    struct CellularAutomaton *automaton,
+    const unsigned int *distribution,
+    uint64_t seed,
+    unsigned int num_threads
+) {
+    struct CellularRandom random = {.automaton = automaton, .seed = seed};
+    Random_alias_init(&random.alias, distribution,
+                      Cellular_num_cells(automaton->type));
+    num_threads = min(num_threads, max(automaton->num_rows, 1));
+    if (num_threads <= 1) {
+        Cellular_set_random_band(&random, 0, 1);
+        return;
     }
+    struct Pool *pool = Pool_init(num_threads);
+    Pool_run(pool, Cellular_set_random_band, &random);
+    Pool_free(pool);
 }
 
 void Cellular_free(struct CellularAutomaton *automaton) {
-    for (unsigned int i = 0; i < automaton->num_rows; ++i) {
-        free(automaton->cells[i]);
-    }
+    free(automaton->data);
     free(automaton->cells);
+    free(automaton->tile_offsets);
+    free(automaton->tile_order);
     free(automaton->allowed_cells);
+    Rule_free(automaton->rule);
     free(automaton);
 }
 
+char Cellular_get(const struct CellularAutomaton *automaton,
+                  unsigned int row,
+                  unsigned int col) {
+    unsigned char state = *Cellular_cell(automaton, row, col);
+    return state < Cellular_num_cells(automaton->type) ?
+           automaton->allowed_cells[state] : UNINITIALIZED_CELL;
+}
+
+bool Cellular_set(struct CellularAutomaton *automaton,
+                  unsigned int row,
+                  unsigned int col,
+                  char cell) {
+    const char *allowed_cell = strchr(automaton->allowed_cells, cell);
+    if (cell == '\0' || allowed_cell == NULL) return false;
+    *Cellular_cell(automaton, row, col) = allowed_cell - automaton->allowed_cells;
+    return true;
+}
+
 void Cellular_print(const struct CellularAutomaton *automaton,
                     bool print_type) {
     if (print_type) Cellular_print_type(automaton);
+    // Only one row is formatted at a time, whatever the size of the grid
+    char *line = malloc(automaton->num_cols + 1);
     for (unsigned int i = 0; i < automaton->num_rows; ++i) {
-        for (unsigned int j = 0; j < automaton->num_cols; ++j) {
-            printf("%c", automaton->cells[i][j]);
-        }
-        printf("\n");
+        Cellular_format_rows(automaton, i, 1, line);
+        fwrite(line, sizeof(char), automaton->num_cols + 1, stdout);
     }
+    free(line);
+}
+
+size_t Cellular_text_size(const struct CellularAutomaton *automaton) {
+    return (size_t)automaton->num_rows * (automaton->num_cols + 1);
 }
 
+void Cellular_format_rows(const struct CellularAutomaton *automaton,
+                          unsigned int first_row,
+                          unsigned int num_rows,
+                          char *text) {
+    const unsigned int num_cols = automaton->num_cols;
+    char cells[CELLULAR_NUM_CHARS];
+    Cellular_fill_cells(automaton, cells);
+    for (unsigned int i = first_row; i < first_row + num_rows; ++i) {
+        // The states are read in place, then translated
+        Cellular_get_states(automaton, i, 0, num_cols, (unsigned char *)text);
+#ifdef CELLULAR_X86
+        if (Stencil_current() != STENCIL_SCALAR) {
+            Cellular_translate_sse2(automaton, cells, text, num_cols);
+        } else {
+            Cellular_translate_scalar(cells, text, num_cols);
+        }
+#else
+        Cellular_translate_scalar(cells, text, num_cols);
+#endif
+        text[num_cols] = '\n';
+        text += num_cols + 1;
+    }
+}
 
 struct CellularAutomaton *Cellular_next(
     const struct CellularAutomaton *automaton
 ) {
-    struct CellularAutomaton *next = Cellular_duplicate(automaton);
-    for (unsigned int i = 0; i < automaton->num_rows; ++i) {
-        for (unsigned int j = 0; j < automaton->num_cols; ++j) {
-            next->cells[i][j] = Cellular_next_cell(automaton, i, j);
+    struct CellularAutomaton *next = Cellular_alloc(
+        automaton->num_rows, automaton->num_cols, automaton->type,
+        automaton->boundary, automaton->allowed_cells, automaton->rule,
+        automaton->layout
+    );
+    Cellular_step_into(automaton, next);
+    return next;
+}
+
+void Cellular_step_into(const struct CellularAutomaton *src,
+                        struct CellularAutomaton *dst) {
+    Cellular_refresh_halo(src);
+    Cellular_next_cells(src, dst, 0, src->num_rows, 0, src->num_cols);
+}
+
+void Cellular_refresh_halo(const struct CellularAutomaton *automaton) {
+    if (automaton->layout == CELLULAR_MORTON) {
+        Cellular_refresh_morton_halo(automaton);
+        return;
+    }
+    CELLULAR_HALO_REFRESHERS[automaton->boundary](automaton);
+}
+
+void Cellular_step_rows(const struct CellularAutomaton *src,
+                        struct CellularAutomaton *dst,
+                        unsigned int first_row,
+                        unsigned int num_rows) {
+    Cellular_next_cells(src, dst, first_row, num_rows, 0, src->num_cols);
+}
+
+void Cellular_step_cells(const struct Rule *rule,
+                         const unsigned char *above,
+                         const unsigned char *row,
+                         const unsigned char *below,
+                         unsigned int num_cells,
+                         unsigned char *next) {
+    for (unsigned int j = 0; j < num_cells; j += CELLULAR_SEGMENT_SIZE) {
+        Cellular_next_segment(rule, above + j, row + j, below + j,
+                              min(CELLULAR_SEGMENT_SIZE, num_cells - j),
+                              next + j);
+    }
+}
+
+bool Cellular_step_tile(const struct CellularAutomaton *src,
+                        struct CellularAutomaton *dst,
+                        unsigned int first_row,
+                        unsigned int num_rows,
+                        unsigned int first_col,
+                        unsigned int num_cols) {
+    Cellular_next_cells(src, dst, first_row, num_rows, first_col, num_cols);
+    bool has_changed = false;
+    for (unsigned int i = first_row; i < first_row + num_rows; ++i) {
+        for (unsigned int j = first_col; j < first_col + num_cols;) {
+            unsigned int length = Cellular_segment_length(
+                src, j, first_col + num_cols - j
+            );
+            has_changed |= memcmp(Cellular_cell(src, i, j),
+                                  Cellular_cell(dst, i, j), length) != 0;
+            j += length;
         }
     }
-    return next;
+    return has_changed;
+}
+
+bool Cellular_set_rule(struct CellularAutomaton *automaton,
+                       const char *rulestring) {
+    if (automaton->type != CELLULAR_GAME_OF_LIFE) return false;
+    struct Rule *rule = Rule_parse_life(rulestring);
+    if (rule == NULL) return false;
+    Rule_free(automaton->rule);
+    automaton->rule = rule;
+    return true;
+}
+
+struct Rule *Cellular_default_rule(enum CellularType type) {
+    switch (type) {
+        case CELLULAR_PANDEMY:
+            return Rule_compile(Cellular_num_cells(type),
+                                Cellular_next_cell_pandemy);
+        case CELLULAR_FIRE:
+            return Rule_compile(Cellular_num_cells(type),
+                                Cellular_next_cell_fire);
+        default:
+            return Rule_parse_life(CELLULAR_GAME_OF_LIFE_RULESTRING);
+    }
 }
 
 unsigned int Cellular_num_cells(enum CellularType type) {
@@ -444,16 +1067,19 @@ bool Cellular_is_valid(enum CellularType type, const char *allowed_cells) {
 }
 
 void Cellular_Valid_StateCells(const char *allowed_cells,
-const struct CellularAutomaton * automaton){
+                               const InitialState *cellularArray) {
+    unsigned char states[CELLULAR_NUM_CHARS];
+    Cellular_fill_states(allowed_cells, states);
 
-    //for all cells in automaton
-    for (unsigned int i = 0; i < automaton->num_rows; i++)
+    //for all cells in the initial state
+    for (unsigned int i = 0; i < cellularArray->row; i++)
     {
-        for (unsigned int j = 0; j < automaton->num_cols; j++)
+        for (unsigned int j = 0; j < cellularArray->col; j++)
         {
+            char cell = cellularArray->elemets[i][j];
             //if there is a cell that is not allowed
-            if(strchr(allowed_cells, automaton->cells[i][j])==NULL){
-                fprintf(stderr,"Error: The cell state '%c' is not allowed\n",automaton->cells[i][j]);
+            if(states[(unsigned char)cell] == CELLULAR_UNINITIALIZED_STATE){
+                fprintf(stderr,"Error: The cell state '%c' is not allowed\n",cell);
                 exit(9);
 
             }
@@ -461,4 +1087,4 @@ const struct CellularAutomaton * automaton){
         
     }
    
-}
\ No newline at end of file
+}
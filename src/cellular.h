@@ -10,8 +10,31 @@
 #define CELLULAR_H
 
 #define UNINITIALIZED_CELL '?'
+#define CELLULAR_UNINITIALIZED_STATE 0xFF
+#define CELLULAR_NUM_CHARS 256
+#define CELLULAR_ALIGNMENT 64
+#define CELLULAR_MORTON_TILE_SIZE 64
+
+/**
+ * The rule of the game of life (from Wikipedia):
+ *
+ * 1. A cell is either live or dead.
+ * 2. The neighbordhood of a cell includes diagonals.
+ * 3. Any live cell with fewer than two live neighbors dies, as if by under
+ *    population.
+ * 4. Any live cell with two or three live neighbors lives on to the next
+ *    generation.
+ * 5. Any live cell with more than three live neighbors dies, as if by
+ *    overpopulation.
+ * 6. Any dead cell with exactly three live neighbors becomes a live cell, as
+ *    if by reproduction.
+ */
+#define CELLULAR_GAME_OF_LIFE_RULESTRING "B3/S23"
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "rule.h"
 
 // ----- //
 // Types //
@@ -33,24 +56,99 @@ enum CellularType {
     CELLULAR_FIRE                   /**< Fire propagation */
 };
 
+/**
+ * The states of a pandemy-type cellular automaton.
+ */
+enum CellularPandemyState {
+    CELLULAR_PANDEMY_EMPTY,         /**< Unoccupied */
+    CELLULAR_PANDEMY_SICK,          /**< Sick */
+    CELLULAR_PANDEMY_HEALTHY        /**< Healthy */
+};
+
+/**
+ * The states of a game-of-life-type cellular automaton.
+ */
+enum CellularGameOfLifeState {
+    CELLULAR_GAME_OF_LIFE_DEAD,     /**< Dead */
+    CELLULAR_GAME_OF_LIFE_LIVE      /**< Live */
+};
+
+/**
+ * The states of a fire-type cellular automaton.
+ */
+enum CellularFireState {
+    CELLULAR_FIRE_GROWING,          /**< Growing */
+    CELLULAR_FIRE_IGNITABLE,        /**< Ignitable */
+    CELLULAR_FIRE_BURNING,          /**< Burning */
+    CELLULAR_FIRE_BURNT             /**< Burnt */
+};
+
 /**
  * The type of boundary of the cellular automaton.
  */
 enum CellularBoundary {
     CELLULAR_TRUNCATE,              /**< Truncate the neighborhood */
-    CELLULAR_WRAP_AROUND            /**< The neighborhood is a torus */
+    CELLULAR_WRAP_AROUND,           /**< The neighborhood is a torus */
+    CELLULAR_UNBOUNDED              /**< The grid is a window on a plane */
+};
+
+/**
+ * The layout of the cells of a cellular automaton in memory.
+ */
+enum CellularLayout {
+    CELLULAR_ROW_MAJOR,             /**< One row after the other */
+    CELLULAR_MORTON                 /**< Square tiles along a Z-order curve */
 };
 
 /**
  * A cellular automaton.
+ *
+ * Internally, a cell is represented by its state, which is the index of the
+ * corresponding character in `allowed_cells` (see e.g. `enum
+ * CellularPandemyState`). The characters are only used when reading or
+ * displaying the automaton, through `Cellular_get` and `Cellular_set`.
+ *
+ * The cells are stored in a single contiguous buffer, `data`, aligned on
+ * `CELLULAR_ALIGNMENT` bytes. Consecutive rows are `stride` bytes apart and
+ * each row starts on an aligned address. For convenience, `cells[i]` points
+ * to the beginning of row `i`, so that `cells[i][j]` is the state of the cell
+ * at row `i` and column `j`.
+ *
+ * The grid is surrounded by a one-cell halo, refreshed before each step
+ * according to the boundary, so that the neighbors of any cell can be read
+ * directly: `cells[i][-1]` and `cells[i][num_cols]` are the left and right
+ * halo cells, and the halo rows are `stride` bytes before the first row and
+ * after the last one.
+ *
+ * The cells are updated according to `rule`, which is the rule of the type
+ * of the automaton unless it is replaced with `Cellular_set_rule`.
+ *
+ * With the Morton layout, the grid is rather split into square tiles of
+ * `CELLULAR_MORTON_TILE_SIZE` cells, stored one after the other in the order
+ * of the Z-order curve, so that the rows above and below a cell are close to
+ * it. Each tile has its own one-cell halo, and `stride` is the distance
+ * between two rows of a tile. There is no `cells` array: a cell is accessed
+ * through `Cellular_cell`, which supports both layouts.
+ *
+ * With an unbounded boundary, the grid only stores the window of an infinite
+ * plane whose other cells are in state 0. Updating the plane itself requires
+ * the sparse engine of `engine.h`: stepping the automaton alone behaves as
+ * if the boundary was truncated.
  */
 struct CellularAutomaton {
     unsigned int num_rows;          /**< Its number of rows */
     unsigned int num_cols;          /**< Its number of columns */
     char *allowed_cells;            /**< The allowed cells */
-    char **cells;                   /**< Its cells */
+    enum CellularLayout layout;     /**< The layout of its states */
+    unsigned char **cells;          /**< Its states, row by row, if row-major */
+    unsigned char *data;            /**< The storage of the states */
+    size_t stride;                  /**< The distance between two rows */
+    unsigned int num_tile_cols;     /**< The number of columns of tiles */
+    size_t *tile_offsets;           /**< The offset of each tile in `data` */
+    unsigned int *tile_order;       /**< The tiles in the order of `data` */
     enum CellularType type;         /**< Its type */
     enum CellularBoundary boundary; /**< Its boundary type */
+    struct Rule *rule;              /**< Its rule */
 };
 
 // --------- //
@@ -109,10 +207,140 @@ struct CellularAutomaton *Cellular_duplicate(
     const struct CellularAutomaton *automaton
 );
 
+/**
+ * Returns a copy of a cellular automaton with another layout.
+ *
+ * @param automaton  The automaton to copy
+ * @param layout     The layout of the copy
+ * @return           A copy of the automaton
+ */
+struct CellularAutomaton *Cellular_duplicate_as(
+    const struct CellularAutomaton *automaton,
+    enum CellularLayout layout
+);
+
+/**
+ * Creates an automaton like another one, whose cells are left unset.
+ *
+ * The cells are not even touched, so that their pages are placed on the NUMA
+ * nodes of the threads first writing them, e.g. with `Cellular_copy_band`.
+ *
+ * @param automaton  The automaton
+ * @return           An automaton with the same dimensions, rule and layout
+ */
+struct CellularAutomaton *Cellular_alloc_like(
+    const struct CellularAutomaton *automaton
+);
+
+/**
+ * Copies a band of the cells of an automaton into another one, halo
+ * included.
+ *
+ * With the row-major layout, the bands are made of consecutive rows, halo
+ * rows included, so that they nearly match the bands computed by the threads
+ * of an engine. With the Morton layout, they are made of consecutive tiles
+ * along the Z-order curve.
+ *
+ * @param source     The automaton to copy
+ * @param target     An automaton created by `Cellular_alloc_like`
+ * @param index      The index of the band
+ * @param num_bands  The number of bands
+ */
+void Cellular_copy_band(const struct CellularAutomaton *source,
+                        struct CellularAutomaton *target,
+                        unsigned int index,
+                        unsigned int num_bands);
+
+/**
+ * Returns the address of the state of a cell, whatever the layout.
+ *
+ * Note: with the Morton layout, the tiles are numbered row by row, and the
+ * cells of a row of a tile are contiguous.
+ *
+ * @param automaton  The automaton
+ * @param row        The row number
+ * @param col        The column number
+ * @return           The address of its state
+ */
+static inline unsigned char *Cellular_cell(
+    const struct CellularAutomaton *automaton,
+    unsigned int row,
+    unsigned int col
+) {
+    if (automaton->layout == CELLULAR_ROW_MAJOR) {
+        return automaton->cells[row] + col;
+    }
+    const unsigned int size = CELLULAR_MORTON_TILE_SIZE;
+    unsigned int tile = row / size * automaton->num_tile_cols + col / size;
+    return automaton->data + automaton->tile_offsets[tile]
+         + (row % size + 1) * automaton->stride + col % size + 1;
+}
+
+/**
+ * Copies the states of consecutive cells of a row, whatever the layout.
+ *
+ * @param automaton  The automaton
+ * @param row        The row number
+ * @param first_col  The first column
+ * @param num_cols   The number of columns
+ * @param states     The copied states
+ */
+void Cellular_get_states(const struct CellularAutomaton *automaton,
+                         unsigned int row,
+                         unsigned int first_col,
+                         unsigned int num_cols,
+                         unsigned char *states);
+
+/**
+ * Sets the states of consecutive cells of a row, whatever the layout.
+ *
+ * @param automaton  The automaton
+ * @param row        The row number
+ * @param first_col  The first column
+ * @param num_cols   The number of columns
+ * @param states     The new states
+ */
+void Cellular_set_states(struct CellularAutomaton *automaton,
+                         unsigned int row,
+                         unsigned int first_col,
+                         unsigned int num_cols,
+                         const unsigned char *states);
+
+/**
+ * Returns the cell at given row and column, as an allowed cell.
+ *
+ * If the cell is not initialized, `UNINITIALIZED_CELL` is returned.
+ *
+ * @param automaton  The automaton
+ * @param row        The row number
+ * @param col        The column number
+ * @return           The cell
+ */
+char Cellular_get(const struct CellularAutomaton *automaton,
+                  unsigned int row,
+                  unsigned int col);
+
+/**
+ * Sets the cell at given row and column from an allowed cell.
+ *
+ * Note: if the cell is not allowed, nothing happens.
+ *
+ * @param automaton  The automaton
+ * @param row        The row number
+ * @param col        The column number
+ * @param cell       The allowed cell
+ * @return           True if the cell is allowed
+ */
+bool Cellular_set(struct CellularAutomaton *automaton,
+                  unsigned int row,
+                  unsigned int col,
+                  char cell);
+
 /**
  * Randomly sets the cells with respect to the uniform distribution.
  *
- * The probability distribution is given by positive weights.
+ * The probability distribution is given by positive weights. Each call draws
+ * a new grid, from a seed that differs from one run to another.
  *
  * @param automaton     The automaton to set
  * @param distribution  The probability distribution
@@ -122,6 +350,25 @@ void Cellular_set_random(
     const unsigned int *distribution
 );
 
+/**
+ * Randomly sets the cells from a seed, as `Cellular_set_random`.
+ *
+ * The cells only depend on the seed, the size and the distribution, so that
+ * the same seed always yields the same grid, whatever the number of threads
+ * drawing its bands of rows (see `random.h`).
+ *
+ * @param automaton     The automaton to set
+ * @param distribution  The probability distribution
+ * @param seed          The seed
+ * @param num_threads   The number of threads
+ */
+void Cellular_set_random_seeded(
+    struct CellularAutomaton *automaton,
+    const unsigned int *distribution,
+    uint64_t seed,
+    unsigned int num_threads
+);
+
 /**
  * Frees the given automaton.
  *
@@ -132,12 +379,42 @@ void Cellular_free(struct CellularAutomaton *automaton);
 /**
  * Prints the given automaton to stdout.
  *
+ * The grid is formatted row by row by `Cellular_format_rows`, in a buffer
+ * of a single row.
+ *
  * @param automaton   The automaton to print
  * @param print_type  If true, also prints the type
  */
 void Cellular_print(const struct CellularAutomaton *automaton,
                     bool print_type);
 
+/**
+ * Returns the size of the text of the rows of an automaton, as printed by
+ * `Cellular_print`.
+ *
+ * @param automaton  The automaton
+ * @return           The number of characters, newlines included
+ */
+size_t Cellular_text_size(const struct CellularAutomaton *automaton);
+
+/**
+ * Formats a band of rows of an automaton as text, each row being followed by
+ * a newline.
+ *
+ * The states are translated into their cells 16 at a time, with SSE2
+ * instructions unless the scalar kernel is selected (see `stencil.h`).
+ * Disjoint bands can be formatted in parallel.
+ *
+ * @param automaton  The automaton
+ * @param first_row  The first row of the band
+ * @param num_rows   The number of rows of the band
+ * @param text       The text, of `num_rows * (num_cols + 1)` characters
+ */
+void Cellular_format_rows(const struct CellularAutomaton *automaton,
+                          unsigned int first_row,
+                          unsigned int num_rows,
+                          char *text);
+
 /**
  * Returns an automaton updated according to the rules.
  *
@@ -148,6 +425,104 @@ struct CellularAutomaton *Cellular_next(
     const struct CellularAutomaton *automaton
 );
 
+/**
+ * Writes the next step of an automaton into another automaton.
+ *
+ * Contrary to `Cellular_next`, nothing is allocated: every cell of `dst` is
+ * overwritten. Hence, a simulation can alternate between two automata,
+ * swapping them after each step.
+ *
+ * Note: both automata must have the same dimensions, type, boundary and
+ * allowed cells, e.g. `dst` can be obtained with `Cellular_duplicate(src)`.
+ *
+ * @param src  The automaton to update
+ * @param dst  The automaton receiving the updated cells
+ */
+void Cellular_step_into(const struct CellularAutomaton *src,
+                        struct CellularAutomaton *dst);
+
+/**
+ * Refreshes the halo of an automaton according to its boundary.
+ *
+ * This must be done before updating its rows with `Cellular_step_rows`.
+ * Since the halo is derived from the cells, it can be refreshed through a
+ * constant automaton.
+ *
+ * @param automaton  The automaton whose halo is refreshed
+ */
+void Cellular_refresh_halo(const struct CellularAutomaton *automaton);
+
+/**
+ * Writes the next step of a band of rows into another automaton.
+ *
+ * Contrary to `Cellular_step_into`, the halo of `src` is not refreshed: see
+ * `Cellular_refresh_halo`. Since only the given rows of `dst` are written,
+ * and since every row starts on its own cache line, disjoint bands can be
+ * updated in parallel.
+ *
+ * @param src        The automaton to update
+ * @param dst        The automaton receiving the updated cells
+ * @param first_row  The first row of the band
+ * @param num_rows   The number of rows of the band
+ */
+void Cellular_step_rows(const struct CellularAutomaton *src,
+                        struct CellularAutomaton *dst,
+                        unsigned int first_row,
+                        unsigned int num_rows);
+
+/**
+ * Writes the next states of consecutive cells of a row according to a rule.
+ *
+ * The neighbors of the cells must be readable, i.e. from `row[-1]` to
+ * `row[num_cells]`, and the same for `above` and `below`.
+ *
+ * @param rule       The rule
+ * @param above      The cells of the row above
+ * @param row        The cells of the row
+ * @param below      The cells of the row below
+ * @param num_cells  The number of cells
+ * @param next       The next states of the cells
+ */
+void Cellular_step_cells(const struct Rule *rule,
+                         const unsigned char *above,
+                         const unsigned char *row,
+                         const unsigned char *below,
+                         unsigned int num_cells,
+                         unsigned char *next);
+
+/**
+ * Writes the next step of a rectangle of cells into another automaton, and
+ * tells if any of them has changed.
+ *
+ * As for `Cellular_step_rows`, the halo of `src` must be up to date. The
+ * cells of `dst` outside of the rectangle are left untouched.
+ *
+ * @param src        The automaton to update
+ * @param dst        The automaton receiving the updated cells
+ * @param first_row  The first row of the rectangle
+ * @param num_rows   The number of rows of the rectangle
+ * @param first_col  The first column of the rectangle
+ * @param num_cols   The number of columns of the rectangle
+ * @return           True if and only if a cell of the rectangle has changed
+ */
+bool Cellular_step_tile(const struct CellularAutomaton *src,
+                        struct CellularAutomaton *dst,
+                        unsigned int first_row,
+                        unsigned int num_rows,
+                        unsigned int first_col,
+                        unsigned int num_cols);
+
+/**
+ * Replaces the rule of a game-of-life-type automaton with a Life-like rule.
+ *
+ * @param automaton   The automaton
+ * @param rulestring  The rulestring of the rule, e.g. "B36/S23"
+ * @return            True if the automaton is of game-of-life type and the
+ *                    rulestring is valid
+ */
+bool Cellular_set_rule(struct CellularAutomaton *automaton,
+                       const char *rulestring);
+
 /**
  * Returns the number of allowed cells for a given type.
  *
@@ -156,6 +531,14 @@ struct CellularAutomaton *Cellular_next(
  */
 unsigned int Cellular_num_cells(enum CellularType type);
 
+/**
+ * Returns the default rule of a type of cellular automaton.
+ *
+ * @param type  The type of cellular automaton
+ * @return      Its rule, to be freed with `Rule_free`
+ */
+struct Rule *Cellular_default_rule(enum CellularType type);
+
 /**
  * Returns true if the type of cellular is consistent with the given allowed
  * cells.
@@ -171,10 +554,10 @@ bool Cellular_is_valid(enum CellularType type, const char *allowed_cells);
  * allowed in the given initial state.
  *
  * @param allowed_cells  The allowed cells
- * @param automaton      The automaton to verify.
+ * @param cellularArray  The initial state to verify, of size `row` x `col`
  * 
  */
 void Cellular_Valid_StateCells(const char *allowed_cells,
-const struct CellularAutomaton * automaton);
+                               const InitialState *cellularArray);
 
 #endif
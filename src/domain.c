@@ -0,0 +1,469 @@
+/**
+ * Implements domain.h.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "domain.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "utils.h"
+
+/**
+ * The neighbor of a slab that does not exist.
+ */
+#define DOMAIN_NO_NEIGHBOR UINT_MAX
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Creates a POSIX shared memory segment and maps it in memory.
+ *
+ * The segment is unlinked at once: it stays reachable through the mapping,
+ * which is inherited by the forked workers, and disappears with them.
+ *
+ * @param size  The size of the segment, at least 1
+ * @return      The mapped segment, or NULL in case of failure
+ */
+unsigned char *Domain_map(size_t size) {
+    static unsigned int num_segments = 0;
+    char name[64];
+    snprintf(name, sizeof(name), "/automaton-%ld-%u", (long)getpid(),
+             num_segments++);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return NULL;
+    shm_unlink(name);
+    void *shared = MAP_FAILED;
+    if (ftruncate(fd, size) == 0) {
+        shared = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    return shared == MAP_FAILED ? NULL : shared;
+}
+
+/**
+ * Returns the first row of the slab of a worker.
+ *
+ * @param domain  The decomposition
+ * @param worker  The worker, or `num_workers` for the end of the grid
+ * @return        The first row of its slab
+ */
+unsigned int Domain_first_row(const struct Domain *domain,
+                              unsigned int worker) {
+    return (unsigned long)domain->num_rows * worker / domain->num_workers;
+}
+
+/**
+ * Returns a row published by a worker.
+ *
+ * @param domain   The decomposition
+ * @param worker   The worker
+ * @param parity   The parity of the step
+ * @param is_last  If true, the last row of its slab, otherwise the first one
+ * @return         The published row
+ */
+unsigned char *Domain_published_row(const struct Domain *domain,
+                                    unsigned int worker,
+                                    unsigned int parity,
+                                    bool is_last) {
+    return domain->halos
+         + (((size_t)worker * 2 + parity) * 2 + is_last) * domain->num_cols;
+}
+
+/**
+ * Copies a row of a neighboring slab into a halo row of a slab.
+ *
+ * @param slab  The slab
+ * @param halo  The halo row, whose halo cells are also set
+ * @param row   The row of the neighboring slab
+ */
+void Domain_fill_halo(const struct CellularAutomaton *slab,
+                      unsigned char *halo,
+                      const unsigned char *row) {
+    unsigned int num_cols = slab->num_cols;
+    bool wraps = slab->boundary == CELLULAR_WRAP_AROUND;
+    memcpy(halo, row, num_cols);
+    halo[-1] = wraps ? row[num_cols - 1] : 0;
+    halo[num_cols] = wraps ? row[0] : 0;
+}
+
+/**
+ * Signals an eventfd once.
+ *
+ * @param event  The eventfd
+ * @return       True if and only if the signal was sent
+ */
+bool Domain_notify(int event) {
+    uint64_t one = 1;
+    ssize_t size;
+    do {
+        size = write(event, &one, sizeof(one));
+    } while (size < 0 && errno == EINTR);
+    return size == sizeof(one);
+}
+
+/**
+ * Waits for one signal of an eventfd in semaphore mode.
+ *
+ * @param event  The eventfd
+ * @return       True if and only if a signal was received
+ */
+bool Domain_wait(int event) {
+    uint64_t count;
+    ssize_t size;
+    do {
+        size = read(event, &count, sizeof(count));
+    } while (size < 0 && errno == EINTR);
+    return size == sizeof(count);
+}
+
+/**
+ * Receives the number of steps of a call on the channel of a worker.
+ *
+ * @param channel    The socket of the worker
+ * @param num_steps  The number of steps
+ * @return           The number of bytes received, 0 if the caller closed
+ *                   the channel, or -1 in case of failure
+ */
+ssize_t Domain_receive(int channel, unsigned int *num_steps) {
+    ssize_t size;
+    do {
+        size = recv(channel, num_steps, sizeof(*num_steps), 0);
+    } while (size < 0 && errno == EINTR);
+    return size;
+}
+
+/**
+ * Computes the steps of the slab of a worker, in the worker process, for
+ * each call until the caller closes the channel of the worker.
+ *
+ * Each worker has two eventfds: the first one is signaled by the neighbor
+ * above when it has published its rows, and the second one by the neighbor
+ * below, so that a neighbor one step ahead cannot be mistaken for the other.
+ * The published rows alternate between two buffers over all the steps of
+ * all the calls.
+ *
+ * @param domain   The decomposition
+ * @param worker   The worker
+ * @param channel  The socket of the worker
+ * @return         The exit status of the worker
+ */
+int Domain_work(const struct Domain *domain,
+                unsigned int worker,
+                int channel) {
+    const int *events = domain->events;
+    const unsigned int num_cols = domain->num_cols;
+    unsigned int first_row = Domain_first_row(domain, worker);
+    unsigned int num_rows = Domain_first_row(domain, worker + 1) - first_row;
+    bool wraps = domain->boundary == CELLULAR_WRAP_AROUND;
+    unsigned int last_worker = domain->num_workers - 1;
+    unsigned int above = worker > 0 ? worker - 1
+                       : wraps ? last_worker : DOMAIN_NO_NEIGHBOR;
+    unsigned int below = worker < last_worker ? worker + 1
+                       : wraps ? 0 : DOMAIN_NO_NEIGHBOR;
+    // The caller swaps its grids after each successful call, as does this copy
+    unsigned char *grids[2] = {domain->grids[0], domain->grids[1]};
+
+    struct CellularAutomaton *slab =
+        Cellular_init(num_rows, num_cols, domain->type, domain->boundary,
+                      domain->allowed_cells);
+    Rule_free(slab->rule);
+    slab->rule = Rule_duplicate(domain->rule);
+    for (unsigned int i = 0; i < num_rows; ++i) {
+        Cellular_set_states(slab, i, 0, num_cols,
+                            grids[0] + (size_t)(first_row + i) * num_cols);
+    }
+    struct CellularAutomaton *next = Cellular_duplicate(slab);
+
+    unsigned int parity = 0;
+    unsigned int num_steps;
+    ssize_t size;
+    while ((size = Domain_receive(channel, &num_steps)) > 0) {
+        if (size != sizeof(num_steps) || num_steps == 0) return EXIT_FAILURE;
+        for (unsigned int step = 0; step < num_steps; ++step) {
+            memcpy(Domain_published_row(domain, worker, parity, false),
+                   slab->cells[0], num_cols);
+            memcpy(Domain_published_row(domain, worker, parity, true),
+                   slab->cells[num_rows - 1], num_cols);
+            if ((above != DOMAIN_NO_NEIGHBOR &&
+                 !Domain_notify(events[2 * above + 1])) ||
+                (below != DOMAIN_NO_NEIGHBOR &&
+                 !Domain_notify(events[2 * below]))) {
+                return EXIT_FAILURE;
+            }
+            // Sets the halo columns, and the halo rows beyond a truncated grid
+            Cellular_refresh_halo(slab);
+            if (above != DOMAIN_NO_NEIGHBOR) {
+                if (!Domain_wait(events[2 * worker])) return EXIT_FAILURE;
+                Domain_fill_halo(slab, slab->cells[0] - slab->stride,
+                                 Domain_published_row(domain, above, parity,
+                                                      true));
+            }
+            if (below != DOMAIN_NO_NEIGHBOR) {
+                if (!Domain_wait(events[2 * worker + 1])) return EXIT_FAILURE;
+                Domain_fill_halo(slab,
+                                 slab->cells[num_rows - 1] + slab->stride,
+                                 Domain_published_row(domain, below, parity,
+                                                      false));
+            }
+            Cellular_step_rows(slab, next, 0, num_rows);
+            struct CellularAutomaton *previous = slab;
+            slab = next;
+            next = previous;
+            parity = 1 - parity;
+        }
+        for (unsigned int i = 0; i < num_rows; ++i) {
+            Cellular_get_states(slab, i, 0, num_cols, grids[1]
+                                + (size_t)(first_row + i) * num_cols);
+        }
+        unsigned char *grid = grids[0];
+        grids[0] = grids[1];
+        grids[1] = grid;
+        char done = 1;
+        if (send(channel, &done, 1, MSG_NOSIGNAL) != 1) return EXIT_FAILURE;
+    }
+    Cellular_free(slab);
+    Cellular_free(next);
+    return size == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Waits for the reply of every worker to a call.
+ *
+ * A worker that exits closes its socket, which the caller reads as the end
+ * of the file rather than as a reply.
+ *
+ * @param domain  The decomposition
+ * @return        True if and only if all the workers replied
+ */
+bool Domain_wait_replies(const struct Domain *domain) {
+    unsigned int num_workers = domain->num_workers;
+    struct pollfd *fds = malloc(num_workers * sizeof(struct pollfd));
+    for (unsigned int k = 0; k < num_workers; ++k) {
+        fds[k].fd = domain->channels[k];
+        fds[k].events = POLLIN;
+    }
+    bool has_failed = false;
+    unsigned int num_waiting = num_workers;
+    while (!has_failed && num_waiting > 0) {
+        if (poll(fds, num_workers, -1) < 0) {
+            has_failed = errno != EINTR;
+            continue;
+        }
+        for (unsigned int k = 0; k < num_workers && !has_failed; ++k) {
+            if (fds[k].fd < 0 || fds[k].revents == 0) continue;
+            char done;
+            ssize_t size;
+            do {
+                size = recv(fds[k].fd, &done, 1, 0);
+            } while (size < 0 && errno == EINTR);
+            has_failed = size != 1;
+            // Ignored by the next polls
+            fds[k].fd = -1;
+            --num_waiting;
+        }
+    }
+    free(fds);
+    return !has_failed;
+}
+
+/**
+ * Waits for the recorded workers to exit.
+ *
+ * @param pids         The processes of the workers, 0 for those already
+ *                     joined, set to 0
+ * @param num_workers  The number of workers
+ * @return             True if and only if all the workers succeeded
+ */
+bool Domain_join(pid_t *pids, unsigned int num_workers) {
+    bool has_failed = false;
+    for (unsigned int k = 0; k < num_workers; ++k) {
+        if (pids[k] <= 0) continue;
+        int status;
+        pid_t pid;
+        do {
+            pid = waitpid(pids[k], &status, 0);
+        } while (pid < 0 && errno == EINTR);
+        if (pid < 0 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_SUCCESS) {
+            has_failed = true;
+        }
+        pids[k] = 0;
+    }
+    return !has_failed;
+}
+
+/**
+ * Stops the workers of a decomposition, and closes their eventfds and
+ * sockets.
+ *
+ * The sockets are shut down rather than only closed, since the workers of
+ * another decomposition may have inherited them.
+ *
+ * @param domain  The decomposition
+ * @param kills   If true, the workers are killed, otherwise they exit once
+ *                their socket is shut down
+ * @return        True if and only if all the workers succeeded
+ */
+bool Domain_stop(struct Domain *domain, bool kills) {
+    unsigned int num_workers = domain->num_workers;
+    for (unsigned int k = 0; k < num_workers; ++k) {
+        if (kills && domain->pids[k] > 0) kill(domain->pids[k], SIGKILL);
+        if (domain->channels[k] >= 0) {
+            shutdown(domain->channels[k], SHUT_WR);
+            close(domain->channels[k]);
+        }
+        domain->channels[k] = -1;
+    }
+    bool has_succeeded = Domain_join(domain->pids, num_workers);
+    for (unsigned int k = 0; k < 2 * num_workers; ++k) {
+        if (domain->events[k] >= 0) close(domain->events[k]);
+        domain->events[k] = -1;
+    }
+    return has_succeeded;
+}
+
+/**
+ * Creates the eventfds and the sockets of the workers of a decomposition,
+ * and forks them.
+ *
+ * @param domain  The decomposition, whose current grid is scattered
+ * @return        True if and only if all the workers were started
+ */
+bool Domain_start(struct Domain *domain) {
+    unsigned int num_workers = domain->num_workers;
+    int *sockets = malloc(num_workers * sizeof(int));
+    bool has_failed = false;
+    for (unsigned int k = 0; k < 2 * num_workers; ++k) {
+        domain->events[k] = has_failed ? -1 : eventfd(0, EFD_SEMAPHORE);
+        has_failed = domain->events[k] < 0;
+    }
+    for (unsigned int k = 0; k < num_workers; ++k) {
+        int pair[2] = {-1, -1};
+        if (!has_failed) {
+            has_failed = socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0;
+        }
+        domain->channels[k] = pair[0];
+        sockets[k] = pair[1];
+    }
+    for (unsigned int k = 0; k < num_workers && !has_failed; ++k) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            // Only keeps its own socket, so that the others see their end
+            for (unsigned int j = 0; j < num_workers; ++j) {
+                close(domain->channels[j]);
+                if (j != k) close(sockets[j]);
+            }
+            // Leaves the buffers of the caller, e.g. stdout, to the caller
+            _exit(Domain_work(domain, k, sockets[k]));
+        }
+        has_failed = pid < 0;
+        domain->pids[k] = pid > 0 ? pid : 0;
+    }
+    for (unsigned int k = 0; k < num_workers; ++k) {
+        if (sockets[k] >= 0) close(sockets[k]);
+    }
+    free(sockets);
+    if (has_failed) Domain_stop(domain, true);
+    return !has_failed;
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Domain *Domain_init(const struct CellularAutomaton *automaton,
+                           unsigned int num_workers) {
+    if (automaton->boundary == CELLULAR_UNBOUNDED) return NULL;
+    num_workers = max(min(num_workers, automaton->num_rows), 1);
+    size_t grid_size = (size_t)automaton->num_rows * automaton->num_cols;
+    size_t size = 2 * grid_size
+                + 4 * (size_t)num_workers * automaton->num_cols + 1;
+    unsigned char *shared = Domain_map(size);
+    if (shared == NULL) return NULL;
+    struct Domain *domain = malloc(sizeof(struct Domain));
+    domain->num_rows = automaton->num_rows;
+    domain->num_cols = automaton->num_cols;
+    domain->type = automaton->type;
+    domain->boundary = automaton->boundary;
+    domain->allowed_cells = strdupli(automaton->allowed_cells);
+    domain->rule = Rule_duplicate(automaton->rule);
+    domain->num_workers = num_workers;
+    domain->size = size;
+    domain->shared = shared;
+    domain->grids[0] = shared;
+    domain->grids[1] = shared + grid_size;
+    domain->halos = shared + 2 * grid_size;
+    domain->pids = calloc(num_workers, sizeof(pid_t));
+    domain->events = malloc(2 * num_workers * sizeof(int));
+    domain->channels = malloc(num_workers * sizeof(int));
+    domain->has_failed = false;
+    for (unsigned int k = 0; k < num_workers; ++k) {
+        domain->events[2 * k] = domain->events[2 * k + 1] = -1;
+        domain->channels[k] = -1;
+    }
+    for (unsigned int i = 0; i < domain->num_rows; ++i) {
+        Cellular_get_states(automaton, i, 0, domain->num_cols,
+                            domain->grids[0] + (size_t)i * domain->num_cols);
+    }
+    // An empty grid has no step to compute
+    if (grid_size > 0 && !Domain_start(domain)) {
+        Domain_free(domain);
+        return NULL;
+    }
+    return domain;
+}
+
+bool Domain_step(struct Domain *domain, unsigned int num_steps) {
+    if (num_steps == 0 || domain->num_rows == 0 || domain->num_cols == 0) {
+        return true;
+    } else if (domain->has_failed) {
+        return false;
+    }
+    bool has_failed = false;
+    for (unsigned int k = 0; k < domain->num_workers && !has_failed; ++k) {
+        has_failed = send(domain->channels[k], &num_steps, sizeof(num_steps),
+                          MSG_NOSIGNAL) != sizeof(num_steps);
+    }
+    if (has_failed || !Domain_wait_replies(domain)) {
+        // The neighbors of a failed worker would wait for it forever
+        Domain_stop(domain, true);
+        domain->has_failed = true;
+        return false;
+    }
+    unsigned char *grid = domain->grids[0];
+    domain->grids[0] = domain->grids[1];
+    domain->grids[1] = grid;
+    return true;
+}
+
+void Domain_store(const struct Domain *domain,
+                  struct CellularAutomaton *automaton) {
+    for (unsigned int i = 0; i < domain->num_rows; ++i) {
+        Cellular_set_states(automaton, i, 0, domain->num_cols,
+                            domain->grids[0] + (size_t)i * domain->num_cols);
+    }
+}
+
+void Domain_free(struct Domain *domain) {
+    Domain_stop(domain, false);
+    munmap(domain->shared, domain->size);
+    free(domain->allowed_cells);
+    Rule_free(domain->rule);
+    free(domain->pids);
+    free(domain->events);
+    free(domain->channels);
+    free(domain);
+}
@@ -0,0 +1,108 @@
+/**
+ * Provides the decomposition of a cellular automaton between processes.
+ *
+ * The grid is split into horizontal slabs of consecutive rows, each owned by
+ * a worker process forked once with the decomposition. Each worker keeps its
+ * slab in its own memory, as a cellular automaton whose halo rows are
+ * received from the neighboring slabs: at each step, every worker publishes
+ * its first and last rows in a POSIX shared memory segment and signals its
+ * neighbors through their eventfd, then waits for the rows of its neighbors
+ * before computing its step. The first and last slabs are neighbors if the boundary
+ * wraps around, a single worker being its own neighbor.
+ *
+ * The rows are published in two buffers used in turn, so that a worker never
+ * overwrites rows that a neighbor may still be reading: a worker can only be
+ * one step ahead of its neighbors.
+ *
+ * The grid is scattered to the workers through the shared segment when they
+ * start. Each call then sends its number of steps to every worker through a
+ * socket pair, and the workers reply on it once they have computed all the
+ * steps and written their slabs into another grid of the segment. A worker
+ * that dies closes its socket, so that the caller never waits for it. Since
+ * the workers are processes, one of them failing does not bring down the
+ * caller, whose automaton is left untouched. Only the exchange of the halo
+ * rows would change for workers on distinct machines, e.g. with MPI.
+ */
+#ifndef DOMAIN_H
+#define DOMAIN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include "cellular.h"
+#include "rule.h"
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A cellular automaton decomposed into slabs.
+ */
+struct Domain {
+    unsigned int num_rows;          /**< Its number of rows */
+    unsigned int num_cols;          /**< Its number of columns */
+    enum CellularType type;         /**< Its type */
+    enum CellularBoundary boundary; /**< Its boundary type */
+    char *allowed_cells;            /**< The allowed cells */
+    struct Rule *rule;              /**< Its rule */
+    unsigned int num_workers;       /**< The number of worker processes */
+    size_t size;                    /**< The size of the shared segment */
+    unsigned char *shared;          /**< The shared segment */
+    unsigned char *grids[2];        /**< The current and gathered states */
+    unsigned char *halos;           /**< The rows published by the workers */
+    pid_t *pids;                    /**< The workers, 0 once joined */
+    int *events;                    /**< The two eventfds of each worker */
+    int *channels;                  /**< The caller's socket of each worker */
+    bool has_failed;                /**< Has a worker failed? */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates a decomposition of a copy of a cellular automaton, and forks its
+ * workers.
+ *
+ * @param automaton    The automaton, with a bounded boundary
+ * @param num_workers  The number of worker processes, at most the number of
+ *                     rows
+ * @return             The decomposition, or NULL if the boundary is
+ *                     unbounded or the shared segment or the workers cannot
+ *                     be created
+ */
+struct Domain *Domain_init(const struct CellularAutomaton *automaton,
+                           unsigned int num_workers);
+
+/**
+ * Computes the next steps of a decomposed automaton with worker processes.
+ *
+ * The workers compute all the steps while only exchanging halo rows. If one
+ * of them fails, the others are killed, since its neighbors would wait for
+ * it forever, and every later call fails.
+ *
+ * @param domain     The decomposition
+ * @param num_steps  The number of steps
+ * @return           True if all the workers succeeded, false otherwise, in
+ *                   which case the states are left unchanged
+ */
+bool Domain_step(struct Domain *domain, unsigned int num_steps);
+
+/**
+ * Writes the states of a decomposed automaton into an automaton.
+ *
+ * @param domain     The decomposition
+ * @param automaton  An automaton of the same dimensions
+ */
+void Domain_store(const struct Domain *domain,
+                  struct CellularAutomaton *automaton);
+
+/**
+ * Frees a decomposition, once its workers have exited.
+ *
+ * @param domain  The decomposition to free
+ */
+void Domain_free(struct Domain *domain);
+
+#endif
@@ -0,0 +1,564 @@
+/**
+ * Implements engine.h.
+ */
+#include "engine.h"
+#include <stdlib.h>
+#include "utils.h"
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Returns the fastest engine supporting a type of cellular automaton.
+ *
+ * @param cellular_type  The type of cellular automaton
+ * @param boundary       The boundary of the cellular automaton
+ * @return               The type of the engine
+ */
+enum EngineType Engine_best_type(enum CellularType cellular_type,
+                                 enum CellularBoundary boundary) {
+    if (boundary == CELLULAR_UNBOUNDED) {
+        return ENGINE_SPARSE;
+    } else if (Engine_supports(ENGINE_BITLIFE, cellular_type, boundary)) {
+        return ENGINE_BITLIFE;
+    } else {
+        return ENGINE_GENERIC;
+    }
+}
+
+/**
+ * Computes the next step of the band of rows of a thread.
+ *
+ * @param data         The engine
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Engine_step_band(void *data,
+                      unsigned int index,
+                      unsigned int num_threads) {
+    struct Engine *engine = data;
+    unsigned long num_rows = engine->current->num_rows;
+    unsigned int first_row = num_rows * index / num_threads;
+    unsigned int last_row = num_rows * (index + 1) / num_threads;
+    switch (engine->type) {
+        case ENGINE_BITLIFE:
+            Bitlife_step_rows(engine->bitlife, first_row,
+                              last_row - first_row);
+            break;
+        default:
+            Cellular_step_rows(engine->current, engine->next, first_row,
+                               last_row - first_row);
+            break;
+    }
+}
+
+/**
+ * Computes the next step of an active tile.
+ *
+ * @param data  The engine
+ * @param job   The index of the tile among the active ones
+ */
+void Engine_step_tile(void *data, unsigned int job) {
+    struct Engine *engine = data;
+    unsigned int tile = engine->tiling->active[job];
+    unsigned int first_row, num_rows, first_col, num_cols;
+    Tiling_get_cells(engine->tiling, tile, &first_row, &num_rows,
+                     &first_col, &num_cols);
+    if (Cellular_step_tile(engine->current, engine->next, first_row,
+                           num_rows, first_col, num_cols)) {
+        Tiling_mark_changed(engine->tiling, tile);
+    }
+}
+
+/**
+ * Computes the current pass of a blocked engine over the tiles of a thread.
+ *
+ * The tiles all have the same cost, except on the border, so they are simply
+ * dealt in turn to the threads.
+ *
+ * @param data         The engine
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Engine_step_blocks(void *data,
+                        unsigned int index,
+                        unsigned int num_threads) {
+    struct Engine *engine = data;
+    unsigned int num_tiles = Blocking_num_tiles(engine->current->num_rows,
+                                                engine->current->num_cols);
+    for (unsigned int tile = index; tile < num_tiles; tile += num_threads) {
+        Blocking_step_tile(engine->blocking, index, engine->current,
+                           engine->next, tile, engine->num_block_steps);
+    }
+}
+
+/**
+ * Computes the next step of the band of rows of tiles of a thread, through
+ * its cache.
+ *
+ * The last rows and columns, which do not fill a tile, are computed directly
+ * by the last thread and by each thread respectively.
+ *
+ * @param data         The engine
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Engine_step_memo(void *data,
+                      unsigned int index,
+                      unsigned int num_threads) {
+    struct Engine *engine = data;
+    const struct CellularAutomaton *current = engine->current;
+    const unsigned int size = MEMO_TILE_SIZE;
+    unsigned long num_tile_rows = current->num_rows / size;
+    unsigned int num_tile_cols = current->num_cols / size;
+    unsigned int first_row = num_tile_rows * index / num_threads * size;
+    unsigned int last_row = num_tile_rows * (index + 1) / num_threads * size;
+    if (index == num_threads - 1) last_row = current->num_rows;
+    for (unsigned int i = first_row; i < last_row; i += size) {
+        unsigned int num_rows = min(size, last_row - i);
+        unsigned int num_cols = num_rows == size ? num_tile_cols * size : 0;
+        for (unsigned int j = 0; j < num_cols; j += size) {
+            Memo_step_tile(engine->memo, index, current, engine->next, i, j);
+        }
+        if (num_cols < current->num_cols) {
+            Cellular_step_tile(current, engine->next, i, num_rows, num_cols,
+                               current->num_cols - num_cols);
+        }
+    }
+}
+
+/**
+ * Counts the tiles updated by a step.
+ *
+ * @param engine            The engine
+ * @param num_active_tiles  The number of updated tiles
+ * @param num_tiles         The number of tiles
+ */
+void Engine_count_tiles(struct Engine *engine,
+                        unsigned long num_active_tiles,
+                        unsigned long num_tiles) {
+    engine->last_step.num_active_tiles = num_active_tiles;
+    engine->last_step.num_tiles = num_tiles;
+    engine->all_steps.num_active_tiles += num_active_tiles;
+    engine->all_steps.num_tiles += num_tiles;
+}
+
+/**
+ * The grids of an engine being placed on the NUMA nodes.
+ */
+struct EnginePlacement {
+    struct Engine *engine;              /**< The engine */
+    struct CellularAutomaton *current;  /**< The placed current step */
+    struct CellularAutomaton *next;     /**< The placed next step, if any */
+    struct Bitlife *bitlife;            /**< The placed cells, if any */
+};
+
+/**
+ * Pins a thread to its CPU and copies its band of the grids.
+ *
+ * @param data         The placement
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Engine_place_band(void *data,
+                       unsigned int index,
+                       unsigned int num_threads) {
+    struct EnginePlacement *placement = data;
+    struct Engine *engine = placement->engine;
+    unsigned int cpu = Numa_cpu(engine->topology, index, num_threads);
+    engine->cpus[index] = Numa_pin(cpu) ? (int)cpu : -1;
+    Cellular_copy_band(engine->current, placement->current, index,
+                       num_threads);
+    if (engine->next != NULL) {
+        Cellular_copy_band(engine->next, placement->next, index, num_threads);
+    }
+    if (engine->bitlife != NULL) {
+        Bitlife_copy_band(engine->bitlife, placement->bitlife, index,
+                          num_threads);
+    }
+}
+
+/**
+ * Returns the address of the first cells of a row computed by an engine.
+ *
+ * @param engine  The engine
+ * @param row     The row
+ * @return        The address of its first cells
+ */
+const void *Engine_row_address(const struct Engine *engine, unsigned int row) {
+    if (engine->bitlife != NULL) {
+        return engine->bitlife->current
+             + (size_t)(row + 1) * engine->bitlife->stride;
+    }
+    return Cellular_cell(engine->current, row, 0);
+}
+
+// ------ //
+// Public //
+// ------ //
+
+bool Engine_supports(enum EngineType type,
+                     enum CellularType cellular_type,
+                     enum CellularBoundary boundary) {
+    switch (type) {
+        case ENGINE_AUTO:
+            return Engine_supports(Engine_best_type(cellular_type, boundary),
+                                   cellular_type, boundary);
+        case ENGINE_GENERIC:
+        case ENGINE_TILED:
+        case ENGINE_BLOCKED:
+        case ENGINE_PROCESSES:
+        case ENGINE_MEMOIZED:
+            return boundary != CELLULAR_UNBOUNDED;
+        case ENGINE_BITLIFE:
+            return cellular_type == CELLULAR_GAME_OF_LIFE
+                && boundary != CELLULAR_UNBOUNDED;
+        case ENGINE_HASHLIFE:
+            return cellular_type == CELLULAR_GAME_OF_LIFE
+                && boundary == CELLULAR_WRAP_AROUND;
+        case ENGINE_FRONTIER:
+            return cellular_type == CELLULAR_FIRE
+                && boundary != CELLULAR_UNBOUNDED;
+        case ENGINE_SPARSE:
+            // A growing forest cell is never quiescent
+            return cellular_type != CELLULAR_FIRE
+                && boundary == CELLULAR_UNBOUNDED;
+        default:
+            return false;
+    }
+}
+
+struct Engine *Engine_init(const struct CellularAutomaton *automaton,
+                           enum EngineType type,
+                           unsigned int num_threads) {
+    if (type == ENGINE_AUTO) {
+        type = Engine_best_type(automaton->type, automaton->boundary);
+    }
+    if (!Engine_supports(type, automaton->type, automaton->boundary)
+        || (type == ENGINE_SPARSE && !Plane_supports(automaton->rule))) {
+        return NULL;
+    }
+    struct Domain *domain = NULL;
+    if (type == ENGINE_PROCESSES) {
+        domain = Domain_init(automaton, num_threads);
+        if (domain == NULL) return NULL;
+        // The workers are processes, rather than threads of the pool
+        num_threads = 1;
+    }
+    struct Engine *engine = malloc(sizeof(struct Engine));
+    engine->type = type;
+    engine->current = Cellular_duplicate(automaton);
+    engine->next = NULL;
+    engine->bitlife = NULL;
+    engine->tiling = NULL;
+    engine->hashlife = NULL;
+    engine->plane = NULL;
+    engine->blocking = NULL;
+    engine->domain = domain;
+    engine->memo = NULL;
+    engine->frontier = NULL;
+    engine->num_block_steps = 0;
+    engine->is_synchronized = true;
+    engine->has_failed = false;
+    engine->last_step = (struct EngineStats){0, 0};
+    engine->all_steps = (struct EngineStats){0, 0};
+    engine->pool = Pool_init(min(num_threads, max(automaton->num_rows, 1)));
+    engine->topology = NULL;
+    engine->cpus = NULL;
+    switch (type) {
+        case ENGINE_BITLIFE:
+            engine->bitlife = Bitlife_init(automaton);
+            break;
+        case ENGINE_HASHLIFE:
+            engine->hashlife = Hashlife_init(automaton,
+                                             HASHLIFE_DEFAULT_MAX_NUM_NODES);
+            break;
+        case ENGINE_SPARSE:
+            engine->plane = Plane_init(automaton->rule);
+            Plane_load(engine->plane, automaton);
+            break;
+        case ENGINE_FRONTIER:
+            engine->frontier = Frontier_init(automaton);
+            break;
+        case ENGINE_BLOCKED:
+            engine->next = Cellular_duplicate(automaton);
+            engine->blocking = Blocking_init(BLOCKING_DEFAULT_DEPTH,
+                                             engine->pool->num_threads);
+            break;
+        case ENGINE_PROCESSES:
+            break;
+        case ENGINE_MEMOIZED:
+            engine->next = Cellular_duplicate(automaton);
+            engine->memo = Memo_init(MEMO_DEFAULT_CAPACITY,
+                                     engine->pool->num_threads);
+            break;
+        case ENGINE_TILED:
+            engine->next = Cellular_duplicate(automaton);
+            engine->tiling = Tiling_init(automaton->num_rows,
+                                         automaton->num_cols,
+                                         automaton->boundary);
+            break;
+        default:
+            engine->next = Cellular_duplicate(automaton);
+            break;
+    }
+    return engine;
+}
+
+void Engine_step(struct Engine *engine, unsigned int num_steps) {
+    if (engine->type == ENGINE_HASHLIFE) {
+        // Jumps over all the steps at once
+        if (num_steps == 0) return;
+        Hashlife_step(engine->hashlife, num_steps);
+        engine->is_synchronized = false;
+        Engine_count_tiles(engine, num_steps, num_steps);
+        return;
+    } else if (engine->type == ENGINE_PROCESSES) {
+        // The workers exchange their halo rows without the calling process
+        if (!Domain_step(engine->domain, num_steps)) {
+            engine->has_failed = true;
+            return;
+        }
+        if (num_steps > 0) engine->is_synchronized = false;
+        Engine_count_tiles(engine, num_steps, num_steps);
+        return;
+    } else if (engine->type == ENGINE_BLOCKED) {
+        // Each pass writes the whole grid after up to `depth` steps
+        for (unsigned int step = 0; step < num_steps;) {
+            engine->num_block_steps = min(engine->blocking->depth,
+                                          num_steps - step);
+            Pool_run(engine->pool, Engine_step_blocks, engine);
+            struct CellularAutomaton *previous = engine->current;
+            engine->current = engine->next;
+            engine->next = previous;
+            Engine_count_tiles(engine, engine->num_block_steps,
+                               engine->num_block_steps);
+            step += engine->num_block_steps;
+        }
+        return;
+    }
+    for (unsigned int step = 0; step < num_steps; ++step) {
+        switch (engine->type) {
+            case ENGINE_BITLIFE:
+                Bitlife_step_begin(engine->bitlife);
+                Pool_run(engine->pool, Engine_step_band, engine);
+                Bitlife_step_end(engine->bitlife);
+                engine->is_synchronized = false;
+                Engine_count_tiles(engine, 1, 1);
+                break;
+            case ENGINE_SPARSE:
+                Plane_step(engine->plane);
+                engine->is_synchronized = false;
+                Engine_count_tiles(engine, 1, 1);
+                break;
+            case ENGINE_FRONTIER: {
+                // Each cell is a tile, active if its neighbors are visited
+                struct Frontier *frontier = engine->frontier;
+                unsigned long num_burning = frontier->num_burning;
+                Frontier_step(frontier);
+                engine->is_synchronized = false;
+                Engine_count_tiles(engine, num_burning,
+                                   (unsigned long)frontier->num_rows
+                                   * frontier->num_cols);
+                break;
+            }
+            case ENGINE_MEMOIZED: {
+                struct MemoStats before, after;
+                Memo_get_stats(engine->memo, &before);
+                Cellular_refresh_halo(engine->current);
+                Pool_run(engine->pool, Engine_step_memo, engine);
+                struct CellularAutomaton *previous = engine->current;
+                engine->current = engine->next;
+                engine->next = previous;
+                // The tiles missing from the caches are the updated ones
+                Memo_get_stats(engine->memo, &after);
+                Engine_count_tiles(engine,
+                                   (after.num_lookups - after.num_hits)
+                                   - (before.num_lookups - before.num_hits),
+                                   after.num_lookups - before.num_lookups);
+                break;
+            }
+            case ENGINE_TILED: {
+                // The skipped tiles of `next` did not change last step, so
+                // they already hold the current cells
+                struct Tiling *tiling = engine->tiling;
+                Cellular_refresh_halo(engine->current);
+                Tiling_schedule(tiling);
+                Pool_run_jobs(engine->pool, Engine_step_tile, engine,
+                              tiling->num_active);
+                Tiling_end_step(tiling);
+                struct CellularAutomaton *previous = engine->current;
+                engine->current = engine->next;
+                engine->next = previous;
+                Engine_count_tiles(engine, tiling->num_active,
+                                   Tiling_num_tiles(tiling));
+                break;
+            }
+            default: {
+                Cellular_refresh_halo(engine->current);
+                Pool_run(engine->pool, Engine_step_band, engine);
+                struct CellularAutomaton *previous = engine->current;
+                engine->current = engine->next;
+                engine->next = previous;
+                Engine_count_tiles(engine, 1, 1);
+                break;
+            }
+        }
+    }
+}
+
+void Engine_set_block_depth(struct Engine *engine, unsigned int depth) {
+    if (engine->blocking != NULL) {
+        engine->blocking->depth = min(max(depth, 1), BLOCKING_MAX_DEPTH);
+    }
+}
+
+void Engine_place(struct Engine *engine) {
+    if (engine->type == ENGINE_PROCESSES) return;
+    if (engine->topology == NULL) {
+        engine->topology = Numa_init();
+        engine->cpus = malloc(engine->pool->num_threads * sizeof(int));
+    }
+    struct EnginePlacement placement = {
+        .engine = engine,
+        .current = Cellular_alloc_like(engine->current),
+        .next = engine->next != NULL ? Cellular_alloc_like(engine->next)
+                                     : NULL,
+        .bitlife = engine->bitlife != NULL
+                 ? Bitlife_alloc_like(engine->bitlife) : NULL
+    };
+    Pool_run(engine->pool, Engine_place_band, &placement);
+    Cellular_free(engine->current);
+    engine->current = placement.current;
+    if (engine->next != NULL) {
+        Cellular_free(engine->next);
+        engine->next = placement.next;
+    }
+    if (engine->bitlife != NULL) {
+        Bitlife_free(engine->bitlife);
+        engine->bitlife = placement.bitlife;
+    }
+}
+
+void Engine_print_placement(const struct Engine *engine, FILE *stream) {
+    unsigned int num_threads = engine->pool->num_threads;
+    unsigned long num_rows = engine->current->num_rows;
+    if (engine->topology != NULL) {
+        fprintf(stream, "NUMA nodes: %u (%u CPUs)\n",
+                engine->topology->num_nodes, engine->topology->num_cpus);
+    }
+    long huge_pages_size = Numa_huge_pages_size();
+    if (huge_pages_size < 0) {
+        fprintf(stream, "Huge pages: %s, unknown size\n",
+                Numa_huge_pages() ? "requested" : "not requested");
+    } else {
+        fprintf(stream, "Huge pages: %s, %ld kB\n",
+                Numa_huge_pages() ? "requested" : "not requested",
+                huge_pages_size);
+    }
+    for (unsigned int index = 0; index < num_threads; ++index) {
+        unsigned int first_row = num_rows * index / num_threads;
+        unsigned int last_row = num_rows * (index + 1) / num_threads;
+        fprintf(stream, "Thread %u:   ", index);
+        if (engine->cpus == NULL || engine->cpus[index] < 0) {
+            fprintf(stream, "not pinned");
+        } else {
+            fprintf(stream, "CPU %d (node %d)", engine->cpus[index],
+                    Numa_node_of_cpu(engine->topology, engine->cpus[index]));
+        }
+        if (first_row == last_row || engine->current->num_cols == 0) {
+            fprintf(stream, ", no cells\n");
+            continue;
+        }
+        int node = Numa_node_of_address(Engine_row_address(engine, first_row));
+        fprintf(stream, ", rows %u-%u on ", first_row, last_row - 1);
+        if (node < 0) {
+            fprintf(stream, "an unknown node\n");
+        } else {
+            fprintf(stream, "node %d\n", node);
+        }
+    }
+}
+
+const struct CellularAutomaton *Engine_get(struct Engine *engine) {
+    if (!engine->is_synchronized) {
+        switch (engine->type) {
+            case ENGINE_BITLIFE:
+                Bitlife_store(engine->bitlife, engine->current);
+                break;
+            case ENGINE_HASHLIFE:
+                Hashlife_store(engine->hashlife, engine->current);
+                break;
+            case ENGINE_SPARSE:
+                Plane_store(engine->plane, engine->current);
+                break;
+            case ENGINE_PROCESSES:
+                Domain_store(engine->domain, engine->current);
+                break;
+            case ENGINE_FRONTIER:
+                Frontier_store(engine->frontier, engine->current);
+                break;
+            default:
+                break;
+        }
+        engine->is_synchronized = true;
+    }
+    return engine->current;
+}
+
+void Engine_get_cache_stats(const struct Engine *engine,
+                            struct MemoStats *stats) {
+    if (engine->memo != NULL) {
+        Memo_get_stats(engine->memo, stats);
+    } else {
+        *stats = (struct MemoStats){0, 0, 0, 0};
+    }
+}
+
+const char *Engine_name(const struct Engine *engine) {
+    switch (engine->type) {
+        case ENGINE_GENERIC:
+            return "generic";
+        case ENGINE_BITLIFE:
+            return "bitlife";
+        case ENGINE_TILED:
+            return "tiled";
+        case ENGINE_HASHLIFE:
+            return "hashlife";
+        case ENGINE_SPARSE:
+            return "sparse";
+        case ENGINE_BLOCKED:
+            return "blocked";
+        case ENGINE_PROCESSES:
+            return "processes";
+        case ENGINE_MEMOIZED:
+            return "memoized";
+        case ENGINE_FRONTIER:
+            return "frontier";
+        default:
+            return "auto";
+    }
+}
+
+double Engine_active_fraction(const struct EngineStats *stats) {
+    if (stats->num_tiles == 0) return 1.0;
+    return (double)stats->num_active_tiles / stats->num_tiles;
+}
+
+void Engine_free(struct Engine *engine) {
+    Cellular_free(engine->current);
+    if (engine->next != NULL) Cellular_free(engine->next);
+    if (engine->bitlife != NULL) Bitlife_free(engine->bitlife);
+    if (engine->tiling != NULL) Tiling_free(engine->tiling);
+    if (engine->hashlife != NULL) Hashlife_free(engine->hashlife);
+    if (engine->plane != NULL) Plane_free(engine->plane);
+    if (engine->blocking != NULL) Blocking_free(engine->blocking);
+    if (engine->domain != NULL) Domain_free(engine->domain);
+    if (engine->memo != NULL) Memo_free(engine->memo);
+    if (engine->frontier != NULL) Frontier_free(engine->frontier);
+    if (engine->topology != NULL) Numa_free(engine->topology);
+    free(engine->cpus);
+    Pool_free(engine->pool);
+    free(engine);
+}
@@ -0,0 +1,221 @@
+/**
+ * Provides engines, i.e. different ways of computing the successive steps of
+ * a cellular automaton.
+ *
+ * All engines produce exactly the same states. They only differ by their
+ * internal representation and their performance, and some of them only
+ * support some types of cellular automata.
+ */
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "cellular.h"
+#include "bitlife.h"
+#include "blocking.h"
+#include "domain.h"
+#include "frontier.h"
+#include "hashlife.h"
+#include "memo.h"
+#include "numa.h"
+#include "plane.h"
+#include "pool.h"
+#include "tiling.h"
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * The type of engine.
+ */
+enum EngineType {
+    ENGINE_AUTO,                    /**< The best engine for the automaton */
+    ENGINE_GENERIC,                 /**< Steps the automaton itself */
+    ENGINE_BITLIFE,                 /**< Bit-parallel game of life */
+    ENGINE_TILED,                   /**< Only updates the active tiles */
+    ENGINE_HASHLIFE,                /**< Memoized quadtree game of life */
+    ENGINE_SPARSE,                  /**< Chunks of an unbounded plane */
+    ENGINE_BLOCKED,                 /**< Several steps per tile in cache */
+    ENGINE_PROCESSES,               /**< Slabs of worker processes */
+    ENGINE_MEMOIZED,                /**< Caches the steps of small tiles */
+    ENGINE_FRONTIER                 /**< Follows the burning cells of a fire */
+};
+
+/**
+ * The number of tiles updated by an engine.
+ *
+ * Engines without tiling count their whole grid as a single active tile,
+ * except the frontier engine, which counts each cell as a tile, active if it
+ * is burning, since only the neighbors of the burning cells are visited.
+ */
+struct EngineStats {
+    unsigned long num_active_tiles; /**< The number of updated tiles */
+    unsigned long num_tiles;        /**< The number of tiles */
+};
+
+/**
+ * An engine running a cellular automaton.
+ */
+struct Engine {
+    enum EngineType type;               /**< The type, never ENGINE_AUTO */
+    struct CellularAutomaton *current;  /**< The current step */
+    struct CellularAutomaton *next;     /**< The next step, if generic */
+    struct Bitlife *bitlife;            /**< The cells, if bit-parallel */
+    struct Tiling *tiling;              /**< The active tiles, if tiled */
+    struct Hashlife *hashlife;          /**< The quadtree, if Hashlife */
+    struct Plane *plane;                /**< The chunks, if sparse */
+    struct Blocking *blocking;          /**< The buffers, if blocked */
+    struct Domain *domain;              /**< The slabs, if multi-process */
+    struct Memo *memo;                  /**< The caches, if memoized */
+    struct Frontier *frontier;          /**< The burning cells, if frontier */
+    unsigned int num_block_steps;       /**< The steps of the current pass */
+    bool is_synchronized;               /**< Is `current` up to date? */
+    bool has_failed;                    /**< Did a worker process fail? */
+    struct Pool *pool;                  /**< The threads computing a step */
+    struct NumaTopology *topology;      /**< The CPUs, if placed */
+    int *cpus;                          /**< The CPU of each thread, or -1 */
+    struct EngineStats last_step;       /**< The tiles of the last step */
+    struct EngineStats all_steps;       /**< The tiles of all steps */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Returns true if an engine supports a type of cellular automaton.
+ *
+ * @param type           The type of engine
+ * @param cellular_type  The type of cellular automaton
+ * @param boundary       The boundary of the cellular automaton
+ * @return               True if the automaton can be run by the engine
+ */
+bool Engine_supports(enum EngineType type,
+                     enum CellularType cellular_type,
+                     enum CellularBoundary boundary);
+
+/**
+ * Creates an engine starting from a copy of an automaton.
+ *
+ * If the type is `ENGINE_AUTO`, the fastest engine supporting the automaton
+ * is selected. An automaton with an unbounded boundary can only be run by the
+ * sparse engine, provided that its state 0 is quiescent (see `plane.h`): the
+ * automaton is then the window of the plane returned by `Engine_get`.
+ *
+ * Each step is split into bands of rows, one per thread, which are computed
+ * in parallel. The tiled engine rather splits it into its active tiles,
+ * which are balanced between the threads by work stealing, the blocked
+ * engine splits its passes into tiles shared evenly between the threads, and
+ * the Hashlife, sparse and frontier engines run on the calling thread only. The
+ * multi-process engine rather splits the grid into slabs of rows, one per
+ * worker process (see `domain.h`). The memoized engine splits each step into
+ * bands of rows of tiles, each thread having its own cache (see `memo.h`).
+ * The resulting states do not depend on the number of threads or processes.
+ *
+ * @param automaton    The initial automaton
+ * @param type         The type of engine
+ * @param num_threads  The number of threads computing each step, or of worker
+ *                     processes for the multi-process engine
+ * @return             The engine, or NULL if it does not support the
+ *                     automaton or its shared memory cannot be created
+ */
+struct Engine *Engine_init(const struct CellularAutomaton *automaton,
+                           enum EngineType type,
+                           unsigned int num_threads);
+
+/**
+ * Computes the next steps of the automaton.
+ *
+ * The Hashlife engine jumps over a number of steps growing exponentially,
+ * and the blocked engine computes up to its depth of steps per pass over the
+ * grid, so that they are faster when asked for many steps at once. The
+ * workers of the multi-process engine, forked once by `Engine_init`, only
+ * synchronize with the caller once per call. If one of them fails, the steps
+ * are not computed and `has_failed` is set.
+ *
+ * @param engine     The engine
+ * @param num_steps  The number of steps to compute
+ */
+void Engine_step(struct Engine *engine, unsigned int num_steps);
+
+/**
+ * Sets the number of steps computed by each pass of a blocked engine.
+ *
+ * The depth is clamped between 1 and `BLOCKING_MAX_DEPTH`. Other engines
+ * ignore it.
+ *
+ * @param engine  The engine
+ * @param depth   The number of steps per pass
+ */
+void Engine_set_block_depth(struct Engine *engine, unsigned int depth);
+
+/**
+ * Places the threads and the cells of an engine on the NUMA nodes.
+ *
+ * Each thread of the pool, the calling one included, is pinned to a CPU,
+ * the threads being spread evenly over the nodes (see `numa.h`). The grids
+ * are then copied into new grids whose bands are first touched by the
+ * threads computing them, so that each band lies on the node of its thread.
+ * The multi-process engine is left unplaced, since its workers would inherit
+ * the CPU of the calling thread.
+ *
+ * @param engine  The engine
+ */
+void Engine_place(struct Engine *engine);
+
+/**
+ * Prints the placement of the threads and of their bands of rows.
+ *
+ * @param engine  The engine
+ * @param stream  The stream, e.g. stderr
+ */
+void Engine_print_placement(const struct Engine *engine, FILE *stream);
+
+/**
+ * Returns the current automaton of an engine.
+ *
+ * Note: the returned automaton is owned by the engine and is only valid
+ * until the next step.
+ *
+ * @param engine  The engine
+ * @return        The current automaton
+ */
+const struct CellularAutomaton *Engine_get(struct Engine *engine);
+
+/**
+ * Returns the use of the caches of a memoized engine.
+ *
+ * Other engines have no cache, and return empty statistics.
+ *
+ * @param engine  The engine
+ * @param stats   The use of its caches
+ */
+void Engine_get_cache_stats(const struct Engine *engine,
+                            struct MemoStats *stats);
+
+/**
+ * Returns the name of the type of an engine.
+ *
+ * @param engine  The engine
+ * @return        Its name
+ */
+const char *Engine_name(const struct Engine *engine);
+
+/**
+ * Returns the fraction of active tiles among counted tiles.
+ *
+ * @param stats  The tiles counted by an engine
+ * @return       The fraction of active tiles, 1 if no tile was counted
+ */
+double Engine_active_fraction(const struct EngineStats *stats);
+
+/**
+ * Frees an engine.
+ *
+ * @param engine  The engine to free
+ */
+void Engine_free(struct Engine *engine);
+
+#endif
@@ -0,0 +1,741 @@
+/**
+ * Implements ensemble.h.
+ *
+ * The circuit of a rule is compiled from its lookup table. The last count on
+ * which the rule depends is grouped into sets of values for each state and
+ * each value of the other counts, then the terms differing only by the first
+ * count are merged. The values of the counts that no cell can reach, their
+ * sum exceeding `RULE_NUM_NEIGHBORS`, may be added to any set so that the
+ * sets stay few and simple, e.g. "at least one burning neighbor".
+ */
+#include "ensemble.h"
+#include <stdlib.h>
+#include <string.h>
+#include "bitlife.h"
+#include "numa.h"
+#include "stencil.h"
+#include "utils.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ENSEMBLE_X86
+#endif
+
+#define ENSEMBLE_ALIGNMENT 64
+#define ENSEMBLE_NUM_VALUES (RULE_NUM_NEIGHBORS + 1)
+#define ENSEMBLE_ALL_VALUES ((1u << ENSEMBLE_NUM_VALUES) - 1)
+#define ENSEMBLE_MAX_NUM_SETS \
+    (ENSEMBLE_MAX_NUM_COUNTS << ENSEMBLE_NUM_VALUES)
+#define ENSEMBLE_COUNTER_SIZE 16
+#define ENSEMBLE_COUNTER_MAX ((1ul << ENSEMBLE_COUNTER_SIZE) - 1)
+
+/**
+ * The states of a cell in `ENSEMBLE_VECTOR_SIZE` consecutive words.
+ */
+typedef uint64_t EnsembleVector
+    __attribute__((vector_size(ENSEMBLE_VECTOR_SIZE * sizeof(uint64_t))));
+
+/**
+ * A term whose sets are not yet shared with other terms.
+ */
+struct EnsembleMasks {
+    unsigned char state;            /**< The current state of the cell */
+    unsigned char next_state;       /**< The next state of the cell */
+    /** The values of each count */
+    uint16_t values[ENSEMBLE_MAX_NUM_COUNTS];
+};
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Returns the next state of a cell given the counts of its neighbors.
+ *
+ * @param rule    The rule
+ * @param state   The state of the cell
+ * @param counts  The number of neighbors in each state from 1
+ * @return        The next state
+ */
+static unsigned char Ensemble_apply(const struct Rule *rule,
+                                    unsigned char state,
+                                    const unsigned int *counts) {
+    uint16_t histogram = 0;
+    for (unsigned int k = 0; k + 1 < rule->num_states; ++k) {
+        histogram |= counts[k] << (4 * k);
+    }
+    return Rule_apply(rule, state, histogram);
+}
+
+/**
+ * Decodes the counts of the neighbors from an index.
+ *
+ * @param index       The index, whose digits in base `ENSEMBLE_NUM_VALUES`
+ *                    are the counts
+ * @param num_counts  The number of counts
+ * @param counts      The counts
+ * @return            True if and only if a cell can have these counts
+ */
+static bool Ensemble_decode(unsigned int index,
+                            unsigned int num_counts,
+                            unsigned int *counts) {
+    unsigned int sum = 0;
+    for (unsigned int k = 0; k < num_counts; ++k) {
+        counts[k] = index % ENSEMBLE_NUM_VALUES;
+        index /= ENSEMBLE_NUM_VALUES;
+        sum += counts[k];
+    }
+    return sum <= RULE_NUM_NEIGHBORS;
+}
+
+/**
+ * Returns the counts on which the next state of a cell depends.
+ *
+ * @param rule  The rule
+ * @return      Bit k: the count of the state `k + 1` matters
+ */
+unsigned int Ensemble_relevant_counts(const struct Rule *rule) {
+    const unsigned int num_counts = rule->num_states - 1;
+    unsigned int num_indices = 1;
+    for (unsigned int k = 0; k < num_counts; ++k) {
+        num_indices *= ENSEMBLE_NUM_VALUES;
+    }
+    unsigned int relevant = 0;
+    unsigned int counts[ENSEMBLE_MAX_NUM_COUNTS];
+    for (unsigned int state = 0; state < rule->num_states; ++state) {
+        for (unsigned int index = 0; index < num_indices; ++index) {
+            if (!Ensemble_decode(index, num_counts, counts)) continue;
+            unsigned char next_state = Ensemble_apply(rule, state, counts);
+            for (unsigned int k = 0; k < num_counts; ++k) {
+                unsigned int sum = 0;
+                for (unsigned int l = 0; l < num_counts; ++l) sum += counts[l];
+                if (sum == RULE_NUM_NEIGHBORS) continue;
+                ++counts[k];
+                if (Ensemble_apply(rule, state, counts) != next_state) {
+                    relevant |= 1u << k;
+                }
+                --counts[k];
+            }
+        }
+    }
+    return relevant;
+}
+
+/**
+ * Lists the terms of the circuit of a rule, whose sets are masks of values.
+ *
+ * @param ensemble   The ensemble, whose counted states are set
+ * @param rule       The rule
+ * @param num_terms  The number of terms
+ * @return           The terms
+ */
+struct EnsembleMasks *Ensemble_list_terms(const struct Ensemble *ensemble,
+                                          const struct Rule *rule,
+                                          unsigned int *num_terms) {
+    const unsigned int num_counts = ensemble->num_counts;
+    // The counts other than the last one take a single value per term
+    unsigned int num_prefixes = 1;
+    for (unsigned int k = 0; k + 1 < num_counts; ++k) {
+        num_prefixes *= ENSEMBLE_NUM_VALUES;
+    }
+    struct EnsembleMasks *terms = malloc((size_t)rule->num_states
+                                         * rule->num_states * num_prefixes
+                                         * sizeof(struct EnsembleMasks));
+    *num_terms = 0;
+    unsigned int prefix[ENSEMBLE_MAX_NUM_COUNTS];
+    unsigned int counts[ENSEMBLE_MAX_NUM_COUNTS] = {0};
+    for (unsigned int index = 0; index < num_prefixes; ++index) {
+        if (num_counts > 0 && !Ensemble_decode(index, num_counts - 1, prefix)) {
+            continue;
+        }
+        unsigned int max_value = RULE_NUM_NEIGHBORS;
+        for (unsigned int k = 0; k + 1 < num_counts; ++k) {
+            counts[ensemble->counts[k] - 1] = prefix[k];
+            max_value -= prefix[k];
+        }
+        for (unsigned int state = 0; state < rule->num_states; ++state) {
+            for (unsigned int next_state = 1; next_state < rule->num_states;
+                 ++next_state) {
+                struct EnsembleMasks *term = terms + *num_terms;
+                term->state = state;
+                term->next_state = next_state;
+                for (unsigned int k = 0; k < ENSEMBLE_MAX_NUM_COUNTS; ++k) {
+                    term->values[k] = ENSEMBLE_ALL_VALUES;
+                }
+                if (num_counts == 0) {
+                    if (Ensemble_apply(rule, state, counts) == next_state) {
+                        ++*num_terms;
+                    }
+                    continue;
+                }
+                uint16_t values = 0;
+                for (unsigned int value = 0; value <= max_value; ++value) {
+                    counts[ensemble->counts[num_counts - 1] - 1] = value;
+                    if (Ensemble_apply(rule, state, counts) == next_state) {
+                        values |= 1u << value;
+                    }
+                }
+                if (values == 0) continue;
+                if (values >> max_value & 1) {
+                    // The unreachable values extend the last one
+                    values |= ENSEMBLE_ALL_VALUES & ~((1u << max_value) - 1);
+                }
+                for (unsigned int k = 0; k + 1 < num_counts; ++k) {
+                    term->values[k] = 1u << prefix[k];
+                }
+                term->values[num_counts - 1] = values;
+                ++*num_terms;
+            }
+        }
+    }
+
+    // Merges the terms differing only by the values of the first count
+    unsigned int num_merged = 0;
+    for (unsigned int t = 0; t < *num_terms; ++t) {
+        unsigned int u = 0;
+        for (; u < num_merged; ++u) {
+            if (terms[u].state != terms[t].state ||
+                terms[u].next_state != terms[t].next_state) continue;
+            bool is_same = true;
+            for (unsigned int k = 1; k < num_counts; ++k) {
+                is_same = is_same && terms[u].values[k] == terms[t].values[k];
+            }
+            if (is_same) break;
+        }
+        if (u < num_merged) {
+            terms[u].values[0] |= terms[t].values[0];
+        } else {
+            terms[num_merged++] = terms[t];
+        }
+    }
+    *num_terms = num_merged;
+    return terms;
+}
+
+/**
+ * Compiles the circuit of a rule.
+ *
+ * @param ensemble  The ensemble
+ * @param rule      The rule
+ */
+void Ensemble_compile(struct Ensemble *ensemble, const struct Rule *rule) {
+    ensemble->num_states = rule->num_states;
+    ensemble->birth = ensemble->survival = 0;
+    for (unsigned int n = 0; n <= RULE_NUM_NEIGHBORS; ++n) {
+        ensemble->birth |= (Rule_apply(rule, 0, n) == 1) << n;
+        ensemble->survival |= (Rule_apply(rule, 1, n) == 1) << n;
+    }
+    unsigned int relevant = Ensemble_relevant_counts(rule);
+    ensemble->num_counts = 0;
+    for (unsigned int k = 0; k + 1 < rule->num_states; ++k) {
+        if (relevant >> k & 1) ensemble->counts[ensemble->num_counts++] = k + 1;
+    }
+
+    unsigned int num_terms;
+    struct EnsembleMasks *masks = Ensemble_list_terms(ensemble, rule,
+                                                      &num_terms);
+    ensemble->num_terms = num_terms;
+    ensemble->terms = malloc(max(num_terms, 1) * sizeof(struct EnsembleTerm));
+    ensemble->num_sets = 0;
+    for (unsigned int k = 0; k < ENSEMBLE_MAX_NUM_COUNTS; ++k) {
+        ensemble->tested_values[k] = 0;
+    }
+    ensemble->sets = malloc(ENSEMBLE_MAX_NUM_COUNTS * max(num_terms, 1)
+                            * sizeof(struct EnsembleSet));
+    for (unsigned int t = 0; t < num_terms; ++t) {
+        struct EnsembleTerm *term = ensemble->terms + t;
+        term->state = masks[t].state;
+        term->next_state = masks[t].next_state;
+        for (unsigned int k = 0; k < ENSEMBLE_MAX_NUM_COUNTS; ++k) {
+            term->sets[k] = -1;
+            if (k >= ensemble->num_counts ||
+                masks[t].values[k] == ENSEMBLE_ALL_VALUES) continue;
+            unsigned int s = 0;
+            while (s < ensemble->num_sets &&
+                   (ensemble->sets[s].count != k ||
+                    ensemble->sets[s].values != masks[t].values[k])) {
+                ++s;
+            }
+            if (s == ensemble->num_sets) {
+                struct EnsembleSet *set = ensemble->sets + s;
+                set->count = k;
+                set->values = masks[t].values[k];
+                // The complement is shorter for the large sets
+                set->is_complement = __builtin_popcount(set->values)
+                                   > ENSEMBLE_NUM_VALUES / 2;
+                ensemble->tested_values[k] |= set->is_complement
+                    ? ENSEMBLE_ALL_VALUES & ~set->values : set->values;
+                ++ensemble->num_sets;
+            }
+            term->sets[k] = s;
+        }
+    }
+    free(masks);
+}
+
+/**
+ * Returns a cell of a grid of an ensemble.
+ *
+ * @param ensemble  The ensemble
+ * @param grid      Either its current or next grid
+ * @param row       The row, -1 and `num_rows` being the halo rows
+ * @param col       The column, -1 and `num_cols` being the halo columns
+ * @return          The first word of the first plane of the cell
+ */
+static inline uint64_t *Ensemble_cell(const struct Ensemble *ensemble,
+                                      uint64_t *grid,
+                                      int row,
+                                      int col) {
+    return grid + ((size_t)(row + 1) * ensemble->stride + (col + 1))
+                * ensemble->num_planes * ensemble->num_words;
+}
+
+/**
+ * Adds three vectors bitwise, as `Bitlife_add`.
+ *
+ * The vectors are passed by address, which keeps the ABI of the processors
+ * without AVX.
+ *
+ * @param a      The first vector
+ * @param b      The second vector
+ * @param c      The third vector
+ * @param sum    The resulting bits of weight 1
+ * @param carry  The resulting bits of weight 2
+ */
+static inline __attribute__((always_inline))
+void Ensemble_add(const EnsembleVector *a,
+                  const EnsembleVector *b,
+                  const EnsembleVector *c,
+                  EnsembleVector *sum,
+                  EnsembleVector *carry) {
+    EnsembleVector t = *a ^ *b;
+    EnsembleVector d = *c;
+    *carry = (*a & *b) | (t & d);
+    *sum = t ^ d;
+}
+
+/**
+ * Finds the members in a state, from the planes of a cell.
+ *
+ * @param planes     The planes of the cell, `num_words` words apart
+ * @param num_words  The number of words per plane
+ * @param state      The state, on 2 bits
+ * @param is_state   Bit m: the member m is in the state
+ */
+static inline __attribute__((always_inline))
+void Ensemble_is_state(const uint64_t *planes,
+                       unsigned int num_words,
+                       unsigned char state,
+                       EnsembleVector *is_state) {
+    EnsembleVector low = *(const EnsembleVector *)planes;
+    EnsembleVector high = *(const EnsembleVector *)(planes + num_words);
+    *is_state = (state & 1 ? low : ~low) & (state & 2 ? high : ~high);
+}
+
+/**
+ * Computes the next state of a vector of members of a cell with at least
+ * three states, by evaluating the circuit of the rule.
+ *
+ * @param ensemble   The ensemble
+ * @param cell       The first word of the vector, in the first plane
+ * @param neighbors  The distance to each neighbor
+ * @param next       The first word of the next vector, in the first plane
+ */
+static inline __attribute__((always_inline))
+void Ensemble_next_vector(const struct Ensemble *ensemble,
+                          const uint64_t *cell,
+                          const ptrdiff_t *neighbors,
+                          uint64_t *next) {
+    const unsigned int num_words = ensemble->num_words;
+    EnsembleVector is_value[ENSEMBLE_MAX_NUM_COUNTS][ENSEMBLE_NUM_VALUES];
+    for (unsigned int k = 0; k < ensemble->num_counts; ++k) {
+        EnsembleVector has[RULE_NUM_NEIGHBORS];
+        for (unsigned int n = 0; n < RULE_NUM_NEIGHBORS; ++n) {
+            Ensemble_is_state(cell + neighbors[n], num_words,
+                              ensemble->counts[k], has + n);
+        }
+        // The same full adders as `Bitlife_next_word`
+        EnsembleVector sum0, carry0, sum1, carry1, carry;
+        EnsembleVector side_sum = has[3] ^ has[4];
+        EnsembleVector side_carry = has[3] & has[4];
+        EnsembleVector bits[4];
+        Ensemble_add(has, has + 1, has + 2, &sum0, &carry0);
+        Ensemble_add(has + 5, has + 6, has + 7, &sum1, &carry1);
+        Ensemble_add(&sum0, &sum1, &side_sum, bits, &carry);
+        Ensemble_add(&carry0, &carry1, &side_carry, bits + 1, bits + 2);
+        bits[3] = bits[2] & bits[1] & carry;
+        bits[2] ^= bits[1] & carry;
+        bits[1] ^= carry;
+        for (uint16_t values = ensemble->tested_values[k]; values != 0;
+             values &= values - 1) {
+            unsigned int value = __builtin_ctz(values);
+            EnsembleVector is = ~(EnsembleVector){0};
+            for (unsigned int b = 0; b < 4; ++b) {
+                is &= value >> b & 1 ? bits[b] : ~bits[b];
+            }
+            is_value[k][value] = is;
+        }
+    }
+    EnsembleVector in_set[ENSEMBLE_MAX_NUM_SETS];
+    for (unsigned int s = 0; s < ensemble->num_sets; ++s) {
+        const struct EnsembleSet *set = ensemble->sets + s;
+        uint16_t values = set->is_complement
+                        ? ENSEMBLE_ALL_VALUES & ~set->values : set->values;
+        EnsembleVector in = {0};
+        for (; values != 0; values &= values - 1) {
+            in |= is_value[set->count][__builtin_ctz(values)];
+        }
+        in_set[s] = set->is_complement ? ~in : in;
+    }
+    EnsembleVector is_current[RULE_MAX_NUM_STATES];
+    for (unsigned int state = 0; state < ensemble->num_states; ++state) {
+        Ensemble_is_state(cell, num_words, state, is_current + state);
+    }
+    EnsembleVector low = {0}, high = {0};
+    for (unsigned int t = 0; t < ensemble->num_terms; ++t) {
+        const struct EnsembleTerm *term = ensemble->terms + t;
+        EnsembleVector matches = is_current[term->state];
+        for (unsigned int k = 0; k < ensemble->num_counts; ++k) {
+            if (term->sets[k] >= 0) matches &= in_set[term->sets[k]];
+        }
+        if (term->next_state & 1) low |= matches;
+        if (term->next_state & 2) high |= matches;
+    }
+    *(EnsembleVector *)next = low;
+    *(EnsembleVector *)(next + num_words) = high;
+}
+
+/**
+ * Computes the next cells of a row of an ensemble.
+ *
+ * @param ensemble  The ensemble
+ * @param row       The row
+ */
+static inline __attribute__((always_inline))
+void Ensemble_step_row(const struct Ensemble *ensemble, unsigned int row) {
+    const unsigned int num_words = ensemble->num_words;
+    const ptrdiff_t size = (ptrdiff_t)ensemble->num_planes * num_words;
+    const ptrdiff_t stride = ensemble->stride * size;
+    // The neighbors in the order of `Bitlife_next_word`: the row above, the
+    // west and east neighbors, then the row below
+    const ptrdiff_t neighbors[RULE_NUM_NEIGHBORS] = {
+        -stride - size, -stride, -stride + size, -size, size,
+        stride - size, stride, stride + size
+    };
+    const uint64_t *cell = Ensemble_cell(ensemble, ensemble->current, row, 0);
+    uint64_t *next = Ensemble_cell(ensemble, ensemble->next, row, 0);
+    // The words beyond the last member are not updated by Life-like rules
+    const unsigned int num_used_words =
+        (ensemble->num_members + ENSEMBLE_WORD_SIZE - 1) / ENSEMBLE_WORD_SIZE;
+    for (unsigned int j = 0; j < ensemble->num_cols; ++j) {
+        if (ensemble->num_states == 2) {
+            for (unsigned int w = 0; w < num_used_words; ++w) {
+                const uint64_t *c = cell + w;
+                const uint64_t west[3] = {c[neighbors[0]], c[neighbors[3]],
+                                          c[neighbors[5]]};
+                const uint64_t center[3] = {c[neighbors[1]], c[0],
+                                            c[neighbors[6]]};
+                const uint64_t east[3] = {c[neighbors[2]], c[neighbors[4]],
+                                          c[neighbors[7]]};
+                next[w] = Bitlife_next_word(west, center, east,
+                                            ensemble->birth,
+                                            ensemble->survival);
+            }
+        } else {
+            for (unsigned int w = 0; w < num_words;
+                 w += ENSEMBLE_VECTOR_SIZE) {
+                Ensemble_next_vector(ensemble, cell + w, neighbors, next + w);
+            }
+        }
+        cell += size;
+        next += size;
+    }
+}
+
+/**
+ * Computes the next cells of a band of rows of an ensemble, with the
+ * instructions available to any processor.
+ *
+ * @param ensemble   The ensemble
+ * @param first_row  The first row of the band
+ * @param num_rows   The number of rows of the band
+ */
+void Ensemble_step_rows_default(const struct Ensemble *ensemble,
+                                unsigned int first_row,
+                                unsigned int num_rows) {
+    for (unsigned int i = first_row; i < first_row + num_rows; ++i) {
+        Ensemble_step_row(ensemble, i);
+    }
+}
+
+#ifdef ENSEMBLE_X86
+/**
+ * Computes the next cells of a band of rows of an ensemble, with AVX2
+ * instructions, a vector of members fitting in a register.
+ *
+ * @param ensemble   The ensemble
+ * @param first_row  The first row of the band
+ * @param num_rows   The number of rows of the band
+ */
+__attribute__((target("avx2")))
+void Ensemble_step_rows_avx2(const struct Ensemble *ensemble,
+                             unsigned int first_row,
+                             unsigned int num_rows) {
+    for (unsigned int i = first_row; i < first_row + num_rows; ++i) {
+        Ensemble_step_row(ensemble, i);
+    }
+}
+#endif
+
+/**
+ * Adds a word of bits to the vertical counters of its 64 members.
+ *
+ * The bit `m` of the counter `b` is the bit `b` of the counter of the member
+ * `m`, so that the word is added by rippling its carries through the
+ * counters, which costs two operations on average.
+ *
+ * @param counters  The counters
+ * @param bits      Bit m: the member m is counted
+ */
+static inline void Ensemble_add_counter(uint64_t *counters, uint64_t bits) {
+    for (unsigned int b = 0; bits != 0; ++b) {
+        uint64_t carry = counters[b] & bits;
+        counters[b] ^= bits;
+        bits = carry;
+    }
+}
+
+/**
+ * Adds vertical counters to the populations of their members, and resets
+ * them.
+ *
+ * @param counters     The counters
+ * @param word         The index of the word of the members
+ * @param num_members  The number of members
+ * @param populations  The population of each member
+ */
+void Ensemble_flush_counters(uint64_t *counters,
+                             unsigned int word,
+                             unsigned int num_members,
+                             unsigned long *populations) {
+    const unsigned int first_member = word * ENSEMBLE_WORD_SIZE;
+    const unsigned int num_counted = min(num_members - first_member,
+                                         ENSEMBLE_WORD_SIZE);
+    for (unsigned int m = 0; m < num_counted; ++m) {
+        unsigned long count = 0;
+        for (unsigned int b = 0; b < ENSEMBLE_COUNTER_SIZE; ++b) {
+            count |= (unsigned long)(counters[b] >> m & 1) << b;
+        }
+        populations[first_member + m] += count;
+    }
+    memset(counters, 0, ENSEMBLE_COUNTER_SIZE * sizeof(uint64_t));
+}
+
+/**
+ * Copies the opposite cells of a grid into its halo, on a torus.
+ *
+ * @param ensemble  The ensemble
+ * @param grid      The grid
+ */
+void Ensemble_wrap_halo(const struct Ensemble *ensemble, uint64_t *grid) {
+    const int num_rows = ensemble->num_rows, num_cols = ensemble->num_cols;
+    const size_t size = (size_t)ensemble->num_planes * ensemble->num_words
+                      * sizeof(uint64_t);
+    for (int i = 0; i < num_rows; ++i) {
+        memcpy(Ensemble_cell(ensemble, grid, i, -1),
+               Ensemble_cell(ensemble, grid, i, num_cols - 1), size);
+        memcpy(Ensemble_cell(ensemble, grid, i, num_cols),
+               Ensemble_cell(ensemble, grid, i, 0), size);
+    }
+    // The whole rows, so that the corners are wrapped as well
+    memcpy(Ensemble_cell(ensemble, grid, -1, -1),
+           Ensemble_cell(ensemble, grid, num_rows - 1, -1),
+           ensemble->stride * size);
+    memcpy(Ensemble_cell(ensemble, grid, num_rows, -1),
+           Ensemble_cell(ensemble, grid, 0, -1),
+           ensemble->stride * size);
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Ensemble *Ensemble_init(
+    const struct CellularAutomaton *const *members,
+    unsigned int num_members
+) {
+    const struct CellularAutomaton *first = members[0];
+    const struct Rule *rule = first->rule;
+    size_t table_size = (size_t)RULE_MAX_NUM_STATES << rule->shift;
+    for (unsigned int m = 0; m < num_members; ++m) {
+        if (members[m]->num_rows != first->num_rows ||
+            members[m]->num_cols != first->num_cols ||
+            members[m]->boundary != first->boundary ||
+            members[m]->rule->num_states != rule->num_states ||
+            memcmp(members[m]->rule->table, rule->table, table_size) != 0) {
+            return NULL;
+        }
+    }
+    struct Ensemble *ensemble = Ensemble_alloc(first, num_members);
+    if (ensemble == NULL) return NULL;
+    for (unsigned int m = 0; m < num_members; ++m) {
+        Ensemble_load(ensemble, m, members[m]);
+    }
+    return ensemble;
+}
+
+struct Ensemble *Ensemble_alloc(const struct CellularAutomaton *model,
+                                unsigned int num_members) {
+    if (model->boundary == CELLULAR_UNBOUNDED) return NULL;
+    const struct Rule *rule = model->rule;
+    struct Ensemble *ensemble = malloc(sizeof(struct Ensemble));
+    ensemble->num_members = num_members;
+    ensemble->num_words = (num_members + ENSEMBLE_VECTOR_SIZE
+                                         * ENSEMBLE_WORD_SIZE - 1)
+                        / (ENSEMBLE_VECTOR_SIZE * ENSEMBLE_WORD_SIZE)
+                        * ENSEMBLE_VECTOR_SIZE;
+    ensemble->num_planes = rule->num_states > 2 ? 2 : 1;
+    ensemble->num_rows = model->num_rows;
+    ensemble->num_cols = model->num_cols;
+    ensemble->stride = model->num_cols + 2;
+    ensemble->boundary = model->boundary;
+    Ensemble_compile(ensemble, rule);
+    size_t size = (size_t)(ensemble->num_rows + 2) * ensemble->stride
+                * ensemble->num_planes * ensemble->num_words
+                * sizeof(uint64_t);
+    ensemble->current = Numa_alloc(ENSEMBLE_ALIGNMENT, size);
+    ensemble->next = Numa_alloc(ENSEMBLE_ALIGNMENT, size);
+    memset(ensemble->current, 0, size);
+    memset(ensemble->next, 0, size);
+    return ensemble;
+}
+
+void Ensemble_load(struct Ensemble *ensemble,
+                   unsigned int member,
+                   const struct CellularAutomaton *automaton) {
+    const uint64_t bit = (uint64_t)1 << (member % ENSEMBLE_WORD_SIZE);
+    const unsigned int word = member / ENSEMBLE_WORD_SIZE;
+    unsigned char *states = malloc(max(ensemble->num_cols, 1));
+    for (unsigned int i = 0; i < ensemble->num_rows; ++i) {
+        Cellular_get_states(automaton, i, 0, ensemble->num_cols, states);
+        uint64_t *cell = Ensemble_cell(ensemble, ensemble->current, i, 0);
+        for (unsigned int j = 0; j < ensemble->num_cols; ++j) {
+            for (unsigned int b = 0; b < ensemble->num_planes; ++b) {
+                uint64_t *plane = cell + b * ensemble->num_words + word;
+                *plane = states[j] >> b & 1 ? *plane | bit : *plane & ~bit;
+            }
+            cell += ensemble->num_planes * ensemble->num_words;
+        }
+    }
+    free(states);
+}
+
+void Ensemble_step(struct Ensemble *ensemble) {
+    Ensemble_step_begin(ensemble);
+    Ensemble_step_rows(ensemble, 0, ensemble->num_rows);
+    Ensemble_step_end(ensemble);
+}
+
+void Ensemble_step_begin(struct Ensemble *ensemble) {
+    // With the boundary truncate, the halo stays in state 0
+    if (ensemble->boundary == CELLULAR_WRAP_AROUND) {
+        Ensemble_wrap_halo(ensemble, ensemble->current);
+    }
+}
+
+void Ensemble_step_rows(const struct Ensemble *ensemble,
+                        unsigned int first_row,
+                        unsigned int num_rows) {
+#ifdef ENSEMBLE_X86
+    if (Stencil_current() == STENCIL_AVX2) {
+        Ensemble_step_rows_avx2(ensemble, first_row, num_rows);
+        return;
+    }
+#endif
+    Ensemble_step_rows_default(ensemble, first_row, num_rows);
+}
+
+void Ensemble_step_end(struct Ensemble *ensemble) {
+    uint64_t *current = ensemble->current;
+    ensemble->current = ensemble->next;
+    ensemble->next = current;
+}
+
+void Ensemble_store(const struct Ensemble *ensemble,
+                    unsigned int member,
+                    struct CellularAutomaton *automaton) {
+    const unsigned int shift = member % ENSEMBLE_WORD_SIZE;
+    const unsigned int word = member / ENSEMBLE_WORD_SIZE;
+    unsigned char *states = malloc(max(ensemble->num_cols, 1));
+    for (unsigned int i = 0; i < ensemble->num_rows; ++i) {
+        const uint64_t *cell = Ensemble_cell(ensemble, ensemble->current,
+                                             i, 0);
+        for (unsigned int j = 0; j < ensemble->num_cols; ++j) {
+            states[j] = 0;
+            for (unsigned int b = 0; b < ensemble->num_planes; ++b) {
+                states[j] |= (cell[b * ensemble->num_words + word] >> shift
+                              & 1) << b;
+            }
+            cell += ensemble->num_planes * ensemble->num_words;
+        }
+        Cellular_set_states(automaton, i, 0, ensemble->num_cols, states);
+    }
+    free(states);
+}
+
+void Ensemble_count_rows(const struct Ensemble *ensemble,
+                         unsigned int first_row,
+                         unsigned int num_rows,
+                         unsigned long *populations) {
+    const unsigned int num_members = ensemble->num_members;
+    const unsigned int num_words = ensemble->num_words;
+    const size_t size = (size_t)ensemble->num_planes * num_words;
+    const unsigned int num_used_words =
+        (num_members + ENSEMBLE_WORD_SIZE - 1) / ENSEMBLE_WORD_SIZE;
+    memset(populations, 0,
+           ensemble->num_states * num_members * sizeof(unsigned long));
+    uint64_t counters[ENSEMBLE_COUNTER_SIZE];
+    for (unsigned int state = 1; state < ensemble->num_states; ++state) {
+        unsigned long *state_populations = populations + state * num_members;
+        for (unsigned int w = 0; w < num_used_words; ++w) {
+            memset(counters, 0, sizeof(counters));
+            unsigned long num_added = 0;
+            for (unsigned int i = first_row; i < first_row + num_rows; ++i) {
+                const uint64_t *cell = Ensemble_cell(ensemble,
+                                                     ensemble->current, i, 0);
+                for (unsigned int j = 0; j < ensemble->num_cols; ++j) {
+                    uint64_t low = cell[w];
+                    uint64_t high = ensemble->num_planes > 1
+                                  ? cell[num_words + w] : 0;
+                    Ensemble_add_counter(counters,
+                                         (state & 1 ? low : ~low)
+                                         & (state & 2 ? high : ~high));
+                    if (++num_added == ENSEMBLE_COUNTER_MAX) {
+                        Ensemble_flush_counters(counters, w, num_members,
+                                                state_populations);
+                        num_added = 0;
+                    }
+                    cell += size;
+                }
+            }
+            Ensemble_flush_counters(counters, w, num_members,
+                                    state_populations);
+        }
+    }
+    // The state 0 holds the remaining cells
+    const unsigned long num_cells = (unsigned long)num_rows
+                                  * ensemble->num_cols;
+    for (unsigned int m = 0; m < num_members; ++m) {
+        populations[m] = num_cells;
+        for (unsigned int state = 1; state < ensemble->num_states; ++state) {
+            populations[m] -= populations[state * num_members + m];
+        }
+    }
+}
+
+void Ensemble_free(struct Ensemble *ensemble) {
+    free(ensemble->sets);
+    free(ensemble->terms);
+    free(ensemble->current);
+    free(ensemble->next);
+    free(ensemble);
+}
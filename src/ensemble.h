@@ -0,0 +1,205 @@
+/**
+ * Provides an ensemble of automata stepped together, bit-sliced.
+ *
+ * The members of an ensemble are independent automata with the same size,
+ * boundary and rule, e.g. the same simulation from different random grids.
+ * The bit `m % 64` of a word holds a bit of the state of the member `m`, so
+ * that the same cell of 64 members is stored in one word per bit of the
+ * states, and updated at once by bitwise operations. The words are grouped
+ * by `ENSEMBLE_VECTOR_SIZE`, so that 256 members are updated by each AVX2
+ * instruction when available (see `stencil.h`).
+ *
+ * The rule is compiled into a boolean circuit: the number of neighbors of
+ * each counted state is computed with full adders, as in `bitlife.h`, and
+ * the next state is a disjunction of terms, each one requiring a current
+ * state and a set of values of the counts. The counts that the rule ignores,
+ * e.g. all but the burning neighbors of a fire, are not computed. Life-like
+ * rules directly use `Bitlife_next_word`.
+ *
+ * The produced states are exactly the same as the ones of each member
+ * stepped alone.
+ */
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "cellular.h"
+
+#define ENSEMBLE_WORD_SIZE 64
+#define ENSEMBLE_VECTOR_SIZE 4
+#define ENSEMBLE_MAX_NUM_COUNTS (RULE_MAX_NUM_STATES - 1)
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A set of values of the number of neighbors in a state.
+ */
+struct EnsembleSet {
+    unsigned int count;             /**< The index of the count */
+    uint16_t values;                /**< Bit k: the count k is in the set */
+    bool is_complement;             /**< Is it tested by its complement? */
+};
+
+/**
+ * A term of the circuit of a rule: a cell whose state and counts match the
+ * term takes its next state.
+ */
+struct EnsembleTerm {
+    unsigned char state;            /**< The current state of the cell */
+    unsigned char next_state;       /**< The next state of the cell */
+    /** The set of each count, or -1 if any value matches */
+    int sets[ENSEMBLE_MAX_NUM_COUNTS];
+};
+
+/**
+ * An ensemble of automata stepped together.
+ *
+ * Each grid has a halo of one cell around it. The cells are stored row by
+ * row, `stride` cells apart, and each cell holds `num_planes` planes of
+ * `num_words` words, a multiple of `ENSEMBLE_VECTOR_SIZE`, the plane `b`
+ * holding the bit `b` of the states.
+ */
+struct Ensemble {
+    unsigned int num_members;       /**< The number of members */
+    unsigned int num_words;         /**< The number of words per plane */
+    unsigned int num_planes;        /**< The number of bits per state */
+    unsigned int num_rows;          /**< The number of rows */
+    unsigned int num_cols;          /**< The number of columns */
+    unsigned int stride;            /**< The distance between two rows */
+    enum CellularBoundary boundary; /**< The boundary type */
+    unsigned int num_states;        /**< The number of states */
+    unsigned int birth;             /**< If 2 states, bit k: born with k */
+    unsigned int survival;          /**< If 2 states, bit k: survives with k */
+    unsigned int num_counts;        /**< The number of counted states */
+    unsigned char counts[ENSEMBLE_MAX_NUM_COUNTS]; /**< The counted states */
+    /** Bit k: a set tests the value k of the count */
+    uint16_t tested_values[ENSEMBLE_MAX_NUM_COUNTS];
+    unsigned int num_sets;          /**< The number of sets of counts */
+    struct EnsembleSet *sets;       /**< The sets of counts */
+    unsigned int num_terms;         /**< The number of terms */
+    struct EnsembleTerm *terms;     /**< The terms of the circuit */
+    uint64_t *current;              /**< The current cells, halo included */
+    uint64_t *next;                 /**< The next cells, halo included */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates an ensemble from automata.
+ *
+ * @param members      The automata, with the same size, boundary and rule,
+ *                     and a bounded boundary
+ * @param num_members  The number of automata, at least 1
+ * @return             The ensemble, or NULL if the automata differ
+ */
+struct Ensemble *Ensemble_init(
+    const struct CellularAutomaton *const *members,
+    unsigned int num_members
+);
+
+/**
+ * Creates an ensemble whose members are all in the state 0.
+ *
+ * The members are then set one at a time by `Ensemble_load`, so that they
+ * need not all exist as automata at once.
+ *
+ * @param model        An automaton with the size, boundary and rule of the
+ *                     members, and a bounded boundary
+ * @param num_members  The number of members, at least 1
+ * @return             The ensemble, or NULL if the boundary is unbounded
+ */
+struct Ensemble *Ensemble_alloc(const struct CellularAutomaton *model,
+                                unsigned int num_members);
+
+/**
+ * Copies the cells of an automaton into a member of an ensemble.
+ *
+ * The members sharing a word, i.e. with the same index divided by
+ * `ENSEMBLE_WORD_SIZE`, cannot be loaded in parallel.
+ *
+ * @param ensemble   The ensemble
+ * @param member     The index of the member
+ * @param automaton  The automaton, with the size of the ensemble
+ */
+void Ensemble_load(struct Ensemble *ensemble,
+                   unsigned int member,
+                   const struct CellularAutomaton *automaton);
+
+/**
+ * Computes the next step of every member of an ensemble.
+ *
+ * @param ensemble  The ensemble to update
+ */
+void Ensemble_step(struct Ensemble *ensemble);
+
+/**
+ * Prepares a step of an ensemble computed by bands of rows.
+ *
+ * As for `Bitlife_step_begin`, a step can be computed by calling
+ * `Ensemble_step_begin`, then `Ensemble_step_rows` on bands covering all the
+ * rows, possibly in parallel, and finally `Ensemble_step_end`.
+ *
+ * @param ensemble  The ensemble to update
+ */
+void Ensemble_step_begin(struct Ensemble *ensemble);
+
+/**
+ * Computes the next step of a band of rows of an ensemble.
+ *
+ * @param ensemble   The ensemble to update
+ * @param first_row  The first row of the band
+ * @param num_rows   The number of rows of the band
+ */
+void Ensemble_step_rows(const struct Ensemble *ensemble,
+                        unsigned int first_row,
+                        unsigned int num_rows);
+
+/**
+ * Completes a step of an ensemble computed by bands of rows.
+ *
+ * @param ensemble  The ensemble to update
+ */
+void Ensemble_step_end(struct Ensemble *ensemble);
+
+/**
+ * Copies the cells of a member of an ensemble into an automaton.
+ *
+ * @param ensemble   The ensemble
+ * @param member     The index of the member
+ * @param automaton  The automaton receiving the cells, of the same size
+ */
+void Ensemble_store(const struct Ensemble *ensemble,
+                    unsigned int member,
+                    struct CellularAutomaton *automaton);
+
+/**
+ * Counts the cells of each member in each state, in a band of rows.
+ *
+ * The cells are counted bit-sliced as well, with a counter of 16 bits per
+ * member held in 16 words, so that a cell of 64 members is counted in a few
+ * operations.
+ *
+ * @param ensemble     The ensemble
+ * @param first_row    The first row of the band
+ * @param num_rows     The number of rows of the band
+ * @param populations  The number of cells of the member `m` in the state
+ *                     `s` of the band, at the index `s * num_members + m`
+ */
+void Ensemble_count_rows(const struct Ensemble *ensemble,
+                         unsigned int first_row,
+                         unsigned int num_rows,
+                         unsigned long *populations);
+
+/**
+ * Frees an ensemble.
+ *
+ * @param ensemble  The ensemble to free
+ */
+void Ensemble_free(struct Ensemble *ensemble);
+
+#endif
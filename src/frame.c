@@ -0,0 +1,112 @@
+/**
+ * Implements frame.h.
+ */
+#include "frame.h"
+#include <stdarg.h>
+#include <stdlib.h>
+
+/**
+ * The initial capacity of the text of a frame.
+ */
+#define FRAME_INITIAL_CAPACITY 4096
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Ensures that a frame can receive more characters.
+ *
+ * The capacity is doubled as needed, so that the buffer quickly reaches the
+ * size of a frame and is then reused as is.
+ *
+ * @param frame     The frame
+ * @param num_more  The number of characters to append
+ */
+void Frame_reserve(struct Frame *frame, size_t num_more) {
+    if (frame->size + num_more <= frame->capacity) return;
+    while (frame->size + num_more > frame->capacity) {
+        frame->capacity *= 2;
+    }
+    frame->text = realloc(frame->text, frame->capacity);
+}
+
+/**
+ * Formats a band of rows of the grid being added to a frame, as a task of
+ * its pool.
+ *
+ * @param data         The frame
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Frame_format_band(void *data,
+                       unsigned int index,
+                       unsigned int num_threads) {
+    const struct Frame *frame = data;
+    const struct CellularAutomaton *automaton = frame->automaton;
+    unsigned long num_rows = automaton->num_rows;
+    unsigned int first_row = num_rows * index / num_threads;
+    unsigned int last_row = num_rows * (index + 1) / num_threads;
+    Cellular_format_rows(automaton, first_row, last_row - first_row,
+                         frame->text + frame->size
+                         + (size_t)first_row * (automaton->num_cols + 1));
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Frame *Frame_init(unsigned int num_threads) {
+    struct Frame *frame = malloc(sizeof(struct Frame));
+    frame->size = 0;
+    frame->capacity = FRAME_INITIAL_CAPACITY;
+    frame->text = malloc(frame->capacity);
+    frame->pool = num_threads > 1 ? Pool_init(num_threads) : NULL;
+    frame->automaton = NULL;
+    return frame;
+}
+
+void Frame_printf(struct Frame *frame, const char *format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(frame->text + frame->size,
+                           frame->capacity - frame->size, format, arguments);
+    va_end(arguments);
+    if (length < 0) return;
+    if (frame->size + length >= frame->capacity) {
+        // Formatted again, once the terminating null character fits
+        Frame_reserve(frame, length + 1);
+        va_start(arguments, format);
+        vsnprintf(frame->text + frame->size, length + 1, format, arguments);
+        va_end(arguments);
+    }
+    frame->size += length;
+}
+
+void Frame_add_grid(struct Frame *frame,
+                    const struct CellularAutomaton *automaton) {
+    size_t size = Cellular_text_size(automaton);
+    Frame_reserve(frame, size);
+    if (frame->pool != NULL && (size_t)automaton->num_rows
+                               * automaton->num_cols
+                               >= FRAME_MIN_PARALLEL_CELLS) {
+        frame->automaton = automaton;
+        Pool_run(frame->pool, Frame_format_band, frame);
+        frame->automaton = NULL;
+    } else {
+        Cellular_format_rows(automaton, 0, automaton->num_rows,
+                             frame->text + frame->size);
+    }
+    frame->size += size;
+}
+
+void Frame_write(struct Frame *frame, FILE *stream) {
+    fwrite(frame->text, sizeof(char), frame->size, stream);
+    frame->size = 0;
+}
+
+void Frame_free(struct Frame *frame) {
+    if (frame->pool != NULL) Pool_free(frame->pool);
+    free(frame->text);
+    free(frame);
+}
@@ -0,0 +1,84 @@
+/**
+ * Provides a writer of the frames of a simulation.
+ *
+ * A frame, e.g. the header of a step followed by the rows of its grid, is
+ * formatted into a buffer reused from one frame to the next, then written by
+ * a single call to `fwrite`, rather than by a call per row or per cell. The
+ * rows of a large grid are formatted by `Cellular_format_rows` in bands
+ * spread over a pool of threads.
+ */
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdio.h>
+#include "cellular.h"
+#include "pool.h"
+
+/**
+ * The minimum number of cells of a grid formatted by several threads.
+ */
+#define FRAME_MIN_PARALLEL_CELLS (1u << 20)
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A frame being formatted.
+ */
+struct Frame {
+    char *text;                     /**< The text of the frame */
+    size_t size;                    /**< The number of characters */
+    size_t capacity;                /**< The capacity of the text */
+    struct Pool *pool;              /**< The threads, or NULL if only one */
+    /** The grid being formatted */
+    const struct CellularAutomaton *automaton;
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates an empty frame.
+ *
+ * @param num_threads  The number of threads formatting the grids
+ * @return             The frame
+ */
+struct Frame *Frame_init(unsigned int num_threads);
+
+/**
+ * Appends formatted text to a frame, as `printf`.
+ *
+ * @param frame   The frame
+ * @param format  The format
+ * @param ...     The formatted values
+ */
+void Frame_printf(struct Frame *frame, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * Appends the rows of an automaton to a frame, as `Cellular_print`.
+ *
+ * @param frame      The frame
+ * @param automaton  The automaton
+ */
+void Frame_add_grid(struct Frame *frame,
+                    const struct CellularAutomaton *automaton);
+
+/**
+ * Writes a frame to a stream, and empties it.
+ *
+ * @param frame   The frame
+ * @param stream  The stream
+ */
+void Frame_write(struct Frame *frame, FILE *stream);
+
+/**
+ * Frees a frame.
+ *
+ * @param frame  The frame to free
+ */
+void Frame_free(struct Frame *frame);
+
+#endif
@@ -0,0 +1,202 @@
+/**
+ * Implements frontier.h.
+ */
+#include "frontier.h"
+#include <stdlib.h>
+#include <string.h>
+#include "stencil.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FRONTIER_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * The temporary state of an ignitable cell with a burning neighbor.
+ */
+#define FRONTIER_IGNITING 4
+
+/**
+ * The initial capacity of the lists of cells.
+ */
+#define FRONTIER_MIN_CAPACITY 64
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Returns the next state of a cell, whatever its neighbors.
+ *
+ * The states 0 to 3 are growing, ignitable, burning and burnt: growing,
+ * burning and burnt cells simply change to the next state modulo 4, while
+ * ignitable cells stay ignitable, unless they are igniting.
+ *
+ * @param state  The state, or `FRONTIER_IGNITING`
+ * @return       The next state
+ */
+static inline unsigned char Frontier_next_state(unsigned char state) {
+    bool is_toggled = state == CELLULAR_FIRE_IGNITABLE
+                   || state == FRONTIER_IGNITING;
+    return ((state + 1) & 3) ^ (is_toggled ? 3 : 0);
+}
+
+/**
+ * Applies the pointwise transitions to cells, one at a time.
+ *
+ * @param cells      The cells
+ * @param num_cells  The number of cells
+ */
+void Frontier_map_scalar(unsigned char *cells, size_t num_cells) {
+    for (size_t k = 0; k < num_cells; ++k) {
+        cells[k] = Frontier_next_state(cells[k]);
+    }
+}
+
+#ifdef FRONTIER_X86
+/**
+ * Applies the pointwise transitions to cells, 16 at a time, with SSE2
+ * instructions.
+ *
+ * See `Frontier_next_state` for the computed transitions.
+ *
+ * @param cells      The cells
+ * @param num_cells  The number of cells
+ */
+__attribute__((target("sse2")))
+void Frontier_map_sse2(unsigned char *cells, size_t num_cells) {
+    const __m128i one = _mm_set1_epi8(CELLULAR_FIRE_IGNITABLE);
+    const __m128i three = _mm_set1_epi8(3);
+    const __m128i igniting = _mm_set1_epi8(FRONTIER_IGNITING);
+    size_t k = 0;
+    for (; k + 16 <= num_cells; k += 16) {
+        __m128i state = _mm_loadu_si128((const __m128i *)(cells + k));
+        __m128i next = _mm_and_si128(_mm_add_epi8(state, one), three);
+        __m128i is_toggled = _mm_or_si128(_mm_cmpeq_epi8(state, one),
+                                          _mm_cmpeq_epi8(state, igniting));
+        next = _mm_xor_si128(next, _mm_and_si128(is_toggled, three));
+        _mm_storeu_si128((__m128i *)(cells + k), next);
+    }
+    Frontier_map_scalar(cells + k, num_cells - k);
+}
+#endif
+
+/**
+ * Appends a cell to the igniting cells.
+ *
+ * @param frontier  The fire
+ * @param cell      The cell
+ */
+static inline void Frontier_push(struct Frontier *frontier, size_t cell) {
+    if (frontier->num_igniting == frontier->igniting_capacity) {
+        frontier->igniting_capacity *= 2;
+        frontier->igniting = realloc(frontier->igniting,
+                                     frontier->igniting_capacity
+                                     * sizeof(size_t));
+    }
+    frontier->igniting[frontier->num_igniting++] = cell;
+}
+
+/**
+ * Makes the igniting cells the burning ones, and empties the igniting cells.
+ *
+ * @param frontier  The fire
+ */
+void Frontier_swap(struct Frontier *frontier) {
+    size_t *burning = frontier->burning;
+    size_t burning_capacity = frontier->burning_capacity;
+    frontier->burning = frontier->igniting;
+    frontier->num_burning = frontier->num_igniting;
+    frontier->burning_capacity = frontier->igniting_capacity;
+    frontier->igniting = burning;
+    frontier->igniting_capacity = burning_capacity;
+    frontier->num_igniting = 0;
+}
+
+/**
+ * Marks the ignitable neighbors of a burning cell as igniting.
+ *
+ * @param frontier  The fire
+ * @param cell      The burning cell
+ */
+void Frontier_ignite_neighbors(struct Frontier *frontier, size_t cell) {
+    const long num_rows = frontier->num_rows;
+    const long num_cols = frontier->num_cols;
+    const bool wraps = frontier->boundary == CELLULAR_WRAP_AROUND;
+    long row = cell / num_cols, col = cell % num_cols;
+    for (long i = row - 1; i <= row + 1; ++i) {
+        long r = wraps ? (i + num_rows) % num_rows : i;
+        if (r < 0 || r >= num_rows) continue;
+        for (long j = col - 1; j <= col + 1; ++j) {
+            long c = wraps ? (j + num_cols) % num_cols : j;
+            if (c < 0 || c >= num_cols) continue;
+            size_t neighbor = (size_t)r * num_cols + c;
+            if (frontier->cells[neighbor] == CELLULAR_FIRE_IGNITABLE) {
+                frontier->cells[neighbor] = FRONTIER_IGNITING;
+                Frontier_push(frontier, neighbor);
+            }
+        }
+    }
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Frontier *Frontier_init(const struct CellularAutomaton *automaton) {
+    struct Frontier *frontier = malloc(sizeof(struct Frontier));
+    frontier->num_rows = automaton->num_rows;
+    frontier->num_cols = automaton->num_cols;
+    frontier->boundary = automaton->boundary;
+    size_t num_cells = (size_t)automaton->num_rows * automaton->num_cols;
+    frontier->cells = malloc(num_cells + 1);
+    for (unsigned int i = 0; i < automaton->num_rows; ++i) {
+        Cellular_get_states(automaton, i, 0, automaton->num_cols,
+                            frontier->cells + (size_t)i * frontier->num_cols);
+    }
+    frontier->burning_capacity = FRONTIER_MIN_CAPACITY;
+    frontier->igniting_capacity = FRONTIER_MIN_CAPACITY;
+    frontier->burning = malloc(FRONTIER_MIN_CAPACITY * sizeof(size_t));
+    frontier->igniting = malloc(FRONTIER_MIN_CAPACITY * sizeof(size_t));
+    frontier->num_burning = frontier->num_igniting = 0;
+    for (size_t cell = 0; cell < num_cells; ++cell) {
+        if (frontier->cells[cell] == CELLULAR_FIRE_BURNING) {
+            Frontier_push(frontier, cell);
+        }
+    }
+    Frontier_swap(frontier);
+    return frontier;
+}
+
+void Frontier_step(struct Frontier *frontier) {
+    // The burning cells are still burning while their neighbors are marked
+    for (size_t k = 0; k < frontier->num_burning; ++k) {
+        Frontier_ignite_neighbors(frontier, frontier->burning[k]);
+    }
+    size_t num_cells = (size_t)frontier->num_rows * frontier->num_cols;
+#ifdef FRONTIER_X86
+    if (Stencil_current() != STENCIL_SCALAR) {
+        Frontier_map_sse2(frontier->cells, num_cells);
+    } else {
+        Frontier_map_scalar(frontier->cells, num_cells);
+    }
+#else
+    Frontier_map_scalar(frontier->cells, num_cells);
+#endif
+    Frontier_swap(frontier);
+}
+
+void Frontier_store(const struct Frontier *frontier,
+                    struct CellularAutomaton *automaton) {
+    for (unsigned int i = 0; i < frontier->num_rows; ++i) {
+        Cellular_set_states(automaton, i, 0, frontier->num_cols,
+                            frontier->cells + (size_t)i * frontier->num_cols);
+    }
+}
+
+void Frontier_free(struct Frontier *frontier) {
+    free(frontier->cells);
+    free(frontier->burning);
+    free(frontier->igniting);
+    free(frontier);
+}
@@ -0,0 +1,80 @@
+/**
+ * Provides the fire model driven by its frontier of burning cells.
+ *
+ * In the fire model, only the ignition of an ignitable cell depends on its
+ * neighbors: growing, burning and burnt cells change to the next state
+ * whatever their neighbors. Hence, a step only looks at the neighbors of the
+ * burning cells, which are kept in a list, the frontier: their ignitable
+ * neighbors are marked as igniting and form the next frontier. A single
+ * pass over the grid then applies the pointwise transitions to every cell,
+ * igniting cells becoming burning, with SSE2 instructions unless the scalar
+ * kernel is selected (see `stencil.h`).
+ *
+ * A step thus costs the size of the frontier plus a streaming pass, instead
+ * of a histogram of the 8 neighbors of every cell.
+ */
+#ifndef FRONTIER_H
+#define FRONTIER_H
+
+#include <stddef.h>
+#include "cellular.h"
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A fire whose burning cells are listed.
+ *
+ * The cells are numbered row by row.
+ */
+struct Frontier {
+    unsigned int num_rows;          /**< The number of rows */
+    unsigned int num_cols;          /**< The number of columns */
+    enum CellularBoundary boundary; /**< The boundary type */
+    unsigned char *cells;           /**< The states, row by row */
+    size_t *burning;                /**< The burning cells */
+    size_t num_burning;             /**< The number of burning cells */
+    size_t burning_capacity;        /**< The capacity of `burning` */
+    size_t *igniting;               /**< The cells igniting at this step */
+    size_t num_igniting;            /**< The number of igniting cells */
+    size_t igniting_capacity;       /**< The capacity of `igniting` */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates a fire from a fire automaton.
+ *
+ * @param automaton  The automaton, of type `CELLULAR_FIRE` with a bounded
+ *                   boundary
+ * @return           The fire
+ */
+struct Frontier *Frontier_init(const struct CellularAutomaton *automaton);
+
+/**
+ * Computes the next step of a fire.
+ *
+ * @param frontier  The fire to update
+ */
+void Frontier_step(struct Frontier *frontier);
+
+/**
+ * Copies the cells of a fire into an automaton.
+ *
+ * @param frontier   The fire
+ * @param automaton  The automaton receiving the cells, of the same size
+ */
+void Frontier_store(const struct Frontier *frontier,
+                    struct CellularAutomaton *automaton);
+
+/**
+ * Frees a fire.
+ *
+ * @param frontier  The fire to free
+ */
+void Frontier_free(struct Frontier *frontier);
+
+#endif
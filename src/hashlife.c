@@ -0,0 +1,550 @@
+/**
+ * Implements hashlife.h.
+ *
+ * The successor of a node of level `k` is computed from the nine overlapping
+ * squares of level `k - 1` centered on its quadrants, their edges and its
+ * center. Their successors, of level `k - 2`, are grouped into four squares
+ * of level `k - 1`, whose successors form the result. Each stage covers up
+ * to `2^(k-3)` steps, and the leaves are stepped with the bitwise adders of
+ * `bitlife.h`.
+ */
+#include "hashlife.h"
+#include <stdlib.h>
+#include <string.h>
+#include "bitlife.h"
+
+#define HASHLIFE_LEAF_SIZE 8
+#define HASHLIFE_MIN_NUM_BUCKETS 1024
+#define HASHLIFE_NW 0
+#define HASHLIFE_NE 1
+#define HASHLIFE_SW 2
+#define HASHLIFE_SE 3
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Hashes the content of a node.
+ *
+ * @param level     The level of the node
+ * @param children  Its children
+ * @param cells     Its cells, if it is a leaf
+ * @return          The hash
+ */
+static inline uint64_t Hashlife_hash(unsigned int level,
+                                     struct HashlifeNode *const children[4],
+                                     uint64_t cells) {
+    uint64_t hash = (cells ^ level) * 0x9e3779b97f4a7c15ull;
+    for (unsigned int k = 0; k < 4; ++k) {
+        hash = (hash ^ (uintptr_t)children[k]) * 0x9e3779b97f4a7c15ull;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+/**
+ * Doubles the number of buckets of the hash table of the nodes.
+ *
+ * @param hashlife  The game of life
+ */
+void Hashlife_grow_table(struct Hashlife *hashlife) {
+    size_t num_buckets = 2 * hashlife->num_buckets;
+    struct HashlifeNode **buckets = calloc(num_buckets,
+                                           sizeof(struct HashlifeNode *));
+    for (size_t b = 0; b < hashlife->num_buckets; ++b) {
+        struct HashlifeNode *node = hashlife->buckets[b];
+        while (node != NULL) {
+            struct HashlifeNode *next = node->next;
+            size_t bucket = Hashlife_hash(node->level, node->children,
+                                          node->cells) & (num_buckets - 1);
+            node->next = buckets[bucket];
+            buckets[bucket] = node;
+            node = next;
+        }
+    }
+    free(hashlife->buckets);
+    hashlife->buckets = buckets;
+    hashlife->num_buckets = num_buckets;
+}
+
+/**
+ * Returns the unique node with a given content, creating it if needed.
+ *
+ * @param hashlife  The game of life
+ * @param level     The level of the node
+ * @param children  Its children, NULL if it is a leaf
+ * @param cells     Its cells, if it is a leaf
+ * @return          The node
+ */
+struct HashlifeNode *Hashlife_node(struct Hashlife *hashlife,
+                                   unsigned int level,
+                                   struct HashlifeNode *const children[4],
+                                   uint64_t cells) {
+    uint64_t hash = Hashlife_hash(level, children, cells);
+    struct HashlifeNode **bucket =
+        &hashlife->buckets[hash & (hashlife->num_buckets - 1)];
+    for (struct HashlifeNode *node = *bucket; node != NULL;
+         node = node->next) {
+        if (node->level == level && node->cells == cells
+            && memcmp(node->children, children,
+                      sizeof(node->children)) == 0) {
+            return node;
+        }
+    }
+    struct HashlifeNode *node = malloc(sizeof(struct HashlifeNode));
+    node->level = level;
+    memcpy(node->children, children, sizeof(node->children));
+    node->cells = cells;
+    node->result = NULL;
+    node->partial = NULL;
+    node->num_partial_steps = 0;
+    node->is_marked = false;
+    node->next = *bucket;
+    *bucket = node;
+    if (++hashlife->num_nodes > hashlife->num_buckets) {
+        Hashlife_grow_table(hashlife);
+    }
+    return node;
+}
+
+/**
+ * Returns the leaf with given cells.
+ *
+ * @param hashlife  The game of life
+ * @param cells     The cells, the bit `8 * i + j` being at row i, column j
+ * @return          The leaf
+ */
+static inline struct HashlifeNode *Hashlife_leaf(struct Hashlife *hashlife,
+                                                 uint64_t cells) {
+    struct HashlifeNode *const none[4] = {NULL, NULL, NULL, NULL};
+    return Hashlife_node(hashlife, HASHLIFE_LEAF_LEVEL, none, cells);
+}
+
+/**
+ * Returns the node with given quadrants, all of the same level.
+ *
+ * @param hashlife  The game of life
+ * @param nw        The north-west quadrant
+ * @param ne        The north-east quadrant
+ * @param sw        The south-west quadrant
+ * @param se        The south-east quadrant
+ * @return          The node
+ */
+static inline struct HashlifeNode *Hashlife_join(struct Hashlife *hashlife,
+                                                 struct HashlifeNode *nw,
+                                                 struct HashlifeNode *ne,
+                                                 struct HashlifeNode *sw,
+                                                 struct HashlifeNode *se) {
+    struct HashlifeNode *const children[4] = {nw, ne, sw, se};
+    return Hashlife_node(hashlife, nw->level + 1, children, 0);
+}
+
+/**
+ * Returns the successor of a node of 16 x 16 cells, by stepping its cells.
+ *
+ * The 16 rows are stored in the lowest bits of 16 words. The cells on the
+ * border of the stepped rows are wrong, since their neighbors are unknown,
+ * but the errors only progress by one cell per step, and thus never reach
+ * the central 8 x 8 cells.
+ *
+ * @param hashlife   The game of life
+ * @param node       The node, of level 4
+ * @param num_steps  The number of steps, at most 4
+ * @return           The central leaf after the steps
+ */
+struct HashlifeNode *Hashlife_step_leaves(struct Hashlife *hashlife,
+                                          const struct HashlifeNode *node,
+                                          uint64_t num_steps) {
+    const unsigned int size = 2 * HASHLIFE_LEAF_SIZE;
+    uint64_t rows[2 * HASHLIFE_LEAF_SIZE];
+    for (unsigned int i = 0; i < HASHLIFE_LEAF_SIZE; ++i) {
+        unsigned int shift = HASHLIFE_LEAF_SIZE * i;
+        rows[i] = (node->children[HASHLIFE_NW]->cells >> shift & 0xff)
+                | (node->children[HASHLIFE_NE]->cells >> shift & 0xff) << 8;
+        rows[i + HASHLIFE_LEAF_SIZE] =
+            (node->children[HASHLIFE_SW]->cells >> shift & 0xff)
+          | (node->children[HASHLIFE_SE]->cells >> shift & 0xff) << 8;
+    }
+    for (uint64_t step = 0; step < num_steps; ++step) {
+        uint64_t next[2 * HASHLIFE_LEAF_SIZE];
+        for (unsigned int i = 1; i + 1 < size; ++i) {
+            const uint64_t west[3] = {rows[i - 1] << 1, rows[i] << 1,
+                                      rows[i + 1] << 1};
+            const uint64_t center[3] = {rows[i - 1], rows[i], rows[i + 1]};
+            const uint64_t east[3] = {rows[i - 1] >> 1, rows[i] >> 1,
+                                      rows[i + 1] >> 1};
+            next[i] = Bitlife_next_word(west, center, east, hashlife->birth,
+                                        hashlife->survival) & 0xffff;
+        }
+        memcpy(rows + 1, next + 1, (size - 2) * sizeof(uint64_t));
+    }
+    uint64_t cells = 0;
+    for (unsigned int i = 0; i < HASHLIFE_LEAF_SIZE; ++i) {
+        cells |= (rows[i + 4] >> 4 & 0xff) << (HASHLIFE_LEAF_SIZE * i);
+    }
+    return Hashlife_leaf(hashlife, cells);
+}
+
+/**
+ * Returns the successor of a node after some steps.
+ *
+ * @param hashlife   The game of life
+ * @param node       The node, of level at least 4
+ * @param num_steps  The number of steps, at most `2^(level-2)`
+ * @return           The central square of the node after the steps
+ */
+struct HashlifeNode *Hashlife_successor(struct Hashlife *hashlife,
+                                        struct HashlifeNode *node,
+                                        uint64_t num_steps) {
+    const unsigned int level = node->level;
+    const bool is_full = num_steps == (uint64_t)1 << (level - 2);
+    if (is_full && node->result != NULL) {
+        return node->result;
+    } else if (!is_full && node->partial != NULL
+               && node->num_partial_steps == num_steps) {
+        return node->partial;
+    }
+
+    struct HashlifeNode *result;
+    if (level == HASHLIFE_LEAF_LEVEL + 1) {
+        result = Hashlife_step_leaves(hashlife, node, num_steps);
+    } else {
+        struct HashlifeNode *const *c = node->children;
+        struct HashlifeNode *const *nw = c[HASHLIFE_NW]->children;
+        struct HashlifeNode *const *ne = c[HASHLIFE_NE]->children;
+        struct HashlifeNode *const *sw = c[HASHLIFE_SW]->children;
+        struct HashlifeNode *const *se = c[HASHLIFE_SE]->children;
+        struct HashlifeNode *squares[9] = {
+            c[HASHLIFE_NW],
+            Hashlife_join(hashlife, nw[HASHLIFE_NE], ne[HASHLIFE_NW],
+                          nw[HASHLIFE_SE], ne[HASHLIFE_SW]),
+            c[HASHLIFE_NE],
+            Hashlife_join(hashlife, nw[HASHLIFE_SW], nw[HASHLIFE_SE],
+                          sw[HASHLIFE_NW], sw[HASHLIFE_NE]),
+            Hashlife_join(hashlife, nw[HASHLIFE_SE], ne[HASHLIFE_SW],
+                          sw[HASHLIFE_NE], se[HASHLIFE_NW]),
+            Hashlife_join(hashlife, ne[HASHLIFE_SW], ne[HASHLIFE_SE],
+                          se[HASHLIFE_NW], se[HASHLIFE_NE]),
+            c[HASHLIFE_SW],
+            Hashlife_join(hashlife, sw[HASHLIFE_NE], se[HASHLIFE_NW],
+                          sw[HASHLIFE_SE], se[HASHLIFE_SW]),
+            c[HASHLIFE_SE]
+        };
+        const uint64_t half = (uint64_t)1 << (level - 3);
+        const uint64_t num_first_steps = num_steps > half ? num_steps - half
+                                                          : 0;
+        for (unsigned int k = 0; k < 9; ++k) {
+            squares[k] = Hashlife_successor(hashlife, squares[k],
+                                            num_first_steps);
+        }
+        struct HashlifeNode *quadrants[4];
+        for (unsigned int k = 0; k < 4; ++k) {
+            const unsigned int s = k / 2 * 3 + k % 2;
+            quadrants[k] = Hashlife_successor(
+                hashlife,
+                Hashlife_join(hashlife, squares[s], squares[s + 1],
+                              squares[s + 3], squares[s + 4]),
+                num_steps - num_first_steps
+            );
+        }
+        result = Hashlife_join(hashlife, quadrants[0], quadrants[1],
+                               quadrants[2], quadrants[3]);
+    }
+
+    if (is_full) {
+        node->result = result;
+    } else {
+        node->partial = result;
+        node->num_partial_steps = num_steps;
+    }
+    return result;
+}
+
+/**
+ * Returns the node of a square of the periodic grid.
+ *
+ * @param hashlife  The game of life, whose grid is in `cells`
+ * @param top       The row of the first cell, possibly outside the grid
+ * @param left      The column of the first cell, possibly outside the grid
+ * @param level     The level of the node
+ * @return          The node
+ */
+struct HashlifeNode *Hashlife_build(struct Hashlife *hashlife,
+                                    long top,
+                                    long left,
+                                    unsigned int level) {
+    if (level == HASHLIFE_LEAF_LEVEL) {
+        const long num_rows = hashlife->num_rows;
+        const long num_cols = hashlife->num_cols;
+        uint64_t cells = 0;
+        for (long i = 0; i < HASHLIFE_LEAF_SIZE; ++i) {
+            const unsigned char *row = hashlife->cells
+                + ((top + i) % num_rows + num_rows) % num_rows * num_cols;
+            for (long j = 0; j < HASHLIFE_LEAF_SIZE; ++j) {
+                long col = ((left + j) % num_cols + num_cols) % num_cols;
+                cells |= (uint64_t)row[col] << (HASHLIFE_LEAF_SIZE * i + j);
+            }
+        }
+        return Hashlife_leaf(hashlife, cells);
+    }
+    long half = 1l << (level - 1);
+    return Hashlife_join(hashlife,
+                         Hashlife_build(hashlife, top, left, level - 1),
+                         Hashlife_build(hashlife, top, left + half, level - 1),
+                         Hashlife_build(hashlife, top + half, left, level - 1),
+                         Hashlife_build(hashlife, top + half, left + half,
+                                        level - 1));
+}
+
+/**
+ * Writes the cells of a node lying in the grid.
+ *
+ * @param hashlife  The game of life
+ * @param node      The node
+ * @param top       The row of its first cell
+ * @param left      The column of its first cell
+ * @param cells     The first cell of the grid
+ * @param stride    The distance between two rows of the grid
+ */
+void Hashlife_write(const struct Hashlife *hashlife,
+                    const struct HashlifeNode *node,
+                    unsigned long top,
+                    unsigned long left,
+                    unsigned char *cells,
+                    size_t stride) {
+    if (top >= hashlife->num_rows || left >= hashlife->num_cols) return;
+    if (node->level == HASHLIFE_LEAF_LEVEL) {
+        for (unsigned long i = 0; i < HASHLIFE_LEAF_SIZE
+                                  && top + i < hashlife->num_rows; ++i) {
+            for (unsigned long j = 0; j < HASHLIFE_LEAF_SIZE
+                                      && left + j < hashlife->num_cols; ++j) {
+                cells[(top + i) * stride + left + j] =
+                    node->cells >> (HASHLIFE_LEAF_SIZE * i + j) & 1 ?
+                    CELLULAR_GAME_OF_LIFE_LIVE : CELLULAR_GAME_OF_LIFE_DEAD;
+            }
+        }
+        return;
+    }
+    unsigned long half = 1ul << (node->level - 1);
+    for (unsigned int k = 0; k < 4; ++k) {
+        Hashlife_write(hashlife, node->children[k], top + k / 2 * half,
+                       left + k % 2 * half, cells, stride);
+    }
+}
+
+/**
+ * Marks the nodes reachable from a node through their children.
+ *
+ * @param node  The node
+ */
+void Hashlife_mark(struct HashlifeNode *node) {
+    if (node == NULL || node->is_marked) return;
+    node->is_marked = true;
+    for (unsigned int k = 0; k < 4; ++k) {
+        Hashlife_mark(node->children[k]);
+    }
+}
+
+/**
+ * Frees the nodes that are not part of the grid, if there are too many.
+ *
+ * The memoized successors of the remaining nodes are forgotten when their
+ * node is freed. If most nodes remain, the limit is doubled, to avoid
+ * collecting again at each step.
+ *
+ * @param hashlife  The game of life
+ */
+void Hashlife_collect(struct Hashlife *hashlife) {
+    if (hashlife->num_nodes <= hashlife->max_num_nodes) return;
+    Hashlife_mark(hashlife->root);
+    for (size_t b = 0; b < hashlife->num_buckets; ++b) {
+        for (struct HashlifeNode *node = hashlife->buckets[b]; node != NULL;
+             node = node->next) {
+            if (!node->is_marked) continue;
+            if (node->result != NULL && !node->result->is_marked) {
+                node->result = NULL;
+            }
+            if (node->partial != NULL && !node->partial->is_marked) {
+                node->partial = NULL;
+            }
+        }
+    }
+    for (size_t b = 0; b < hashlife->num_buckets; ++b) {
+        struct HashlifeNode **link = &hashlife->buckets[b];
+        while (*link != NULL) {
+            struct HashlifeNode *node = *link;
+            if (node->is_marked) {
+                node->is_marked = false;
+                link = &node->next;
+            } else {
+                *link = node->next;
+                free(node);
+                --hashlife->num_nodes;
+            }
+        }
+    }
+    if (2 * hashlife->num_nodes > hashlife->max_num_nodes) {
+        hashlife->max_num_nodes *= 2;
+    }
+}
+
+/**
+ * Jumps over steps of a grid stored as a node.
+ *
+ * The plane is tiled with copies of the grid. For a jump of at least the
+ * side `n` of the grid, a node of `2^k` by `2^k` copies is stepped, whose
+ * successor starts at a multiple of `n`: its first quadrant of the size of
+ * the grid is the next grid. Shorter jumps use 2 by 2 copies of the grid
+ * shifted by `n / 2`, so that the successor is exactly the next grid.
+ *
+ * @param hashlife   The game of life, whose grid is `root`
+ * @param num_steps  The maximum number of steps
+ * @return           The number of steps done
+ */
+uint64_t Hashlife_jump_root(struct Hashlife *hashlife, uint64_t num_steps) {
+    struct HashlifeNode *root = hashlife->root;
+    const unsigned int level = root->level;
+    const uint64_t side = (uint64_t)1 << level;
+    uint64_t jump;
+    if (num_steps >= side) {
+        unsigned int k = 2;
+        while (level + k < 63 && (side << (k - 1)) <= num_steps) ++k;
+        jump = side << (k - 2);
+        struct HashlifeNode *node = root;
+        for (unsigned int t = 0; t < k; ++t) {
+            node = Hashlife_join(hashlife, node, node, node, node);
+        }
+        node = Hashlife_successor(hashlife, node, jump);
+        while (node->level > level) node = node->children[HASHLIFE_NW];
+        hashlife->root = node;
+    } else {
+        struct HashlifeNode *const *c = root->children;
+        struct HashlifeNode *shifted = Hashlife_join(
+            hashlife, c[HASHLIFE_SE], c[HASHLIFE_SW], c[HASHLIFE_NE],
+            c[HASHLIFE_NW]
+        );
+        jump = num_steps < side / 2 ? num_steps : side / 2;
+        hashlife->root = Hashlife_successor(
+            hashlife,
+            Hashlife_join(hashlife, shifted, shifted, shifted, shifted),
+            jump
+        );
+    }
+    return jump;
+}
+
+/**
+ * Jumps over steps of a grid stored in `cells`.
+ *
+ * The grid is centered in a node twice as large as its largest side, filled
+ * with the periodic copies of the grid, whose successor covers the grid.
+ *
+ * @param hashlife   The game of life, whose grid is in `cells`
+ * @param num_steps  The maximum number of steps
+ * @return           The number of steps done
+ */
+uint64_t Hashlife_jump_cells(struct Hashlife *hashlife, uint64_t num_steps) {
+    unsigned int side = hashlife->num_rows > hashlife->num_cols ?
+                        hashlife->num_rows : hashlife->num_cols;
+    unsigned int level = HASHLIFE_LEAF_LEVEL + 1;
+    while ((1ul << (level - 1)) < side) ++level;
+    const uint64_t quarter = (uint64_t)1 << (level - 2);
+    uint64_t jump = num_steps < quarter ? num_steps : quarter;
+    struct HashlifeNode *node = Hashlife_build(hashlife, -(long)quarter,
+                                               -(long)quarter, level);
+    node = Hashlife_successor(hashlife, node, jump);
+    Hashlife_write(hashlife, node, 0, 0, hashlife->cells, hashlife->num_cols);
+    return jump;
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Hashlife *Hashlife_init(const struct CellularAutomaton *automaton,
+                               size_t max_num_nodes) {
+    struct Hashlife *hashlife = malloc(sizeof(struct Hashlife));
+    hashlife->num_rows = automaton->num_rows;
+    hashlife->num_cols = automaton->num_cols;
+    hashlife->birth = automaton->rule->birth;
+    hashlife->survival = automaton->rule->survival;
+    hashlife->num_buckets = HASHLIFE_MIN_NUM_BUCKETS;
+    hashlife->buckets = calloc(hashlife->num_buckets,
+                               sizeof(struct HashlifeNode *));
+    hashlife->num_nodes = 0;
+    hashlife->max_num_nodes = max_num_nodes;
+    hashlife->root = NULL;
+    hashlife->cells = malloc((size_t)hashlife->num_rows * hashlife->num_cols
+                             + 1);
+    for (unsigned int i = 0; i < hashlife->num_rows; ++i) {
+        for (unsigned int j = 0; j < hashlife->num_cols; ++j) {
+            hashlife->cells[(size_t)i * hashlife->num_cols + j] =
+                *Cellular_cell(automaton, i, j) == CELLULAR_GAME_OF_LIFE_LIVE;
+        }
+    }
+    unsigned int level = 0;
+    while ((1u << level) < hashlife->num_rows) ++level;
+    if (hashlife->num_rows == 1u << level && hashlife->num_cols == 1u << level
+        && level > HASHLIFE_LEAF_LEVEL) {
+        hashlife->root = Hashlife_build(hashlife, 0, 0, level);
+        free(hashlife->cells);
+        hashlife->cells = NULL;
+    }
+    return hashlife;
+}
+
+void Hashlife_step(struct Hashlife *hashlife, uint64_t num_steps) {
+    if (hashlife->num_rows == 0 || hashlife->num_cols == 0) return;
+    while (num_steps > 0) {
+        if (hashlife->root != NULL) {
+            num_steps -= Hashlife_jump_root(hashlife, num_steps);
+        } else {
+            num_steps -= Hashlife_jump_cells(hashlife, num_steps);
+        }
+        Hashlife_collect(hashlife);
+    }
+}
+
+void Hashlife_store(const struct Hashlife *hashlife,
+                    struct CellularAutomaton *automaton) {
+    if (hashlife->root != NULL && automaton->layout == CELLULAR_ROW_MAJOR) {
+        Hashlife_write(hashlife, hashlife->root, 0, 0, automaton->cells[0],
+                       automaton->stride);
+        return;
+    }
+    if (hashlife->root != NULL) {
+        // The tiles of the Morton layout are filled from a row-major copy
+        unsigned char *cells = malloc((size_t)hashlife->num_rows
+                                      * hashlife->num_cols);
+        Hashlife_write(hashlife, hashlife->root, 0, 0, cells,
+                       hashlife->num_cols);
+        for (unsigned int i = 0; i < hashlife->num_rows; ++i) {
+            Cellular_set_states(automaton, i, 0, hashlife->num_cols,
+                                cells + (size_t)i * hashlife->num_cols);
+        }
+        free(cells);
+        return;
+    }
+    for (unsigned int i = 0; i < hashlife->num_rows; ++i) {
+        for (unsigned int j = 0; j < hashlife->num_cols; ++j) {
+            *Cellular_cell(automaton, i, j) =
+                hashlife->cells[(size_t)i * hashlife->num_cols + j] ?
+                CELLULAR_GAME_OF_LIFE_LIVE : CELLULAR_GAME_OF_LIFE_DEAD;
+        }
+    }
+}
+
+void Hashlife_free(struct Hashlife *hashlife) {
+    for (size_t b = 0; b < hashlife->num_buckets; ++b) {
+        struct HashlifeNode *node = hashlife->buckets[b];
+        while (node != NULL) {
+            struct HashlifeNode *next = node->next;
+            free(node);
+            node = next;
+        }
+    }
+    free(hashlife->buckets);
+    free(hashlife->cells);
+    free(hashlife);
+}
@@ -0,0 +1,114 @@
+/**
+ * Provides a Hashlife implementation of the game of life.
+ *
+ * A square of `2^k x 2^k` cells is represented by a quadtree node, whose four
+ * children are the squares of its quadrants, down to leaves of `8 x 8` cells
+ * stored as bits. Nodes are hash-consed: two equal squares are always the
+ * same node, so that the repetitive regions of the grid are shared.
+ *
+ * The key operation is the successor of a node of `2^k x 2^k` cells: its
+ * central square of `2^(k-1) x 2^(k-1)` cells after up to `2^(k-2)` steps,
+ * which only depends on the node itself. It is computed recursively from the
+ * successors of smaller nodes and memoized in each node, so that a pattern
+ * met again is never computed twice. Hence, a simulation can jump over a
+ * number of steps growing exponentially with the size of the nodes.
+ *
+ * Only the periodic boundary is supported. When the grid is a square whose
+ * side is a power of two, at least 8, the grid itself is a node and jumps of
+ * any power of two of steps are computed through a node tiled with copies of
+ * it. Otherwise, the grid is copied into a node at each jump of up to half
+ * its largest side.
+ *
+ * The number of nodes is bounded: once it exceeds the limit after a jump, the
+ * nodes that are not part of the grid are garbage collected, along with the
+ * memoized successors pointing to them. Note that a single jump over a
+ * chaotic grid can still create many nodes before being collected.
+ */
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cellular.h"
+
+#define HASHLIFE_LEAF_LEVEL 3
+#define HASHLIFE_DEFAULT_MAX_NUM_NODES (1 << 20)
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A square of `2^level x 2^level` cells.
+ *
+ * The children are, in order, the north-west, north-east, south-west and
+ * south-east quadrants. In a leaf, the bit `8 * i + j` of `cells` is the cell
+ * at row `i` and column `j`.
+ */
+struct HashlifeNode {
+    unsigned int level;                 /**< The base 2 logarithm of the side */
+    struct HashlifeNode *children[4];   /**< The quadrants, NULL in a leaf */
+    uint64_t cells;                     /**< The cells, in a leaf */
+    struct HashlifeNode *result;        /**< The successor after 2^(level-2) steps */
+    struct HashlifeNode *partial;       /**< The successor after fewer steps */
+    uint64_t num_partial_steps;         /**< The number of steps of `partial` */
+    struct HashlifeNode *next;          /**< The next node of the same bucket */
+    bool is_marked;                     /**< Is it reachable from the grid? */
+};
+
+/**
+ * A game of life whose cells are stored in a hash-consed quadtree.
+ */
+struct Hashlife {
+    unsigned int num_rows;              /**< The number of rows */
+    unsigned int num_cols;              /**< The number of columns */
+    unsigned int birth;                 /**< Bit k: a dead cell is born with k */
+    unsigned int survival;              /**< Bit k: a live cell survives with k */
+    struct HashlifeNode **buckets;      /**< The hash table of the nodes */
+    size_t num_buckets;                 /**< The number of buckets */
+    size_t num_nodes;                   /**< The number of nodes */
+    size_t max_num_nodes;               /**< The number triggering a collection */
+    struct HashlifeNode *root;          /**< The grid, if a power-of-two square */
+    unsigned char *cells;               /**< The grid, row by row, otherwise */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates a Hashlife game of life from an automaton.
+ *
+ * @param automaton      The game-of-life-type automaton, with periodic boundary
+ * @param max_num_nodes  The number of nodes triggering a garbage collection
+ * @return               The Hashlife game of life
+ */
+struct Hashlife *Hashlife_init(const struct CellularAutomaton *automaton,
+                               size_t max_num_nodes);
+
+/**
+ * Computes the next steps of a Hashlife game of life.
+ *
+ * @param hashlife   The game of life to update
+ * @param num_steps  The number of steps
+ */
+void Hashlife_step(struct Hashlife *hashlife, uint64_t num_steps);
+
+/**
+ * Copies the cells of a Hashlife game of life into an automaton.
+ *
+ * @param hashlife   The game of life
+ * @param automaton  The automaton with the same dimensions
+ */
+void Hashlife_store(const struct Hashlife *hashlife,
+                    struct CellularAutomaton *automaton);
+
+/**
+ * Frees a Hashlife game of life, including all of its nodes.
+ *
+ * @param hashlife  The game of life to free
+ */
+void Hashlife_free(struct Hashlife *hashlife);
+
+#endif
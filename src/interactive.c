@@ -95,7 +95,8 @@ void Interactive_set_to_previous_frame(
  *
  * Note: The data structure is lazy. This means that if the automaton is
  * already known, then it is simply returned. Otherwise, the automaton is
- * computed (recursively) from the previous one.
+ * computed (recursively) from the previous one. Since the frames are computed
+ * in order, the engine is always at the last known frame.
  *
  * @param application  The application
  * @param i            The frame number
@@ -106,9 +107,10 @@ const struct CellularAutomaton *Interactive_get_automaton(
     unsigned int i
 ) {
     if (application->automata[i] == NULL) {
-        application->automata[i] = Cellular_next(
-            Interactive_get_automaton(application, i - 1)
-        );
+        Interactive_get_automaton(application, i - 1);
+        Engine_step(application->engine, 1);
+        application->automata[i] =
+            Cellular_duplicate(Engine_get(application->engine));
     }
     return application->automata[i];
 }
@@ -124,7 +126,7 @@ void Interactive_display_cells(struct InteractiveApplication *application) {
     for (unsigned int i = 0; i < automaton->num_rows; ++i) {
         for (unsigned int j = 0; j < automaton->num_cols; ++j) {
             mvwaddch(application->cells_window, i + 1, j + 1,
-                     automaton->cells[i][j]);
+                     Cellular_get(automaton, i, j));
         }
     }
 }
@@ -165,6 +167,7 @@ struct InteractiveApplication *Interactive_init(
     application = malloc(sizeof(struct InteractiveApplication));
     application->automata = calloc(num_frames, sizeof(struct CellularAutomaton*));
     application->automata[0] = Cellular_duplicate(automaton);
+    application->engine = Engine_init(automaton, ENGINE_AUTO, 1);
     application->current_frame = 0;
     application->num_frames = num_frames;
     application->state = APPLICATION_PAUSED;
@@ -232,5 +235,6 @@ void Interactive_free(struct InteractiveApplication *application) {
         }
     }
     free(application->automata);
+    Engine_free(application->engine);
     free(application);
 }
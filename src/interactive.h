@@ -9,6 +9,7 @@
 
 #include <ncurses.h>
 #include "cellular.h"
+#include "engine.h"
 
 // ----- //
 // Types //
@@ -31,6 +32,7 @@ struct InteractiveApplication {
     struct CellularAutomaton **automata; /**< The automaton at each step */
     unsigned int current_frame;          /**< The current step */
     unsigned int num_frames;             /**< The number of steps */
+    struct Engine *engine;               /**< The engine at the last frame */
     enum ApplicationState state;         /**< The current state */
     WINDOW *cells_window;                /**< The window of the cells */
     WINDOW *keys_window;                 /**< The window with the keys */
@@ -0,0 +1,259 @@
+/**
+ * Implements mapped.h.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "mapped.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "random.h"
+#include "utils.h"
+
+/**
+ * The maximum number of cells updated by a single call to
+ * `Cellular_step_cells`, whose counts are 32-bit.
+ */
+#define MAPPED_SEGMENT_SIZE (1u << 30)
+
+/**
+ * A random mapped automaton drawn by bands of rows.
+ */
+struct MappedRandom {
+    struct Mapped *mapped;          /**< The automaton to set */
+    uint64_t seed;                  /**< The seed of the grid */
+    struct RandomAlias alias;       /**< The distribution of the states */
+};
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Creates a file of a given size in a directory and maps it in memory.
+ *
+ * The name of the file is the prefix followed by a unique suffix chosen by
+ * `mkstemp`, which never opens an existing file. The file is removed once
+ * mapped, its pages staying reachable through the mapping until it is
+ * unmapped.
+ *
+ * @param directory  The directory
+ * @param prefix     The prefix of the name of the file
+ * @param size       The size of the file, at least 1
+ * @return           The mapped file, or NULL in case of failure
+ */
+unsigned char *Mapped_map(const char *directory,
+                          const char *prefix,
+                          size_t size) {
+    char *path = malloc(strlen(directory) + strlen(prefix) + 9);
+    sprintf(path, "%s/%s.XXXXXX", directory, prefix);
+    int fd = mkstemp(path);
+    void *cells = MAP_FAILED;
+    if (fd >= 0) {
+        if (ftruncate(fd, size) == 0) {
+            cells = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                         0);
+        }
+        close(fd);
+        unlink(path);
+    }
+    free(path);
+    if (cells == MAP_FAILED) return NULL;
+    // Each step reads and writes the grids from the first row to the last
+    posix_madvise(cells, size, POSIX_MADV_SEQUENTIAL);
+    return cells;
+}
+
+/**
+ * Loads a row of the current grid into a row of a window, with its halo.
+ *
+ * The rows and columns outside of the grid are the opposite ones if the
+ * boundary wraps around, and are in state 0 otherwise.
+ *
+ * @param mapped  The automaton
+ * @param row     The row of the grid, from -1 to `num_rows`
+ * @param cells   The row of the window, whose halo is `cells[-1]` and
+ *                `cells[num_cols]`
+ */
+void Mapped_load_row(const struct Mapped *mapped,
+                     int64_t row,
+                     unsigned char *cells) {
+    const uint64_t num_cols = mapped->num_cols;
+    bool wraps = mapped->boundary == CELLULAR_WRAP_AROUND;
+    if (row < 0 || (uint64_t)row >= mapped->num_rows) {
+        if (!wraps) {
+            memset(cells - 1, 0, num_cols + 2);
+            return;
+        }
+        row = row < 0 ? (int64_t)mapped->num_rows - 1 : 0;
+    }
+    memcpy(cells, mapped->current + (uint64_t)row * num_cols, num_cols);
+    cells[-1] = wraps ? cells[num_cols - 1] : 0;
+    cells[num_cols] = wraps ? cells[0] : 0;
+}
+
+/**
+ * Draws the cells of a band of rows of a random mapped automaton, as a task
+ * of its pool.
+ *
+ * @param data         The random automaton
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Mapped_set_random_band(void *data,
+                            unsigned int index,
+                            unsigned int num_threads) {
+    const struct MappedRandom *random = data;
+    const struct Mapped *mapped = random->mapped;
+    uint64_t first_row = mapped->num_rows * index / num_threads;
+    uint64_t last_row = mapped->num_rows * (index + 1) / num_threads;
+    for (uint64_t i = first_row; i < last_row; ++i) {
+        Random_fill(&random->alias, random->seed, i * mapped->num_cols,
+                    mapped->num_cols, mapped->current + i * mapped->num_cols);
+    }
+}
+
+/**
+ * Updates a band of rows of a mapped automaton, as a task of its pool.
+ *
+ * The band is streamed through a window of three rows: once a row is
+ * updated, the row above it is replaced with the row below the next one.
+ *
+ * @param data         The automaton
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Mapped_step_band(void *data,
+                      unsigned int index,
+                      unsigned int num_threads) {
+    const struct Mapped *mapped = data;
+    const uint64_t num_cols = mapped->num_cols;
+    uint64_t first_row = mapped->num_rows * index / num_threads;
+    uint64_t last_row = mapped->num_rows * (index + 1) / num_threads;
+    if (first_row == last_row) return;
+    unsigned char *window = mapped->windows
+                          + 3 * index * mapped->window_stride
+                          + CELLULAR_ALIGNMENT;
+    unsigned char *above = window;
+    unsigned char *row = window + mapped->window_stride;
+    unsigned char *below = window + 2 * mapped->window_stride;
+    Mapped_load_row(mapped, (int64_t)first_row - 1, above);
+    Mapped_load_row(mapped, first_row, row);
+    for (uint64_t i = first_row; i < last_row; ++i) {
+        Mapped_load_row(mapped, i + 1, below);
+        unsigned char *next = mapped->next + i * num_cols;
+        for (uint64_t j = 0; j < num_cols; j += MAPPED_SEGMENT_SIZE) {
+            uint64_t num_cells = num_cols - j < MAPPED_SEGMENT_SIZE
+                               ? num_cols - j : MAPPED_SEGMENT_SIZE;
+            Cellular_step_cells(mapped->rule, above + j, row + j, below + j,
+                                num_cells, next + j);
+        }
+        unsigned char *previous = above;
+        above = row;
+        row = below;
+        below = previous;
+    }
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Mapped *Mapped_init(const char *directory,
+                           uint64_t num_rows,
+                           uint64_t num_cols,
+                           enum CellularType type,
+                           enum CellularBoundary boundary,
+                           const char *allowed_cells,
+                           const struct Rule *rule,
+                           unsigned int num_threads) {
+    if (!Cellular_is_valid(type, allowed_cells) ||
+        boundary == CELLULAR_UNBOUNDED) return NULL;
+    if (num_rows != 0 && num_cols > SIZE_MAX / num_rows) return NULL;
+    struct Mapped *mapped = malloc(sizeof(struct Mapped));
+    mapped->num_rows = num_rows;
+    mapped->num_cols = num_cols;
+    mapped->type = type;
+    mapped->boundary = boundary;
+    mapped->size = num_rows * num_cols > 0 ? num_rows * num_cols : 1;
+    mapped->current = Mapped_map(directory, "current", mapped->size);
+    mapped->next = Mapped_map(directory, "next", mapped->size);
+    if (mapped->current == NULL || mapped->next == NULL) {
+        if (mapped->current != NULL) munmap(mapped->current, mapped->size);
+        if (mapped->next != NULL) munmap(mapped->next, mapped->size);
+        free(mapped);
+        return NULL;
+    }
+    mapped->allowed_cells = strdupli(allowed_cells);
+    mapped->rule = rule != NULL ? Rule_duplicate(rule)
+                                : Cellular_default_rule(type);
+    uint64_t max_threads = num_rows > 0 ? num_rows : 1;
+    num_threads = num_threads < max_threads ? num_threads : max_threads;
+    mapped->pool = Pool_init(num_threads);
+    mapped->window_stride = (num_cols + 2 * CELLULAR_ALIGNMENT)
+                          / CELLULAR_ALIGNMENT * CELLULAR_ALIGNMENT;
+    mapped->windows = aligned_alloc(CELLULAR_ALIGNMENT,
+                                    3 * num_threads * mapped->window_stride);
+    return mapped;
+}
+
+void Mapped_set_random(struct Mapped *mapped,
+                       const unsigned int *distribution,
+                       uint64_t seed) {
+    struct MappedRandom random = {.mapped = mapped, .seed = seed};
+    Random_alias_init(&random.alias, distribution,
+                      Cellular_num_cells(mapped->type));
+    Pool_run(mapped->pool, Mapped_set_random_band, &random);
+}
+
+char Mapped_get(const struct Mapped *mapped, uint64_t row, uint64_t col) {
+    unsigned char state = mapped->current[row * mapped->num_cols + col];
+    return state < Cellular_num_cells(mapped->type) ?
+           mapped->allowed_cells[state] : UNINITIALIZED_CELL;
+}
+
+bool Mapped_set(struct Mapped *mapped, uint64_t row, uint64_t col, char cell) {
+    const char *allowed_cell = strchr(mapped->allowed_cells, cell);
+    if (cell == '\0' || allowed_cell == NULL) return false;
+    mapped->current[row * mapped->num_cols + col] =
+        allowed_cell - mapped->allowed_cells;
+    return true;
+}
+
+void Mapped_step(struct Mapped *mapped, uint64_t num_steps) {
+    if (mapped->num_rows == 0 || mapped->num_cols == 0) return;
+    for (uint64_t step = 0; step < num_steps; ++step) {
+        Pool_run(mapped->pool, Mapped_step_band, mapped);
+        unsigned char *current = mapped->current;
+        mapped->current = mapped->next;
+        mapped->next = current;
+    }
+}
+
+void Mapped_print(const struct Mapped *mapped) {
+    char cells[CELLULAR_NUM_CHARS];
+    unsigned int num_cells = Cellular_num_cells(mapped->type);
+    memset(cells, UNINITIALIZED_CELL, CELLULAR_NUM_CHARS);
+    memcpy(cells, mapped->allowed_cells, num_cells);
+    char *line = malloc(mapped->num_cols + 1);
+    for (uint64_t i = 0; i < mapped->num_rows; ++i) {
+        const unsigned char *row = mapped->current + i * mapped->num_cols;
+        for (uint64_t j = 0; j < mapped->num_cols; ++j) {
+            line[j] = cells[row[j]];
+        }
+        line[mapped->num_cols] = '\n';
+        fwrite(line, sizeof(char), mapped->num_cols + 1, stdout);
+    }
+    free(line);
+}
+
+void Mapped_free(struct Mapped *mapped) {
+    munmap(mapped->current, mapped->size);
+    munmap(mapped->next, mapped->size);
+    Pool_free(mapped->pool);
+    free(mapped->windows);
+    free(mapped->allowed_cells);
+    Rule_free(mapped->rule);
+    free(mapped);
+}
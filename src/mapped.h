@@ -0,0 +1,139 @@
+/**
+ * Provides cellular automata too large to be held in memory.
+ *
+ * The current and the next states of the grid are stored in two files of a
+ * directory on a local disk, which are mapped in memory, so that the system
+ * only keeps in memory the pages being accessed and writes the others back
+ * to the disk. Each step streams the current grid from the first row to the
+ * last one: each thread updates a band of rows, holding in flight only a
+ * window of three rows (the row being updated and its neighbors), each with
+ * its halo. The next row is written directly into the mapped next grid.
+ *
+ * The cells are stored row by row, without any halo, one byte per cell, so
+ * that the files are exactly `num_rows * num_cols` bytes long. The rows,
+ * columns and offsets are 64-bit integers throughout.
+ *
+ * The files are created with unique names, so that several processes may
+ * share the same directory, and are removed as soon as they are mapped, so
+ * that they never outlive the process, even if it is interrupted.
+ */
+#ifndef MAPPED_H
+#define MAPPED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cellular.h"
+#include "pool.h"
+#include "rule.h"
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A cellular automaton whose grids are mapped from files.
+ */
+struct Mapped {
+    uint64_t num_rows;              /**< Its number of rows */
+    uint64_t num_cols;              /**< Its number of columns */
+    enum CellularType type;         /**< Its type */
+    enum CellularBoundary boundary; /**< Its boundary type */
+    char *allowed_cells;            /**< The allowed cells */
+    struct Rule *rule;              /**< Its rule */
+    unsigned char *current;         /**< The mapped current states */
+    unsigned char *next;            /**< The mapped next states */
+    size_t size;                    /**< The size of each mapped grid */
+    struct Pool *pool;              /**< The threads computing the steps */
+    size_t window_stride;           /**< The distance between window rows */
+    unsigned char *windows;         /**< The three-row window of each thread */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates a mapped cellular automaton whose cells are in state 0.
+ *
+ * Two files with unique names are created in the directory, leaving any
+ * existing file untouched, and are removed right away.
+ *
+ * @param directory      The directory of the files
+ * @param num_rows       Its number of rows
+ * @param num_cols       Its number of columns
+ * @param type           Its type
+ * @param boundary       How to process the boundaries, except unbounded
+ * @param allowed_cells  The allowed cells
+ * @param rule           Its rule, copied, or NULL for the default rule
+ * @param num_threads    The number of threads computing each step
+ * @return               The automaton, or NULL if the arguments are invalid
+ *                       or the files cannot be created and mapped
+ */
+struct Mapped *Mapped_init(const char *directory,
+                           uint64_t num_rows,
+                           uint64_t num_cols,
+                           enum CellularType type,
+                           enum CellularBoundary boundary,
+                           const char *allowed_cells,
+                           const struct Rule *rule,
+                           unsigned int num_threads);
+
+/**
+ * Randomly initializes the cells of a mapped cellular automaton from a seed.
+ *
+ * The rows are drawn in parallel by the threads of the automaton, and the
+ * cells are those set by `Cellular_set_random_seeded` with the same seed.
+ *
+ * @param mapped        The automaton
+ * @param distribution  The weight of each allowed cell
+ * @param seed          The seed
+ */
+void Mapped_set_random(struct Mapped *mapped,
+                       const unsigned int *distribution,
+                       uint64_t seed);
+
+/**
+ * Returns the cell at given row and column, as an allowed cell.
+ *
+ * @param mapped  The automaton
+ * @param row     The row number
+ * @param col     The column number
+ * @return        The cell
+ */
+char Mapped_get(const struct Mapped *mapped, uint64_t row, uint64_t col);
+
+/**
+ * Sets the cell at given row and column.
+ *
+ * @param mapped  The automaton
+ * @param row     The row number
+ * @param col     The column number
+ * @param cell    The new cell
+ * @return        True if and only if the cell is allowed
+ */
+bool Mapped_set(struct Mapped *mapped, uint64_t row, uint64_t col, char cell);
+
+/**
+ * Updates a mapped cellular automaton by some steps.
+ *
+ * @param mapped     The automaton
+ * @param num_steps  The number of steps
+ */
+void Mapped_step(struct Mapped *mapped, uint64_t num_steps);
+
+/**
+ * Prints the cells of a mapped cellular automaton to stdout, row by row.
+ *
+ * @param mapped  The automaton
+ */
+void Mapped_print(const struct Mapped *mapped);
+
+/**
+ * Unmaps the grids of a mapped cellular automaton and frees it.
+ *
+ * @param mapped  The automaton to free
+ */
+void Mapped_free(struct Mapped *mapped);
+
+#endif
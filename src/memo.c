@@ -0,0 +1,275 @@
+/**
+ * Implements memo.h.
+ */
+#include "memo.h"
+#include <stdlib.h>
+#include <string.h>
+#include "rule.h"
+
+/**
+ * The end of a list of entries.
+ */
+#define MEMO_NONE UINT32_MAX
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Packs the states of consecutive cells of a row, 2 bits per cell.
+ *
+ * The bytes of the states are gathered pairwise, then by four and eight.
+ *
+ * @param cells      The cells
+ * @param num_cells  The number of cells, at most 8
+ * @return           The packed states, the first cell in the lowest bits
+ */
+static inline uint64_t Memo_pack_row(const unsigned char *cells,
+                                     unsigned int num_cells) {
+    uint64_t states = 0;
+    for (unsigned int j = 0; j < num_cells; ++j) {
+        states |= (uint64_t)cells[j] << (8 * j);
+    }
+    states &= 0x0303030303030303;
+    states = (states | states >> 6) & 0x000F000F000F000F;
+    states = (states | states >> 12) & 0x000000FF000000FF;
+    return (states | states >> 24) & 0xFFFF;
+}
+
+/**
+ * Unpacks the states of consecutive cells of a row packed by
+ * `Memo_pack_row`.
+ *
+ * @param states  The packed states of the `MEMO_TILE_SIZE` cells
+ * @param cells   The cells receiving the states
+ */
+static inline void Memo_unpack_row(uint32_t states, unsigned char *cells) {
+    states = (states | states << 12) & 0x000F000F;
+    states = (states | states << 6) & 0x03030303;
+    for (unsigned int j = 0; j < MEMO_TILE_SIZE; ++j) {
+        cells[j] = states >> (8 * j);
+    }
+}
+
+/**
+ * Packs the window of a tile, 2 bits per cell.
+ *
+ * The first five rows of the window are stored in the first word, 12 bits
+ * per row, and the last one in the second word.
+ *
+ * @param automaton  The automaton, whose halo is up to date
+ * @param first_row  The first row of the tile
+ * @param first_col  The first column of the tile
+ * @param window     The packed window
+ */
+static inline void Memo_pack_window(const struct CellularAutomaton *automaton,
+                                    unsigned int first_row,
+                                    unsigned int first_col,
+                                    uint64_t *window) {
+    // A tile never straddles two tiles of the Morton layout, whose halo
+    // then surrounds it as well
+    const unsigned char *cells = Cellular_cell(automaton, first_row, first_col)
+                               - automaton->stride - 1;
+    const unsigned int num_bits = 2 * MEMO_WINDOW_SIZE;
+    window[0] = 0;
+    for (unsigned int i = 0; i < MEMO_WINDOW_SIZE - 1; ++i) {
+        window[0] |= Memo_pack_row(cells, MEMO_WINDOW_SIZE) << (num_bits * i);
+        cells += automaton->stride;
+    }
+    window[1] = Memo_pack_row(cells, MEMO_WINDOW_SIZE);
+}
+
+/**
+ * Returns the bucket of a window.
+ *
+ * @param memo    The caches
+ * @param window  The packed window
+ * @return        Its bucket
+ */
+static inline uint32_t Memo_bucket(const struct Memo *memo,
+                                   const uint64_t *window) {
+    // The finalizer of SplitMix64, so that every bit of the window counts
+    uint64_t hash = window[0] ^ window[1] * 0x9E3779B97F4A7C15;
+    hash = (hash ^ hash >> 30) * 0xBF58476D1CE4E5B9;
+    hash = (hash ^ hash >> 27) * 0x94D049BB133111EB;
+    return (hash ^ hash >> 31) & (memo->num_buckets - 1);
+}
+
+/**
+ * Removes an entry from the list of the used entries.
+ *
+ * @param cache  The cache
+ * @param entry  The entry
+ */
+static inline void Memo_unlink(struct MemoCache *cache, uint32_t entry) {
+    struct MemoEntry *e = cache->entries + entry;
+    if (e->older != MEMO_NONE) {
+        cache->entries[e->older].newer = e->newer;
+    } else {
+        cache->oldest = e->newer;
+    }
+    if (e->newer != MEMO_NONE) {
+        cache->entries[e->newer].older = e->older;
+    } else {
+        cache->newest = e->older;
+    }
+}
+
+/**
+ * Appends an entry to the list of the used entries, as the newest one.
+ *
+ * @param cache  The cache
+ * @param entry  The entry
+ */
+static inline void Memo_link(struct MemoCache *cache, uint32_t entry) {
+    struct MemoEntry *e = cache->entries + entry;
+    e->older = cache->newest;
+    e->newer = MEMO_NONE;
+    if (cache->newest != MEMO_NONE) {
+        cache->entries[cache->newest].newer = entry;
+    } else {
+        cache->oldest = entry;
+    }
+    cache->newest = entry;
+}
+
+/**
+ * Returns a free entry, evicting the least recently used one if the cache is
+ * full.
+ *
+ * @param memo   The caches
+ * @param cache  The cache
+ * @return       The free entry, in no list
+ */
+uint32_t Memo_free_entry(const struct Memo *memo, struct MemoCache *cache) {
+    if (cache->num_entries < memo->capacity) return cache->num_entries++;
+    uint32_t entry = cache->oldest;
+    Memo_unlink(cache, entry);
+    uint32_t *link = cache->buckets
+                   + Memo_bucket(memo, cache->entries[entry].window);
+    while (*link != entry) {
+        link = &cache->entries[*link].next;
+    }
+    *link = cache->entries[entry].next;
+    return entry;
+}
+
+/**
+ * Writes the packed next states of a tile into an automaton.
+ *
+ * @param automaton  The automaton
+ * @param first_row  The first row of the tile
+ * @param first_col  The first column of the tile
+ * @param tile       The packed states, 2 bits per cell
+ */
+static inline void Memo_unpack_tile(struct CellularAutomaton *automaton,
+                                    unsigned int first_row,
+                                    unsigned int first_col,
+                                    uint32_t tile) {
+    for (unsigned int i = 0; i < MEMO_TILE_SIZE; ++i) {
+        Memo_unpack_row(tile >> (2 * MEMO_TILE_SIZE * i) & 0xFF,
+                        Cellular_cell(automaton, first_row + i, first_col));
+    }
+}
+
+/**
+ * Packs the states of a tile of an automaton, 2 bits per cell.
+ *
+ * @param automaton  The automaton
+ * @param first_row  The first row of the tile
+ * @param first_col  The first column of the tile
+ * @return           The packed states
+ */
+static inline uint32_t Memo_pack_tile(
+    const struct CellularAutomaton *automaton,
+    unsigned int first_row,
+    unsigned int first_col
+) {
+    uint32_t tile = 0;
+    for (unsigned int i = 0; i < MEMO_TILE_SIZE; ++i) {
+        tile |= Memo_pack_row(Cellular_cell(automaton, first_row + i,
+                                            first_col), MEMO_TILE_SIZE)
+                << (2 * MEMO_TILE_SIZE * i);
+    }
+    return tile;
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Memo *Memo_init(uint32_t capacity, unsigned int num_threads) {
+    struct Memo *memo = malloc(sizeof(struct Memo));
+    memo->capacity = capacity;
+    memo->num_buckets = 1;
+    while (memo->num_buckets < capacity) memo->num_buckets *= 2;
+    memo->num_threads = num_threads;
+    memo->caches = malloc(num_threads * sizeof(struct MemoCache));
+    for (unsigned int t = 0; t < num_threads; ++t) {
+        struct MemoCache *cache = memo->caches + t;
+        cache->entries = malloc(capacity * sizeof(struct MemoEntry));
+        cache->buckets = malloc(memo->num_buckets * sizeof(uint32_t));
+        memset(cache->buckets, 0xFF, memo->num_buckets * sizeof(uint32_t));
+        cache->num_entries = 0;
+        cache->oldest = cache->newest = MEMO_NONE;
+        cache->num_hits = cache->num_lookups = 0;
+    }
+    return memo;
+}
+
+void Memo_step_tile(struct Memo *memo,
+                    unsigned int thread,
+                    const struct CellularAutomaton *src,
+                    struct CellularAutomaton *dst,
+                    unsigned int first_row,
+                    unsigned int first_col) {
+    struct MemoCache *cache = memo->caches + thread;
+    uint64_t window[2];
+    Memo_pack_window(src, first_row, first_col, window);
+    uint32_t bucket = Memo_bucket(memo, window);
+    ++cache->num_lookups;
+    for (uint32_t entry = cache->buckets[bucket]; entry != MEMO_NONE;
+         entry = cache->entries[entry].next) {
+        struct MemoEntry *e = cache->entries + entry;
+        if (e->window[0] == window[0] && e->window[1] == window[1]) {
+            ++cache->num_hits;
+            if (entry != cache->newest) {
+                Memo_unlink(cache, entry);
+                Memo_link(cache, entry);
+            }
+            Memo_unpack_tile(dst, first_row, first_col, e->tile);
+            return;
+        }
+    }
+    Cellular_step_tile(src, dst, first_row, MEMO_TILE_SIZE, first_col,
+                       MEMO_TILE_SIZE);
+    uint32_t entry = Memo_free_entry(memo, cache);
+    struct MemoEntry *e = cache->entries + entry;
+    e->window[0] = window[0];
+    e->window[1] = window[1];
+    e->tile = Memo_pack_tile(dst, first_row, first_col);
+    e->next = cache->buckets[bucket];
+    cache->buckets[bucket] = entry;
+    Memo_link(cache, entry);
+}
+
+void Memo_get_stats(const struct Memo *memo, struct MemoStats *stats) {
+    stats->num_hits = stats->num_lookups = stats->num_entries = 0;
+    for (unsigned int t = 0; t < memo->num_threads; ++t) {
+        stats->num_hits += memo->caches[t].num_hits;
+        stats->num_lookups += memo->caches[t].num_lookups;
+        stats->num_entries += memo->caches[t].num_entries;
+    }
+    stats->memory_size = memo->num_threads
+                       * (memo->capacity * sizeof(struct MemoEntry)
+                          + memo->num_buckets * sizeof(uint32_t));
+}
+
+void Memo_free(struct Memo *memo) {
+    for (unsigned int t = 0; t < memo->num_threads; ++t) {
+        free(memo->caches[t].entries);
+        free(memo->caches[t].buckets);
+    }
+    free(memo->caches);
+    free(memo);
+}
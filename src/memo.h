@@ -0,0 +1,127 @@
+/**
+ * Provides a memoization of the steps of small tiles of cells.
+ *
+ * The next states of a tile of `MEMO_TILE_SIZE x MEMO_TILE_SIZE` cells only
+ * depend on the tile and on its halo of one cell, i.e. on a window of
+ * `MEMO_WINDOW_SIZE x MEMO_WINDOW_SIZE` cells. Since a state fits in 2 bits
+ * (see `RULE_MAX_NUM_STATES`), a window is packed into a 72-bit key, and the
+ * next states of the tile into a 32-bit value, whatever the type of the
+ * automaton. Grids with many repeated configurations, e.g. empty regions or
+ * uniform forests, then mostly find their tiles in the cache instead of
+ * evaluating the rule.
+ *
+ * Each thread has its own cache, a hash table of at most `capacity` entries:
+ * once it is full, the least recently used entry is evicted. The caches are
+ * only valid for a single rule.
+ */
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cellular.h"
+
+#define MEMO_TILE_SIZE 4
+#define MEMO_WINDOW_SIZE (MEMO_TILE_SIZE + 2)
+#define MEMO_DEFAULT_CAPACITY (1 << 16)
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A memoized step of a tile.
+ *
+ * The entries are linked by their indices, `UINT32_MAX` ending a list.
+ */
+struct MemoEntry {
+    uint64_t window[2];             /**< The packed window, 2 bits per cell */
+    uint32_t tile;                  /**< The packed next states of the tile */
+    uint32_t next;                  /**< The next entry of the same bucket */
+    uint32_t older;                 /**< The previously used entry */
+    uint32_t newer;                 /**< The next used entry */
+};
+
+/**
+ * The cache of a thread.
+ */
+struct MemoCache {
+    struct MemoEntry *entries;      /**< The entries */
+    uint32_t *buckets;              /**< The first entry of each bucket */
+    uint32_t num_entries;           /**< The number of entries */
+    uint32_t oldest;                /**< The least recently used entry */
+    uint32_t newest;                /**< The most recently used entry */
+    unsigned long num_hits;         /**< The number of tiles found */
+    unsigned long num_lookups;      /**< The number of tiles looked up */
+};
+
+/**
+ * The caches of the threads computing the steps of an automaton.
+ */
+struct Memo {
+    uint32_t capacity;              /**< The maximal number of entries */
+    uint32_t num_buckets;           /**< The number of buckets, a power of 2 */
+    unsigned int num_threads;       /**< The number of threads */
+    struct MemoCache *caches;       /**< The cache of each thread */
+};
+
+/**
+ * The use of the caches.
+ */
+struct MemoStats {
+    unsigned long num_hits;         /**< The number of tiles found */
+    unsigned long num_lookups;      /**< The number of tiles looked up */
+    unsigned long num_entries;      /**< The number of entries */
+    size_t memory_size;             /**< The size of the caches, in bytes */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates empty caches.
+ *
+ * @param capacity     The maximal number of entries of each cache, at least 1
+ * @param num_threads  The number of threads
+ * @return             The caches
+ */
+struct Memo *Memo_init(uint32_t capacity, unsigned int num_threads);
+
+/**
+ * Writes the next step of a tile into another automaton.
+ *
+ * The tile is looked up in the cache of the thread, and only computed with
+ * `Cellular_step_tile` if it is missing. As for `Cellular_step_rows`, the
+ * halo of `src` must be up to date.
+ *
+ * @param memo       The caches
+ * @param thread     The index of the calling thread
+ * @param src        The automaton to update
+ * @param dst        The automaton receiving the updated cells
+ * @param first_row  The first row of the tile
+ * @param first_col  The first column of the tile
+ */
+void Memo_step_tile(struct Memo *memo,
+                    unsigned int thread,
+                    const struct CellularAutomaton *src,
+                    struct CellularAutomaton *dst,
+                    unsigned int first_row,
+                    unsigned int first_col);
+
+/**
+ * Returns the use of the caches of all the threads.
+ *
+ * @param memo   The caches
+ * @param stats  The use of the caches
+ */
+void Memo_get_stats(const struct Memo *memo, struct MemoStats *stats);
+
+/**
+ * Frees caches.
+ *
+ * @param memo  The caches to free
+ */
+void Memo_free(struct Memo *memo);
+
+#endif
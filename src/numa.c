@@ -0,0 +1,204 @@
+/**
+ * Implements numa.h.
+ *
+ * The topology is read from sysfs and the node of a page is asked to the
+ * kernel with the `get_mempolicy` system call, so that the program does not
+ * depend on libnuma.
+ */
+#define _GNU_SOURCE
+#include "numa.h"
+#include <dirent.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "utils.h"
+
+/**
+ * The flags of `get_mempolicy` returning the node of an address.
+ */
+#define NUMA_MPOL_F_NODE 1
+#define NUMA_MPOL_F_ADDR 2
+
+/**
+ * Are large allocations backed by huge pages?
+ */
+static bool Numa_use_huge_pages = false;
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Reads the CPUs of a node into the node of each CPU.
+ *
+ * The list of CPUs is made of ranges separated by commas, e.g. `0-3,8-11`.
+ *
+ * @param node         The node
+ * @param node_of_cpu  The node of each CPU, set for the CPUs of the node
+ */
+void Numa_read_cpulist(unsigned int node, int *node_of_cpu) {
+    char path[128];
+    snprintf(path, sizeof(path), NUMA_NODE_DIRECTORY "/node%u/cpulist", node);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return;
+    unsigned int first, last;
+    int num_read;
+    while ((num_read = fscanf(file, "%u-%u", &first, &last)) >= 1) {
+        if (num_read == 1) last = first;
+        for (unsigned int cpu = first; cpu <= last && cpu < CPU_SETSIZE;
+             ++cpu) {
+            node_of_cpu[cpu] = node;
+        }
+        if (fgetc(file) != ',') break;
+    }
+    fclose(file);
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct NumaTopology *Numa_init() {
+    int *node_of_cpu = malloc(CPU_SETSIZE * sizeof(int));
+    for (unsigned int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        node_of_cpu[cpu] = -1;
+    }
+    unsigned int max_node = 0;
+    DIR *directory = opendir(NUMA_NODE_DIRECTORY);
+    if (directory != NULL) {
+        struct dirent *entry;
+        unsigned int node;
+        while ((entry = readdir(directory)) != NULL) {
+            if (sscanf(entry->d_name, "node%u", &node) == 1) {
+                Numa_read_cpulist(node, node_of_cpu);
+                max_node = max(max_node, node);
+            }
+        }
+        closedir(directory);
+    }
+    cpu_set_t available;
+    CPU_ZERO(&available);
+    if (sched_getaffinity(0, sizeof(available), &available) != 0) {
+        CPU_SET(0, &available);
+    }
+    // The CPUs of an unknown node are gathered on the first node
+    for (unsigned int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &available) && node_of_cpu[cpu] < 0) {
+            node_of_cpu[cpu] = 0;
+        }
+    }
+
+    struct NumaTopology *topology = malloc(sizeof(struct NumaTopology));
+    unsigned int num_available = max(CPU_COUNT(&available), 1);
+    topology->num_nodes = 0;
+    topology->num_cpus = 0;
+    topology->cpus = malloc(num_available * sizeof(unsigned int));
+    topology->nodes = malloc(num_available * sizeof(unsigned int));
+    for (unsigned int node = 0; node <= max_node; ++node) {
+        unsigned int num_cpus = topology->num_cpus;
+        for (unsigned int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &available) && node_of_cpu[cpu] == (int)node) {
+                topology->cpus[topology->num_cpus] = cpu;
+                topology->nodes[topology->num_cpus++] = node;
+            }
+        }
+        if (topology->num_cpus > num_cpus) ++topology->num_nodes;
+    }
+    if (topology->num_cpus == 0) {
+        topology->cpus[0] = 0;
+        topology->nodes[0] = 0;
+        topology->num_cpus = topology->num_nodes = 1;
+    }
+    free(node_of_cpu);
+    return topology;
+}
+
+unsigned int Numa_cpu(const struct NumaTopology *topology,
+                      unsigned int index,
+                      unsigned int num_threads) {
+    if (num_threads <= topology->num_cpus) {
+        return topology->cpus[(unsigned long)index * topology->num_cpus
+                              / num_threads];
+    }
+    return topology->cpus[index % topology->num_cpus];
+}
+
+int Numa_node_of_cpu(const struct NumaTopology *topology, unsigned int cpu) {
+    for (unsigned int k = 0; k < topology->num_cpus; ++k) {
+        if (topology->cpus[k] == cpu) return topology->nodes[k];
+    }
+    return -1;
+}
+
+bool Numa_pin(unsigned int cpu) {
+    if (cpu >= CPU_SETSIZE) return false;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+}
+
+int Numa_node_of_address(const void *address) {
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0, address,
+                NUMA_MPOL_F_NODE | NUMA_MPOL_F_ADDR) != 0) {
+        return -1;
+    }
+    return node;
+}
+
+void Numa_set_huge_pages(bool huge_pages) {
+    Numa_use_huge_pages = huge_pages;
+}
+
+bool Numa_huge_pages() {
+    return Numa_use_huge_pages;
+}
+
+void *Numa_alloc(size_t alignment, size_t size) {
+    if (!Numa_use_huge_pages || size < NUMA_HUGE_PAGE_SIZE) {
+        return aligned_alloc(alignment, (size + alignment - 1)
+                                        / alignment * alignment);
+    }
+    // Whole huge pages, so that no other allocation shares them
+    size = (size + NUMA_HUGE_PAGE_SIZE - 1)
+         / NUMA_HUGE_PAGE_SIZE * NUMA_HUGE_PAGE_SIZE;
+    void *memory = aligned_alloc(NUMA_HUGE_PAGE_SIZE, size);
+    if (memory != NULL) madvise(memory, size, MADV_HUGEPAGE);
+    return memory;
+}
+
+void Numa_copy_band(void *target,
+                    const void *source,
+                    size_t num_rows,
+                    size_t row_size,
+                    unsigned int index,
+                    unsigned int num_bands) {
+    size_t first_row = num_rows * index / num_bands;
+    size_t last_row = num_rows * (index + 1) / num_bands;
+    memcpy((char*)target + first_row * row_size,
+           (const char*)source + first_row * row_size,
+           (last_row - first_row) * row_size);
+}
+
+long Numa_huge_pages_size() {
+    FILE *file = fopen("/proc/self/smaps_rollup", "r");
+    if (file == NULL) return -1;
+    char line[256];
+    long size = -1;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (sscanf(line, "AnonHugePages: %ld kB", &size) == 1) break;
+    }
+    fclose(file);
+    return size;
+}
+
+void Numa_free(struct NumaTopology *topology) {
+    free(topology->cpus);
+    free(topology->nodes);
+    free(topology);
+}
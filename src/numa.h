@@ -0,0 +1,150 @@
+/**
+ * Provides the placement of threads and memory on NUMA nodes.
+ *
+ * On a host with several sockets, each socket is a NUMA node with its own
+ * memory, which is slower to reach from the other nodes. The system places a
+ * page on the node of the thread that touches it first, so a grid should be
+ * first touched by the threads that update it, each pinned to a CPU so that
+ * it does not migrate to another node afterwards.
+ *
+ * The topology is read from `NUMA_NODE_DIRECTORY`, without any library, and
+ * is a single node if it is not available. The threads of a pool are spread
+ * evenly over the CPUs, grouped by node, so that consecutive threads, which
+ * update consecutive bands of rows, share a node.
+ *
+ * Large allocations can also be backed by transparent huge pages, which
+ * spare most of the misses of the TLB when streaming a large grid.
+ */
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define NUMA_NODE_DIRECTORY "/sys/devices/system/node"
+#define NUMA_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * The CPUs available to the process, grouped by NUMA node.
+ */
+struct NumaTopology {
+    unsigned int num_nodes;         /**< The number of nodes with CPUs */
+    unsigned int num_cpus;          /**< The number of available CPUs */
+    unsigned int *cpus;             /**< The CPUs, sorted by node */
+    unsigned int *nodes;            /**< The node of each CPU of `cpus` */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Reads the NUMA topology of the CPUs available to the process.
+ *
+ * @return  The topology, with at least one CPU
+ */
+struct NumaTopology *Numa_init();
+
+/**
+ * Returns the CPU of a thread, so that the threads are spread over the CPUs.
+ *
+ * @param topology     The topology
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ * @return             The CPU of the thread
+ */
+unsigned int Numa_cpu(const struct NumaTopology *topology,
+                      unsigned int index,
+                      unsigned int num_threads);
+
+/**
+ * Returns the NUMA node of a CPU.
+ *
+ * @param topology  The topology
+ * @param cpu       The CPU
+ * @return          Its node, or -1 if the CPU is not available
+ */
+int Numa_node_of_cpu(const struct NumaTopology *topology, unsigned int cpu);
+
+/**
+ * Pins the calling thread to a CPU.
+ *
+ * @param cpu  The CPU
+ * @return     True if and only if the thread is pinned
+ */
+bool Numa_pin(unsigned int cpu);
+
+/**
+ * Returns the NUMA node holding the page of an address.
+ *
+ * @param address  The address, in a page already touched
+ * @return         The node of the page, or -1 if it is unknown
+ */
+int Numa_node_of_address(const void *address);
+
+/**
+ * Sets whether large allocations are backed by transparent huge pages.
+ *
+ * @param huge_pages  True to request huge pages from `Numa_alloc`
+ */
+void Numa_set_huge_pages(bool huge_pages);
+
+/**
+ * Tells if large allocations are backed by transparent huge pages.
+ *
+ * @return  True if and only if huge pages are requested
+ */
+bool Numa_huge_pages();
+
+/**
+ * Allocates aligned memory, backed by huge pages if it is large enough and
+ * they are requested.
+ *
+ * The memory is not touched, so that its pages are placed by the threads
+ * first touching them. It is freed with `free`.
+ *
+ * @param alignment  The alignment, a power of 2
+ * @param size       The size
+ * @return           The allocated memory
+ */
+void *Numa_alloc(size_t alignment, size_t size);
+
+/**
+ * Copies a band of rows of a buffer into another one.
+ *
+ * The rows are split into `num_bands` bands as evenly as possible, so that
+ * each thread of a pool copying its band first touches it.
+ *
+ * @param target     The buffer to write
+ * @param source     The buffer to read
+ * @param num_rows   The number of rows of both buffers
+ * @param row_size   The size of a row
+ * @param index      The index of the band
+ * @param num_bands  The number of bands
+ */
+void Numa_copy_band(void *target,
+                    const void *source,
+                    size_t num_rows,
+                    size_t row_size,
+                    unsigned int index,
+                    unsigned int num_bands);
+
+/**
+ * Returns the amount of memory of the process backed by huge pages.
+ *
+ * @return  The amount of memory in kB, or -1 if it is unknown
+ */
+long Numa_huge_pages_size();
+
+/**
+ * Frees a topology.
+ *
+ * @param topology  The topology to free
+ */
+void Numa_free(struct NumaTopology *topology);
+
+#endif
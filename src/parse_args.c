@@ -8,8 +8,12 @@
 #include <string.h>
 #include <stdlib.h>
 #include <getopt.h>
+#include <errno.h>
 #include "parse_args.h"
 #include "utils.h"
+#include "ensemble.h"
+#include "plane.h"
+#include "random.h"
 
 #define DELIM ','
 #define DELIMS ","
@@ -42,6 +46,24 @@ enum Status cast_unsigned_integer(const char *s,
     }
 }
 
+/**
+ * Casts a string to a seed, i.e. an unsigned value of 64 bits.
+ *
+ * @param s      The string to cast
+ * @param value  The resulting value
+ * @return       The status of the cast
+ */
+enum Status cast_seed(const char *s,
+                      uint64_t *value) {
+    char *p;
+    if (*s == '\0' || *s == '-') return TP2_WRONG_SEED;
+    errno = 0;
+    unsigned long long seed = strtoull(s, &p, 10);
+    if (*p != '\0' || errno != 0) return TP2_WRONG_SEED;
+    *value = seed;
+    return TP2_OK;
+}
+
 /**
  * Retrives the type of simulation from a string.
  *
@@ -76,12 +98,98 @@ enum Status get_boundary(const char *s,
         arguments->boundary = CELLULAR_TRUNCATE;
     } else if (strcmp(s, BOUNDARY_PERIODIC) == 0) {
         arguments->boundary = CELLULAR_WRAP_AROUND;
+    } else if (strcmp(s, BOUNDARY_UNBOUNDED) == 0) {
+        arguments->boundary = CELLULAR_UNBOUNDED;
     } else {
         return TP2_WRONG_BOUNDARY;
     }
     return TP2_OK;
 }
 
+/**
+ * Retrives the rulestring from a string.
+ *
+ * @param s          The string from which the rulestring is retrieved
+ * @param arguments  The parsed arguments
+ * @return           The status of the extraction
+ */
+enum Status get_rule(const char *s,
+                     struct Arguments *arguments) {
+    struct Rule *rule = Rule_parse_life(s);
+    if (rule == NULL) return TP2_WRONG_RULE;
+    Rule_free(rule);
+    free(arguments->rule);
+    arguments->rule = strdupli(s);
+    return TP2_OK;
+}
+
+/**
+ * Tells if a valid rulestring keeps dead cells without live neighbors dead.
+ *
+ * @param rulestring  The rulestring
+ * @return            True if and only if the rule can run on a plane
+ */
+bool is_quiescent(const char *rulestring) {
+    struct Rule *rule = Rule_parse_life(rulestring);
+    bool is_quiescent = Plane_supports(rule);
+    Rule_free(rule);
+    return is_quiescent;
+}
+
+/**
+ * Retrives the engine from a string.
+ *
+ * @param s          The string from which the engine is retrieved
+ * @param arguments  The parsed arguments
+ * @return           The status of the extraction
+ */
+enum Status get_engine(const char *s,
+                       struct Arguments *arguments) {
+    if (strcmp(s, ENGINE_AUTO_NAME) == 0) {
+        arguments->engine = ENGINE_AUTO;
+    } else if (strcmp(s, ENGINE_GENERIC_NAME) == 0) {
+        arguments->engine = ENGINE_GENERIC;
+    } else if (strcmp(s, ENGINE_BITLIFE_NAME) == 0) {
+        arguments->engine = ENGINE_BITLIFE;
+    } else if (strcmp(s, ENGINE_TILED_NAME) == 0) {
+        arguments->engine = ENGINE_TILED;
+    } else if (strcmp(s, ENGINE_HASHLIFE_NAME) == 0) {
+        arguments->engine = ENGINE_HASHLIFE;
+    } else if (strcmp(s, ENGINE_SPARSE_NAME) == 0) {
+        arguments->engine = ENGINE_SPARSE;
+    } else if (strcmp(s, ENGINE_BLOCKED_NAME) == 0) {
+        arguments->engine = ENGINE_BLOCKED;
+    } else if (strcmp(s, ENGINE_PROCESSES_NAME) == 0) {
+        arguments->engine = ENGINE_PROCESSES;
+    } else if (strcmp(s, ENGINE_MEMOIZED_NAME) == 0) {
+        arguments->engine = ENGINE_MEMOIZED;
+    } else if (strcmp(s, ENGINE_FRONTIER_NAME) == 0) {
+        arguments->engine = ENGINE_FRONTIER;
+    } else {
+        return TP2_WRONG_ENGINE;
+    }
+    return TP2_OK;
+}
+
+/**
+ * Retrives the layout from a string.
+ *
+ * @param s          The string from which the layout is retrieved
+ * @param arguments  The parsed arguments
+ * @return           The status of the extraction
+ */
+enum Status get_layout(const char *s,
+                       struct Arguments *arguments) {
+    if (strcmp(s, LAYOUT_ROW_MAJOR) == 0) {
+        arguments->layout = CELLULAR_ROW_MAJOR;
+    } else if (strcmp(s, LAYOUT_MORTON) == 0) {
+        arguments->layout = CELLULAR_MORTON;
+    } else {
+        return TP2_WRONG_LAYOUT;
+    }
+    return TP2_OK;
+}
+
 /**
  * Retrives the allowed cells from a string.
  *
@@ -139,7 +247,22 @@ void set_default(struct Arguments *arguments) {
 
 void print_usage(char **argv) {
     printf(USAGE, argv[0], GOF_TYPE, PANDEMY_TYPE, FIRE_TYPE, DEFAULT_TYPE,
-           BOUNDARY_TRUNCATE, BOUNDARY_PERIODIC, DEFAULT_BOUNDARY);
+           GOF_TYPE, CELLULAR_GAME_OF_LIFE_RULESTRING,
+           BOUNDARY_TRUNCATE, BOUNDARY_PERIODIC, BOUNDARY_UNBOUNDED,
+           BOUNDARY_UNBOUNDED, ENGINE_SPARSE_NAME, DEFAULT_BOUNDARY,
+           ENGINE_AUTO_NAME, ENGINE_GENERIC_NAME, ENGINE_BITLIFE_NAME,
+           ENGINE_TILED_NAME, ENGINE_HASHLIFE_NAME, ENGINE_SPARSE_NAME,
+           ENGINE_BLOCKED_NAME, ENGINE_PROCESSES_NAME, ENGINE_MEMOIZED_NAME,
+           ENGINE_FRONTIER_NAME, ENGINE_BITLIFE_NAME, GOF_TYPE,
+           ENGINE_TILED_NAME, ENGINE_HASHLIFE_NAME, GOF_TYPE,
+           BOUNDARY_PERIODIC, ENGINE_SPARSE_NAME, BOUNDARY_UNBOUNDED,
+           FIRE_TYPE, ENGINE_BLOCKED_NAME, ENGINE_PROCESSES_NAME,
+           ENGINE_MEMOIZED_NAME, ENGINE_FRONTIER_NAME, FIRE_TYPE,
+           DEFAULT_ENGINE, ENGINE_PROCESSES_NAME, ENGINE_BLOCKED_NAME,
+           BLOCKING_MAX_DEPTH, BLOCK_DEPTH_DEFAULT,
+           LAYOUT_ROW_MAJOR, LAYOUT_MORTON, CELLULAR_MORTON_TILE_SIZE,
+           CELLULAR_MORTON_TILE_SIZE, DEFAULT_LAYOUT, BOUNDARY_UNBOUNDED,
+           ENSEMBLE_WORD_SIZE, BOUNDARY_UNBOUNDED);
 }
 
 struct Arguments *parse_arguments(int argc, char *argv[]) {
@@ -154,14 +277,30 @@ struct Arguments *parse_arguments(int argc, char *argv[]) {
 
     // Default argument
     arguments->interactive = false;
+    arguments->stats = false;
+    arguments->numa = false;
+    arguments->huge_pages = false;
     arguments->status = TP2_OK;
     arguments->num_rows = NUM_ROWS_DEFAULT;
     arguments->num_cols = NUM_COLS_DEFAULT;
     arguments->num_steps = NUM_STEPS_DEFAULT;
+    arguments->num_threads = NUM_THREADS_DEFAULT;
+    arguments->block_depth = BLOCK_DEPTH_DEFAULT;
+    arguments->num_members = 0;
+    arguments->has_seed = false;
+    arguments->seed = 0;
+    arguments->final_grids = false;
+    arguments->print_every = 1;
+    arguments->final_only = false;
+    arguments->skip_to = 0;
     arguments->type = -1;
     get_boundary(DEFAULT_BOUNDARY, arguments);
+    get_engine(DEFAULT_ENGINE, arguments);
+    get_layout(DEFAULT_LAYOUT, arguments);
+    arguments->rule = NULL;
     arguments->allowed_cells = NULL;
     arguments->distribution = NULL;
+    arguments->mapped_directory = NULL;
     arguments->initialState=false; // by default, there is no initial state to read
 
     // Resets index
@@ -171,21 +310,36 @@ struct Arguments *parse_arguments(int argc, char *argv[]) {
         {"help",            no_argument,       0, 'h'},
         {"interactive",     no_argument,       0, 'i'},
         {"stdin",           no_argument,       0, 's'},//new long option
+        {"stats",           no_argument,       0, 'S'},
+        {"numa",            no_argument,       0, 'N'},
+        {"huge-pages",      no_argument,       0, 'H'},
+        {"final-grids",     no_argument,       0, 'F'},
+        {"final-only",      no_argument,       0, 'f'},
         // Don't set flag
         {"num-rows",        required_argument, 0, 'r'},
         {"num-cols",        required_argument, 0, 'c'},
         {"num-steps",       required_argument, 0, 'n'},
         {"type",            required_argument, 0, 't'},
+        {"rule",            required_argument, 0, 'R'},
         {"boundary",        required_argument, 0, 'b'},
         {"allowed-cells",   required_argument, 0, 'a'},
         {"distribution",    required_argument, 0, 'd'},
+        {"engine",          required_argument, 0, 'e'},
+        {"threads",         required_argument, 0, 'j'},
+        {"block-depth",     required_argument, 0, 'k'},
+        {"layout",          required_argument, 0, 'L'},
+        {"mapped",          required_argument, 0, 'm'},
+        {"ensemble",        required_argument, 0, 'E'},
+        {"seed",            required_argument, 0, 'z'},
+        {"print-every",     required_argument, 0, 'p'},
+        {"skip-to",         required_argument, 0, 'J'},
         {0, 0, 0, 0}
     };
 
     // Parse options
     while (true) {
         int option_index = 0;
-        int c = getopt_long(argc, argv, "hir:c:n:t:b:a:d:s:",
+        int c = getopt_long(argc, argv, "hiSNHFfr:c:n:t:R:b:a:d:s:e:j:k:L:m:E:z:p:J:",
                             long_opts, &option_index);
         if (c == -1) break;
         switch (c) {
@@ -195,6 +349,16 @@ struct Arguments *parse_arguments(int argc, char *argv[]) {
                       break;
             case 'i': arguments->interactive = true;
                       break;
+            case 'S': arguments->stats = true;
+                      break;
+            case 'N': arguments->numa = true;
+                      break;
+            case 'H': arguments->huge_pages = true;
+                      break;
+            case 'F': arguments->final_grids = true;
+                      break;
+            case 'f': arguments->final_only = true;
+                      break;
             case 'r': if (arguments->status == TP2_OK) {
                           arguments->status =
                               cast_unsigned_integer(optarg,
@@ -215,6 +379,27 @@ struct Arguments *parse_arguments(int argc, char *argv[]) {
                                                     &arguments->num_steps);
                       }
                       break;
+            case 'j': if (arguments->status == TP2_OK) {
+                          arguments->status =
+                              cast_unsigned_integer(optarg,
+                                                    &arguments->num_threads);
+                          if (arguments->status != TP2_OK ||
+                              arguments->num_threads == 0) {
+                              arguments->status = TP2_WRONG_NUM_THREADS;
+                          }
+                      }
+                      break;
+            case 'k': if (arguments->status == TP2_OK) {
+                          arguments->status =
+                              cast_unsigned_integer(optarg,
+                                                    &arguments->block_depth);
+                          if (arguments->status != TP2_OK ||
+                              arguments->block_depth == 0 ||
+                              arguments->block_depth > BLOCKING_MAX_DEPTH) {
+                              arguments->status = TP2_WRONG_BLOCK_DEPTH;
+                          }
+                      }
+                      break;
             case 't': if (arguments->status == TP2_OK) {
                           use_default = false;
                           type_set = true;
@@ -222,6 +407,11 @@ struct Arguments *parse_arguments(int argc, char *argv[]) {
                               get_type(optarg, arguments);
                       }
                       break;
+            case 'R': if (arguments->status == TP2_OK) {
+                          arguments->status =
+                              get_rule(optarg, arguments);
+                      }
+                      break;
             case 'b': if (arguments->status == TP2_OK) {
                           arguments->status =
                               get_boundary(optarg, arguments);
@@ -239,6 +429,54 @@ struct Arguments *parse_arguments(int argc, char *argv[]) {
                               get_distribution(optarg, arguments);
                       }
                       break;
+            case 'e': if (arguments->status == TP2_OK) {
+                          arguments->status =
+                              get_engine(optarg, arguments);
+                      }
+                      break;
+            case 'L': if (arguments->status == TP2_OK) {
+                          arguments->status =
+                              get_layout(optarg, arguments);
+                      }
+                      break;
+            case 'E': if (arguments->status == TP2_OK) {
+                          arguments->status =
+                              cast_unsigned_integer(optarg,
+                                                    &arguments->num_members);
+                          if (arguments->status != TP2_OK ||
+                              arguments->num_members == 0) {
+                              arguments->status = TP2_WRONG_NUM_MEMBERS;
+                          }
+                      }
+                      break;
+            case 'z': if (arguments->status == TP2_OK) {
+                          arguments->status =
+                              cast_seed(optarg, &arguments->seed);
+                          arguments->has_seed = true;
+                      }
+                      break;
+            case 'p': if (arguments->status == TP2_OK) {
+                          arguments->status =
+                              cast_unsigned_integer(optarg,
+                                                    &arguments->print_every);
+                          if (arguments->status != TP2_OK ||
+                              arguments->print_every == 0) {
+                              arguments->status = TP2_WRONG_PRINT_EVERY;
+                          }
+                      }
+                      break;
+            case 'J': if (arguments->status == TP2_OK) {
+                          arguments->status =
+                              cast_unsigned_integer(optarg,
+                                                    &arguments->skip_to);
+                          if (arguments->status != TP2_OK) {
+                              arguments->status = TP2_WRONG_SKIP_TO;
+                          }
+                      }
+                      break;
+            case 'm': free(arguments->mapped_directory);
+                      arguments->mapped_directory = strdupli(optarg);
+                      break;
             case '?': if (arguments->status == TP2_OK) {
                           arguments->status = TP2_BAD_OPTION;
                       }
@@ -252,6 +490,14 @@ struct Arguments *parse_arguments(int argc, char *argv[]) {
     if (arguments->distribution == NULL) {
         get_distribution(DEFAULT_DISTRIBUTION, arguments);
     }
+    if (!arguments->has_seed) {
+        arguments->seed = Random_time_seed();
+    }
+    // Known once every option is parsed, the last step must be printed
+    if (arguments->status == TP2_OK && arguments->skip_to > 0 &&
+        arguments->skip_to >= arguments->num_steps) {
+        arguments->status = TP2_WRONG_SKIP_TO;
+    }
     if (optind < argc) {
         printf("Error: too many arguments\n");
         print_usage(argv);
@@ -267,10 +513,44 @@ struct Arguments *parse_arguments(int argc, char *argv[]) {
         printf("Error: unrecognized boundary.\n");
         printf("The supported boundaries are %s\n", SUPPORTED_BOUNDARIES);
         print_usage(argv);
+    } else if (arguments->status == TP2_WRONG_RULE) {
+        printf("Error: the rule must be a rulestring \"B<digits>/S<digits>\""\
+               ", whose digits are between 0 and 8.\n");
+        print_usage(argv);
+    } else if (arguments->status == TP2_WRONG_ENGINE) {
+        printf("Error: unrecognized engine.\n");
+        printf("The supported engines are %s\n", SUPPORTED_ENGINES);
+        print_usage(argv);
+    } else if (arguments->status == TP2_WRONG_LAYOUT) {
+        printf("Error: unrecognized layout.\n");
+        printf("The supported layouts are %s\n", SUPPORTED_LAYOUTS);
+        print_usage(argv);
     } else if (arguments->status == TP2_WRONG_VALUE) {
         printf("Error: the number of rows, columns and steps must be "\
                "positive integers.\n");
         print_usage(argv);
+    } else if (arguments->status == TP2_WRONG_NUM_THREADS) {
+        printf("Error: the number of threads must be a positive integer.\n");
+        print_usage(argv);
+    } else if (arguments->status == TP2_WRONG_NUM_MEMBERS) {
+        printf("Error: the number of grids of an ensemble must be a positive "\
+               "integer.\n");
+        print_usage(argv);
+    } else if (arguments->status == TP2_WRONG_SEED) {
+        printf("Error: the seed must be an unsigned integer of 64 bits.\n");
+        print_usage(argv);
+    } else if (arguments->status == TP2_WRONG_PRINT_EVERY) {
+        printf("Error: the period of the printed steps must be a positive "\
+               "integer.\n");
+        print_usage(argv);
+    } else if (arguments->status == TP2_WRONG_SKIP_TO) {
+        printf("Error: the number of skipped steps must be an integer lower "\
+               "than the number of steps.\n");
+        print_usage(argv);
+    } else if (arguments->status == TP2_WRONG_BLOCK_DEPTH) {
+        printf("Error: the block depth must be an integer between 1 and "\
+               "%d.\n", BLOCKING_MAX_DEPTH);
+        print_usage(argv);
     } else if (arguments->status == TP2_WRONG_DISTRIBUTION) {
         printf("Error: the distribution must be a list of comma-separated "\
                "positive integers.\n");
@@ -284,6 +564,51 @@ struct Arguments *parse_arguments(int argc, char *argv[]) {
         printf("Error: The simulation and the allowed cells are inconsistent.\n");
         arguments->status = TP2_INCONSISTENT_ARGS;
         print_usage(argv);
+    } else if (arguments->rule != NULL &&
+               arguments->type != CELLULAR_GAME_OF_LIFE) {
+        printf("Error: A rule can only be set for the type \"%s\".\n",
+               GOF_TYPE);
+        arguments->status = TP2_INCONSISTENT_ARGS;
+        print_usage(argv);
+    } else if (arguments->mapped_directory != NULL &&
+               (arguments->interactive || arguments->initialState ||
+                arguments->boundary == CELLULAR_UNBOUNDED)) {
+        printf("Error: Mapped grids cannot be interactive, read from stdin "\
+               "or unbounded.\n");
+        arguments->status = TP2_INCONSISTENT_ARGS;
+        print_usage(argv);
+    } else if (arguments->num_members > 0 &&
+               (arguments->mapped_directory != NULL ||
+                arguments->boundary == CELLULAR_UNBOUNDED ||
+                arguments->interactive || arguments->initialState)) {
+        printf("Error: An ensemble cannot be mapped, unbounded, interactive "\
+               "or read from stdin.\n");
+        arguments->status = TP2_INCONSISTENT_ARGS;
+        print_usage(argv);
+    } else if (arguments->final_grids && arguments->num_members == 0) {
+        printf("Error: Only the grids of an ensemble can be printed at the "\
+               "last step.\n");
+        arguments->status = TP2_INCONSISTENT_ARGS;
+        print_usage(argv);
+    } else if (arguments->interactive &&
+               (arguments->print_every > 1 || arguments->final_only ||
+                arguments->skip_to > 0)) {
+        printf("Error: An interactive simulation prints every step.\n");
+        arguments->status = TP2_INCONSISTENT_ARGS;
+        print_usage(argv);
+    } else if (arguments->mapped_directory == NULL &&
+               !Engine_supports(arguments->engine, arguments->type,
+                                arguments->boundary)) {
+        printf("Error: The engine does not support the simulation type "\
+               "or boundary.\n");
+        arguments->status = TP2_INCONSISTENT_ARGS;
+        print_usage(argv);
+    } else if (arguments->boundary == CELLULAR_UNBOUNDED &&
+               arguments->rule != NULL && !is_quiescent(arguments->rule)) {
+        printf("Error: With the boundary \"%s\", a dead cell without live "\
+               "neighbors cannot be born (B0).\n", BOUNDARY_UNBOUNDED);
+        arguments->status = TP2_INCONSISTENT_ARGS;
+        print_usage(argv);
     }
     // if a gutstum initial state and num_row/col is selected, then there is an error.
     if (arguments->initialState && row_or_column_set ) {
@@ -294,20 +619,54 @@ struct Arguments *parse_arguments(int argc, char *argv[]) {
     return arguments;
 }
 
+unsigned int next_printed_step(const struct Arguments *arguments,
+                               unsigned int step) {
+    unsigned int num_steps = arguments->num_steps;
+    if (step >= num_steps) {
+        return num_steps;
+    } else if (arguments->final_only) {
+        return num_steps - 1;
+    } else if (step <= arguments->skip_to) {
+        return min(arguments->skip_to, num_steps);
+    }
+    // Rounded up to the next multiple of the period after `skip_to`
+    unsigned long period = arguments->print_every;
+    unsigned long next = arguments->skip_to
+                       + (step - arguments->skip_to + period - 1)
+                       / period * period;
+    return next < num_steps ? next : num_steps;
+}
+
 void print_arguments(const struct Arguments *arguments) {
     printf("struct Arguments {\n");
     printf("  num_rows     = %d\n", arguments->num_rows);
     printf("  num_cols     = %d\n", arguments->num_cols);
     printf("  num_steps    = %d\n", arguments->num_steps);
+    printf("  num_threads  = %d\n", arguments->num_threads);
+    printf("  block_depth  = %d\n", arguments->block_depth);
     printf("  type         = %d\n", arguments->type);
     printf("  boundary     = %d\n", arguments->boundary);
+    printf("  layout       = %d\n", arguments->layout);
+    printf("  mapped       = %s\n", arguments->mapped_directory != NULL ?
+                                     arguments->mapped_directory : "no");
+    printf("  ensemble     = %d\n", arguments->num_members);
+    printf("  seed         = %llu%s\n", (unsigned long long)arguments->seed,
+           arguments->has_seed ? "" : " (random)");
+    printf("  final grids  ? %s\n", arguments->final_grids ? "yes" : "no");
+    printf("  print every  = %d\n", arguments->print_every);
+    printf("  final only   ? %s\n", arguments->final_only ? "yes" : "no");
+    printf("  skip to      = %d\n", arguments->skip_to);
     printf("  cells        = %s\n", arguments->allowed_cells);
     printf("  num_cells    = %d\n", arguments->num_cells);
     printf("  distribution =");
     for (unsigned int i = 0; i < arguments->num_cells; ++i)
         printf(" %d", arguments->distribution[i]);
     printf("\n");
+    printf("  rule         = %s\n",
+           arguments->rule != NULL ? arguments->rule : "default");
+    printf("  engine       = %d\n", arguments->engine);
     printf("  interactive  ? %s\n", arguments->interactive ? "yes" : "no");
+    printf("  stats        ? %s\n", arguments->stats ? "yes" : "no");
     printf("  status       = %d\n", arguments->status);
     printf("}\n");
 }
@@ -315,5 +674,7 @@ void print_arguments(const struct Arguments *arguments) {
 void free_arguments(struct Arguments *arguments) {
     free(arguments->allowed_cells);
     free(arguments->distribution);
+    free(arguments->rule);
+    free(arguments->mapped_directory);
     free(arguments);
 }
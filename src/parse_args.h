@@ -8,7 +8,9 @@
 #define PARSE_ARGS_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "cellular.h"
+#include "engine.h"
 
 #define GOF_TYPE "game-of-life"
 #define PANDEMY_TYPE "pandemy"
@@ -17,20 +19,48 @@
     FIRE_TYPE "\""
 #define BOUNDARY_PERIODIC "periodic"
 #define BOUNDARY_TRUNCATE "truncate"
-#define SUPPORTED_BOUNDARIES "\"" BOUNDARY_TRUNCATE "\" and \""\
-    BOUNDARY_PERIODIC "\""
+#define BOUNDARY_UNBOUNDED "unbounded"
+#define SUPPORTED_BOUNDARIES "\"" BOUNDARY_TRUNCATE "\", \"" BOUNDARY_PERIODIC\
+    "\" and \"" BOUNDARY_UNBOUNDED "\""
+#define ENGINE_AUTO_NAME "auto"
+#define ENGINE_GENERIC_NAME "generic"
+#define ENGINE_BITLIFE_NAME "bitlife"
+#define ENGINE_TILED_NAME "tiled"
+#define ENGINE_HASHLIFE_NAME "hashlife"
+#define ENGINE_SPARSE_NAME "sparse"
+#define ENGINE_BLOCKED_NAME "blocked"
+#define ENGINE_PROCESSES_NAME "processes"
+#define ENGINE_MEMOIZED_NAME "memoized"
+#define ENGINE_FRONTIER_NAME "frontier"
+#define SUPPORTED_ENGINES "\"" ENGINE_AUTO_NAME "\", \"" ENGINE_GENERIC_NAME\
+    "\", \"" ENGINE_BITLIFE_NAME "\", \"" ENGINE_TILED_NAME "\", \""\
+    ENGINE_HASHLIFE_NAME "\", \"" ENGINE_SPARSE_NAME "\", \""\
+    ENGINE_BLOCKED_NAME "\", \"" ENGINE_PROCESSES_NAME "\", \""\
+    ENGINE_MEMOIZED_NAME "\" and \"" ENGINE_FRONTIER_NAME "\""
+#define LAYOUT_ROW_MAJOR "row-major"
+#define LAYOUT_MORTON "morton"
+#define SUPPORTED_LAYOUTS "\"" LAYOUT_ROW_MAJOR "\" and \"" LAYOUT_MORTON "\""
 #define DEFAULT_TYPE GOF_TYPE
 #define DEFAULT_BOUNDARY BOUNDARY_TRUNCATE
+#define DEFAULT_ENGINE ENGINE_AUTO_NAME
+#define DEFAULT_LAYOUT LAYOUT_ROW_MAJOR
 #define DEFAULT_CELLS ".X"
 #define DEFAULT_DISTRIBUTION "5,1,1,1"
 #define NUM_ROWS_DEFAULT 5
 #define NUM_COLS_DEFAULT 5
 #define NUM_STEPS_DEFAULT 5
+#define NUM_THREADS_DEFAULT 1
+#define BLOCK_DEPTH_DEFAULT BLOCKING_DEFAULT_DEPTH
 
 #define USAGE "\
 Usage: %s [-h|--help] [-r|--num-rows VALUE] [-c|--num-cols VALUE]\n\
     [-n|--num_steps VALUE] [-t|--type STRING] [-a|--allowed-cells STRING]\n\
     [-d|--distribution VALUES] [-i|--interactive] [-s|--stdin]\n\
+    [-e|--engine STRING] [-R|--rule STRING] [-j|--threads VALUE]\n\
+    [-S|--stats] [-k|--block-depth VALUE] [-L|--layout STRING]\n\
+    [-m|--mapped DIRECTORY] [-N|--numa] [-H|--huge-pages]\n\
+    [-E|--ensemble VALUE] [-z|--seed VALUE] [-F|--final-grids]\n\
+    [-p|--print-every VALUE] [-f|--final-only] [-J|--skip-to VALUE]\n\
 \n\
 Simulates a cellular automaton.\n\
 \n\
@@ -46,9 +76,18 @@ Optional arguments:\n\
                               Currently, there are 3 supported types:\n\
                               \"%s\", \"%s\" and \"%s\".\n\
                               The default type is \"%s\".\n\
+  -R, --rule STRING           The rule of a \"%s\" simulation,\n\
+                              as a rulestring \"B<digits>/S<digits>\":\n\
+                              a dead cell is born if its number of live\n\
+                              neighbors is a digit after B, and a live\n\
+                              cell survives if it is a digit after S.\n\
+                              The default rule is \"%s\".\n\
   -b, --boundary STRING       The boundary type.\n\
-                              Currently, there are 2 supported types:\n\
-                              \"%s\" and \"%s\".\n\
+                              Currently, there are 3 supported types:\n\
+                              \"%s\", \"%s\" and \"%s\".\n\
+                              With \"%s\", the grid is a window\n\
+                              on an infinite plane, which requires\n\
+                              the engine \"%s\".\n\
                               The default boundary is \"%s\".\n\
   -a, --allowed-cells STRING  The allowed cells, as characters.\n\
                               The number of cells must be consistent\n\
@@ -60,6 +99,89 @@ Optional arguments:\n\
                               will appear twice as more as 'a' and 'b'.\n\
   -i, --interactive           Enables interactive simulation.\n\
   -s, --stdin                 Reads from file the initial state of the automaton.\n\
+  -e, --engine STRING         The engine computing the simulation.\n\
+                              Currently, there are 10 supported engines:\n\
+                              \"%s\", \"%s\", \"%s\", \"%s\",\n\
+                              \"%s\", \"%s\", \"%s\", \"%s\",\n\
+                              \"%s\" and \"%s\".\n\
+                              The engine \"%s\" only supports\n\
+                              the type \"%s\". The engine \"%s\"\n\
+                              only updates the regions that changed.\n\
+                              The engine \"%s\" only supports\n\
+                              the type \"%s\" with boundary \"%s\",\n\
+                              and jumps over many steps at once.\n\
+                              The engine \"%s\" only supports\n\
+                              the boundary \"%s\", except with\n\
+                              the type \"%s\". The engine \"%s\"\n\
+                              computes several steps per pass over\n\
+                              each tile, while it stays in the cache.\n\
+                              The engine \"%s\" splits the grid\n\
+                              between worker processes exchanging\n\
+                              their border rows in shared memory.\n\
+                              The engine \"%s\" caches the next\n\
+                              states of small tiles, which it reuses\n\
+                              for the repeated tiles. The engine\n\
+                              \"%s\" only supports the type \"%s\",\n\
+                              and only looks at the neighbors of\n\
+                              the burning cells.\n\
+                              The default engine is \"%s\", which selects\n\
+                              the fastest engine for the type.\n\
+  -j, --threads VALUE         The number of threads computing each step,\n\
+                              or of worker processes with the engine\n\
+                              \"%s\".\n\
+                              The default value is 1.\n\
+  -S, --stats                 Prints on stderr the fraction of the tiles\n\
+                              updated by each step, the hit rate of\n\
+                              the caches, and the placement of the\n\
+                              threads and of their rows.\n\
+  -k, --block-depth VALUE     The number of steps of each pass of the\n\
+                              engine \"%s\", between 1 and %d.\n\
+                              The default value is %d.\n\
+  -L, --layout STRING         The layout of the cells in memory.\n\
+                              Currently, there are 2 supported layouts:\n\
+                              \"%s\" and \"%s\", which stores\n\
+                              the grid in tiles of %d x %d cells\n\
+                              along a Z-order curve.\n\
+                              The default layout is \"%s\".\n\
+  -m, --mapped DIRECTORY      Stores the current and next grids in files\n\
+                              of the directory, mapped in memory, so that\n\
+                              the grid does not need to fit in memory.\n\
+                              The files are removed at once. The engine\n\
+                              and the layout are then ignored, and the\n\
+                              boundary cannot be \"%s\".\n\
+  -N, --numa                  Pins each thread to a CPU, spreading them\n\
+                              over the NUMA nodes, and places its rows\n\
+                              on its node.\n\
+  -H, --huge-pages            Backs the large grids by transparent huge\n\
+                              pages.\n\
+  -E, --ensemble VALUE        The number of random grids stepped\n\
+                              together, bit-sliced, the same cell of\n\
+                              %d grids being held in a word. The\n\
+                              simulation then prints, at each step, the\n\
+                              mean, the extremes and the quartiles of\n\
+                              the number of cells in each state over\n\
+                              the grids, instead of the grids, while\n\
+                              the benchmark only measures the cells\n\
+                              updated per second. The engine and the\n\
+                              layout are then ignored, and the\n\
+                              boundary cannot be \"%s\".\n\
+  -z, --seed VALUE            The seed of the random grids, from which\n\
+                              the same grids are drawn again, whatever\n\
+                              the number of threads drawing them.\n\
+                              By default, the seed changes from one run\n\
+                              to another, and is printed by an ensemble\n\
+                              and on stderr with the option -S.\n\
+  -F, --final-grids           Prints the grids of an ensemble at the\n\
+                              last step, after the statistics.\n\
+  -p, --print-every VALUE     Prints only one step out of VALUE, the\n\
+                              steps in between being computed at once\n\
+                              by the engine without being formatted.\n\
+                              The default value is 1.\n\
+  -f, --final-only            Prints only the last step.\n\
+  -J, --skip-to VALUE         Computes the first VALUE steps without\n\
+                              printing them, VALUE being lower than\n\
+                              the number of steps.\n\
+                              The default value is 0.\n\
 "
 
 /**
@@ -74,7 +196,19 @@ enum Status {
     TP2_ERROR_TOO_MANY_ARGUMENTS,   /**< Too many arguments */
     TP2_INCONSISTENT_ARGS,          /**< Some arguments are inconsistent */
     TP2_BAD_OPTION,                  /**< Bad option */
-    TP2_ERROR_STDIN_WITH_ROW_COL     /**< rows and columns cannot be indicated together with stdin */
+    TP2_ERROR_STDIN_WITH_ROW_COL,    /**< rows and columns cannot be indicated together with stdin */
+    TP2_INVALID_CELL,               /**< A cell of the initial state is not allowed */
+    TP2_INCONSISTENT_LENGTHS,       /**< The rows of the initial state differ in length */
+    TP2_WRONG_ENGINE,               /**< Wrong engine */
+    TP2_WRONG_RULE,                 /**< Wrong rulestring */
+    TP2_WRONG_NUM_THREADS,          /**< Wrong number of threads */
+    TP2_WRONG_BLOCK_DEPTH,          /**< Wrong block depth */
+    TP2_WRONG_LAYOUT,               /**< Wrong layout */
+    TP2_WRONG_DIRECTORY,            /**< The grids cannot be mapped */
+    TP2_WRONG_NUM_MEMBERS,          /**< Wrong number of members */
+    TP2_WRONG_SEED,                 /**< Wrong seed */
+    TP2_WRONG_PRINT_EVERY,          /**< Wrong period of the printed steps */
+    TP2_WRONG_SKIP_TO               /**< Wrong number of skipped steps */
 
 };
 
@@ -85,6 +219,8 @@ struct Arguments {
     unsigned int num_rows;          /**< Number of rows */
     unsigned int num_cols;          /**< Number of columns */
     unsigned int num_steps;         /**< Number of steps in the simulation */
+    unsigned int num_threads;       /**< Number of threads */
+    unsigned int block_depth;       /**< Number of steps per blocked pass */
     enum CellularType type;         /**< The type of cellular automaton */
     enum CellularBoundary boundary; /**< The behavior on the boundaries */
     char *allowed_cells;            /**< The allowed cells */
@@ -93,6 +229,20 @@ struct Arguments {
     bool interactive;               /**< Is the simulation interactive? */
     enum Status status;             /**< The status of the parsing */
     bool initialState;              /**< If there is an initial state to read*/
+    enum EngineType engine;         /**< The engine computing the simulation */
+    char *rule;                     /**< The rulestring, if not the default */
+    bool stats;                     /**< Are the step statistics printed? */
+    enum CellularLayout layout;     /**< The layout of the cells in memory */
+    char *mapped_directory;         /**< The directory of the mapped grids */
+    bool numa;                      /**< Are the threads and rows placed? */
+    bool huge_pages;                /**< Are huge pages requested? */
+    unsigned int num_members;       /**< Number of grids of an ensemble */
+    bool has_seed;                  /**< Is the seed given by the user? */
+    uint64_t seed;                  /**< The seed of the random grids */
+    bool final_grids;               /**< Are the final grids printed? */
+    unsigned int print_every;       /**< Period of the printed steps */
+    bool final_only;                /**< Is only the last step printed? */
+    unsigned int skip_to;           /**< First step that may be printed */
 };
 
 /**
@@ -111,6 +261,20 @@ void print_usage(char **argv);
  */
 struct Arguments *parse_arguments(int argc, char **argv);
 
+/**
+ * Returns the first step printed from a given step on.
+ *
+ * The printed steps are the last one if only the final step is printed, and
+ * otherwise one step out of `print_every` from `skip_to` on.
+ *
+ * @param arguments  The parsed arguments
+ * @param step       The step
+ * @return           The first printed step not before `step`, or `num_steps`
+ *                   if there is none
+ */
+unsigned int next_printed_step(const struct Arguments *arguments,
+                               unsigned int step);
+
 /**
  * Prints the parsed arguments to stdout.
  *
@@ -0,0 +1,316 @@
+/**
+ * Implements plane.h.
+ */
+#include "plane.h"
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+
+#define PLANE_MIN_NUM_BUCKETS 64
+#define PLANE_PADDED_SIZE (PLANE_CHUNK_SIZE + 2)
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Returns the chunk coordinate of a cell coordinate, rounding down.
+ *
+ * @param x  The row or column of a cell
+ * @return   The row or column of its chunk
+ */
+static inline int64_t Plane_chunk_of(int64_t x) {
+    return x >= 0 ? x / PLANE_CHUNK_SIZE
+                  : -((-x + PLANE_CHUNK_SIZE - 1) / PLANE_CHUNK_SIZE);
+}
+
+/**
+ * Returns the bucket of a chunk.
+ *
+ * @param plane  The plane
+ * @param row    The row of the chunk
+ * @param col    The column of the chunk
+ * @return       The index of its bucket
+ */
+static inline size_t Plane_bucket(const struct Plane *plane,
+                                  int64_t row,
+                                  int64_t col) {
+    uint64_t hash = (uint64_t)row * 0x9e3779b97f4a7c15ull
+                  ^ (uint64_t)col * 0xc2b2ae3d27d4eb4full;
+    hash ^= hash >> 32;
+    return hash & (plane->num_buckets - 1);
+}
+
+/**
+ * Returns a chunk of a plane.
+ *
+ * @param plane  The plane
+ * @param row    The row of the chunk
+ * @param col    The column of the chunk
+ * @return       The chunk, or NULL if it is not allocated
+ */
+struct PlaneChunk *Plane_find(const struct Plane *plane,
+                              int64_t row,
+                              int64_t col) {
+    struct PlaneChunk *chunk = plane->buckets[Plane_bucket(plane, row, col)];
+    while (chunk != NULL && (chunk->row != row || chunk->col != col)) {
+        chunk = chunk->next_in_bucket;
+    }
+    return chunk;
+}
+
+/**
+ * Doubles the number of buckets of a plane.
+ *
+ * @param plane  The plane
+ */
+void Plane_grow_buckets(struct Plane *plane) {
+    free(plane->buckets);
+    plane->num_buckets *= 2;
+    plane->buckets = calloc(plane->num_buckets, sizeof(struct PlaneChunk *));
+    for (size_t k = 0; k < plane->num_chunks; ++k) {
+        struct PlaneChunk *chunk = plane->chunks[k];
+        size_t bucket = Plane_bucket(plane, chunk->row, chunk->col);
+        chunk->next_in_bucket = plane->buckets[bucket];
+        plane->buckets[bucket] = chunk;
+    }
+}
+
+/**
+ * Returns a chunk of a plane, allocating it with state 0 if needed.
+ *
+ * @param plane  The plane
+ * @param row    The row of the chunk
+ * @param col    The column of the chunk
+ * @return       The chunk
+ */
+struct PlaneChunk *Plane_ensure(struct Plane *plane, int64_t row, int64_t col) {
+    struct PlaneChunk *chunk = Plane_find(plane, row, col);
+    if (chunk != NULL) return chunk;
+    chunk = malloc(sizeof(struct PlaneChunk));
+    chunk->row = row;
+    chunk->col = col;
+    chunk->cells = calloc(PLANE_CHUNK_SIZE * PLANE_CHUNK_SIZE, 1);
+    chunk->next = calloc(PLANE_CHUNK_SIZE * PLANE_CHUNK_SIZE, 1);
+    if (plane->num_chunks == plane->capacity) {
+        plane->capacity *= 2;
+        plane->chunks = realloc(plane->chunks,
+                                plane->capacity * sizeof(struct PlaneChunk *));
+    }
+    chunk->index = plane->num_chunks;
+    plane->chunks[plane->num_chunks++] = chunk;
+    if (plane->num_chunks > plane->num_buckets) {
+        Plane_grow_buckets(plane);
+    } else {
+        size_t bucket = Plane_bucket(plane, row, col);
+        chunk->next_in_bucket = plane->buckets[bucket];
+        plane->buckets[bucket] = chunk;
+    }
+    return chunk;
+}
+
+/**
+ * Frees a chunk of a plane.
+ *
+ * @param plane  The plane
+ * @param chunk  The chunk
+ */
+void Plane_remove(struct Plane *plane, struct PlaneChunk *chunk) {
+    struct PlaneChunk **link =
+        &plane->buckets[Plane_bucket(plane, chunk->row, chunk->col)];
+    while (*link != chunk) link = &(*link)->next_in_bucket;
+    *link = chunk->next_in_bucket;
+    struct PlaneChunk *last = plane->chunks[--plane->num_chunks];
+    plane->chunks[chunk->index] = last;
+    last->index = chunk->index;
+    free(chunk->cells);
+    free(chunk->next);
+    free(chunk);
+}
+
+/**
+ * Tells if some cells of a chunk are not in state 0.
+ *
+ * @param chunk      The chunk
+ * @param first_row  The first row of the cells
+ * @param last_row   The last row of the cells
+ * @param first_col  The first column of the cells
+ * @param last_col   The last column of the cells
+ * @return           True if and only if one of the cells is not in state 0
+ */
+bool Plane_is_occupied(const struct PlaneChunk *chunk,
+                       unsigned int first_row,
+                       unsigned int last_row,
+                       unsigned int first_col,
+                       unsigned int last_col) {
+    for (unsigned int i = first_row; i <= last_row; ++i) {
+        const unsigned char *row = chunk->cells + i * PLANE_CHUNK_SIZE;
+        for (unsigned int j = first_col; j <= last_col; ++j) {
+            if (row[j] != 0) return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Allocates the neighbors of a chunk that its border cells may reach.
+ *
+ * @param plane  The plane
+ * @param chunk  The chunk
+ */
+void Plane_grow(struct Plane *plane, const struct PlaneChunk *chunk) {
+    const unsigned int last = PLANE_CHUNK_SIZE - 1;
+    for (int di = -1; di <= 1; ++di) {
+        for (int dj = -1; dj <= 1; ++dj) {
+            if (di == 0 && dj == 0) continue;
+            if (Plane_is_occupied(chunk,
+                                  di > 0 ? last : 0, di < 0 ? 0 : last,
+                                  dj > 0 ? last : 0, dj < 0 ? 0 : last)) {
+                Plane_ensure(plane, chunk->row + di, chunk->col + dj);
+            }
+        }
+    }
+}
+
+/**
+ * Copies the cells of a chunk surrounded by a one-cell halo.
+ *
+ * The halo is taken from the neighboring chunks, or is in state 0 if they
+ * are not allocated.
+ *
+ * @param plane   The plane
+ * @param chunk   The chunk
+ * @param padded  The `PLANE_PADDED_SIZE x PLANE_PADDED_SIZE` cells
+ */
+void Plane_pad(const struct Plane *plane,
+               const struct PlaneChunk *chunk,
+               unsigned char *padded) {
+    const unsigned int size = PLANE_CHUNK_SIZE, last = PLANE_CHUNK_SIZE - 1;
+    memset(padded, 0, PLANE_PADDED_SIZE * PLANE_PADDED_SIZE);
+    for (int di = -1; di <= 1; ++di) {
+        for (int dj = -1; dj <= 1; ++dj) {
+            const struct PlaneChunk *source = di == 0 && dj == 0 ? chunk
+                : Plane_find(plane, chunk->row + di, chunk->col + dj);
+            if (source == NULL) continue;
+            // The cells of the source copied into the padded cells
+            unsigned int first_row = di < 0 ? last : 0;
+            unsigned int num_rows = di == 0 ? size : 1;
+            unsigned int first_col = dj < 0 ? last : 0;
+            unsigned int num_cols = dj == 0 ? size : 1;
+            unsigned int padded_row = di < 0 ? 0 : di > 0 ? size + 1 : 1;
+            unsigned int padded_col = dj < 0 ? 0 : dj > 0 ? size + 1 : 1;
+            for (unsigned int i = 0; i < num_rows; ++i) {
+                memcpy(padded + (padded_row + i) * PLANE_PADDED_SIZE
+                              + padded_col,
+                       source->cells + (first_row + i) * size + first_col,
+                       num_cols);
+            }
+        }
+    }
+}
+
+// ------ //
+// Public //
+// ------ //
+
+bool Plane_supports(const struct Rule *rule) {
+    return Rule_apply(rule, 0, 0) == 0;
+}
+
+struct Plane *Plane_init(const struct Rule *rule) {
+    struct Plane *plane = malloc(sizeof(struct Plane));
+    plane->rule = Rule_duplicate(rule);
+    plane->capacity = PLANE_MIN_NUM_BUCKETS;
+    plane->chunks = malloc(plane->capacity * sizeof(struct PlaneChunk *));
+    plane->num_chunks = 0;
+    plane->num_buckets = PLANE_MIN_NUM_BUCKETS;
+    plane->buckets = calloc(plane->num_buckets, sizeof(struct PlaneChunk *));
+    return plane;
+}
+
+unsigned char Plane_get(const struct Plane *plane, int64_t row, int64_t col) {
+    int64_t chunk_row = Plane_chunk_of(row), chunk_col = Plane_chunk_of(col);
+    const struct PlaneChunk *chunk = Plane_find(plane, chunk_row, chunk_col);
+    if (chunk == NULL) return 0;
+    return chunk->cells[(row - chunk_row * PLANE_CHUNK_SIZE) * PLANE_CHUNK_SIZE
+                        + col - chunk_col * PLANE_CHUNK_SIZE];
+}
+
+void Plane_set(struct Plane *plane,
+               int64_t row,
+               int64_t col,
+               unsigned char state) {
+    int64_t chunk_row = Plane_chunk_of(row), chunk_col = Plane_chunk_of(col);
+    struct PlaneChunk *chunk = state == 0
+                             ? Plane_find(plane, chunk_row, chunk_col)
+                             : Plane_ensure(plane, chunk_row, chunk_col);
+    if (chunk == NULL) return;
+    chunk->cells[(row - chunk_row * PLANE_CHUNK_SIZE) * PLANE_CHUNK_SIZE
+                 + col - chunk_col * PLANE_CHUNK_SIZE] = state;
+}
+
+void Plane_step(struct Plane *plane) {
+    const unsigned int size = PLANE_CHUNK_SIZE;
+    size_t num_occupied = plane->num_chunks;
+    for (size_t k = 0; k < num_occupied; ++k) {
+        Plane_grow(plane, plane->chunks[k]);
+    }
+    unsigned char padded[PLANE_PADDED_SIZE * PLANE_PADDED_SIZE];
+    for (size_t k = 0; k < plane->num_chunks; ++k) {
+        struct PlaneChunk *chunk = plane->chunks[k];
+        Plane_pad(plane, chunk, padded);
+        for (unsigned int i = 0; i < size; ++i) {
+            const unsigned char *row = padded + (i + 1) * PLANE_PADDED_SIZE + 1;
+            Cellular_step_cells(plane->rule, row - PLANE_PADDED_SIZE, row,
+                                row + PLANE_PADDED_SIZE, size,
+                                chunk->next + i * size);
+        }
+    }
+    for (size_t k = plane->num_chunks; k-- > 0;) {
+        struct PlaneChunk *chunk = plane->chunks[k];
+        unsigned char *cells = chunk->cells;
+        chunk->cells = chunk->next;
+        chunk->next = cells;
+        if (!Plane_is_occupied(chunk, 0, size - 1, 0, size - 1)) {
+            Plane_remove(plane, chunk);
+        }
+    }
+}
+
+void Plane_load(struct Plane *plane,
+                const struct CellularAutomaton *automaton) {
+    for (unsigned int i = 0; i < automaton->num_rows; ++i) {
+        for (unsigned int j = 0; j < automaton->num_cols; ++j) {
+            Plane_set(plane, i, j, *Cellular_cell(automaton, i, j));
+        }
+    }
+}
+
+void Plane_store(const struct Plane *plane,
+                 struct CellularAutomaton *automaton) {
+    const unsigned int size = PLANE_CHUNK_SIZE;
+    static const unsigned char empty[PLANE_CHUNK_SIZE] = {0};
+    for (unsigned int i = 0; i < automaton->num_rows; i += size) {
+        unsigned int num_rows = min(automaton->num_rows - i, size);
+        for (unsigned int j = 0; j < automaton->num_cols; j += size) {
+            unsigned int num_cols = min(automaton->num_cols - j, size);
+            const struct PlaneChunk *chunk =
+                Plane_find(plane, i / size, j / size);
+            for (unsigned int k = 0; k < num_rows; ++k) {
+                Cellular_set_states(automaton, i + k, j, num_cols,
+                                    chunk == NULL ? empty
+                                                  : chunk->cells + k * size);
+            }
+        }
+    }
+}
+
+void Plane_free(struct Plane *plane) {
+    while (plane->num_chunks > 0) {
+        Plane_remove(plane, plane->chunks[plane->num_chunks - 1]);
+    }
+    free(plane->chunks);
+    free(plane->buckets);
+    Rule_free(plane->rule);
+    free(plane);
+}
@@ -0,0 +1,134 @@
+/**
+ * Provides an unbounded plane of cells, stored sparsely.
+ *
+ * The plane is split into square chunks of `PLANE_CHUNK_SIZE` cells, which
+ * are only allocated where some cell is not in state 0. The chunks are found
+ * through a hash map indexed by their coordinates. At each step, the empty
+ * neighbors of a chunk whose border is not empty are allocated, since the
+ * cells next to the border may change, and the chunks that become empty are
+ * freed. Hence, memory and time scale with the population, wherever it goes.
+ *
+ * This requires that state 0 is quiescent, i.e. a cell in state 0 whose
+ * neighbors are all in state 0 stays in state 0: see `Plane_supports`.
+ */
+#ifndef PLANE_H
+#define PLANE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cellular.h"
+#include "rule.h"
+
+#define PLANE_CHUNK_SIZE 64
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A square of `PLANE_CHUNK_SIZE x PLANE_CHUNK_SIZE` cells.
+ *
+ * The chunk `(r, c)` holds the cells of rows `r * PLANE_CHUNK_SIZE` to
+ * `(r + 1) * PLANE_CHUNK_SIZE - 1`, and similarly for the columns.
+ */
+struct PlaneChunk {
+    int64_t row;                        /**< The row of the chunk */
+    int64_t col;                        /**< The column of the chunk */
+    unsigned char *cells;               /**< The current states, row by row */
+    unsigned char *next;                /**< The next states, row by row */
+    size_t index;                       /**< The index in `chunks` */
+    struct PlaneChunk *next_in_bucket;  /**< The next chunk of the bucket */
+};
+
+/**
+ * An unbounded plane.
+ */
+struct Plane {
+    struct Rule *rule;                  /**< The rule */
+    struct PlaneChunk **chunks;         /**< The allocated chunks */
+    size_t num_chunks;                  /**< The number of chunks */
+    size_t capacity;                    /**< The capacity of `chunks` */
+    struct PlaneChunk **buckets;        /**< The hash map of the chunks */
+    size_t num_buckets;                 /**< The number of buckets */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Tells if a rule can be run on an unbounded plane.
+ *
+ * @param rule  The rule
+ * @return      True if and only if state 0 is quiescent
+ */
+bool Plane_supports(const struct Rule *rule);
+
+/**
+ * Creates an empty plane, i.e. whose cells are all in state 0.
+ *
+ * @param rule  The rule, which must be supported, copied into the plane
+ * @return      The plane
+ */
+struct Plane *Plane_init(const struct Rule *rule);
+
+/**
+ * Returns the state of a cell of a plane.
+ *
+ * @param plane  The plane
+ * @param row    The row of the cell
+ * @param col    The column of the cell
+ * @return       Its state
+ */
+unsigned char Plane_get(const struct Plane *plane, int64_t row, int64_t col);
+
+/**
+ * Sets the state of a cell of a plane.
+ *
+ * @param plane  The plane
+ * @param row    The row of the cell
+ * @param col    The column of the cell
+ * @param state  Its new state
+ */
+void Plane_set(struct Plane *plane,
+               int64_t row,
+               int64_t col,
+               unsigned char state);
+
+/**
+ * Computes the next step of a plane.
+ *
+ * @param plane  The plane to update
+ */
+void Plane_step(struct Plane *plane);
+
+/**
+ * Copies the cells of an automaton into the window of a plane.
+ *
+ * The window is made of the rows `0` to `num_rows - 1` and the columns `0`
+ * to `num_cols - 1` of the plane.
+ *
+ * @param plane      The plane
+ * @param automaton  The automaton
+ */
+void Plane_load(struct Plane *plane,
+                const struct CellularAutomaton *automaton);
+
+/**
+ * Copies the window of a plane into an automaton.
+ *
+ * @param plane      The plane
+ * @param automaton  The automaton, whose dimensions give the window
+ */
+void Plane_store(const struct Plane *plane,
+                 struct CellularAutomaton *automaton);
+
+/**
+ * Frees a plane.
+ *
+ * @param plane  The plane to free
+ */
+void Plane_free(struct Plane *plane);
+
+#endif
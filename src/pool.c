@@ -0,0 +1,221 @@
+/**
+ * Implements pool.h.
+ */
+#include "pool.h"
+#include <stdlib.h>
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * The arguments of a worker thread.
+ */
+struct PoolWorker {
+    struct Pool *pool;              /**< The pool of the worker */
+    unsigned int index;             /**< The index of the worker */
+};
+
+/**
+ * Runs the tasks of a pool, until it is stopped.
+ *
+ * @param argument  The `struct PoolWorker` of the thread, freed on exit
+ * @return          NULL
+ */
+void *Pool_work(void *argument) {
+    struct PoolWorker *worker = argument;
+    struct Pool *pool = worker->pool;
+    unsigned int index = worker->index;
+    free(worker);
+    unsigned long generation = 0;
+    pthread_mutex_lock(&pool->mutex);
+    while (true) {
+        while (!pool->is_stopping && pool->generation == generation) {
+            pthread_cond_wait(&pool->started, &pool->mutex);
+        }
+        if (pool->is_stopping) break;
+        generation = pool->generation;
+        PoolTask task = pool->task;
+        void *data = pool->data;
+        pthread_mutex_unlock(&pool->mutex);
+        task(data, index, pool->num_threads);
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->num_running == 0) {
+            pthread_cond_signal(&pool->finished);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+/**
+ * Packs a range of jobs.
+ *
+ * @param first  The first job
+ * @param last   The job following the last one
+ * @return       The packed range
+ */
+static inline uint64_t Pool_pack(unsigned int first, unsigned int last) {
+    return (uint64_t)first << 32 | last;
+}
+
+/**
+ * Takes the first job of a deque, as its owner.
+ *
+ * @param deque  The deque
+ * @param job    The job taken, if any
+ * @return       True if and only if a job was taken
+ */
+bool Pool_pop(struct PoolDeque *deque, unsigned int *job) {
+    uint64_t jobs = atomic_load(&deque->jobs);
+    while (true) {
+        unsigned int first = jobs >> 32, last = (uint32_t)jobs;
+        if (first >= last) return false;
+        if (atomic_compare_exchange_weak(&deque->jobs, &jobs,
+                                         Pool_pack(first + 1, last))) {
+            *job = first;
+            return true;
+        }
+    }
+}
+
+/**
+ * Steals the last half of the jobs of a deque.
+ *
+ * The first stolen job is returned, and the other ones are moved to the
+ * deque of the thief, which must be empty.
+ *
+ * @param victim  The deque whose jobs are stolen
+ * @param thief   The deque of the thief
+ * @param job     The first stolen job, if any
+ * @return        True if and only if a job was stolen
+ */
+bool Pool_steal(struct PoolDeque *victim,
+                struct PoolDeque *thief,
+                unsigned int *job) {
+    uint64_t jobs = atomic_load(&victim->jobs);
+    while (true) {
+        unsigned int first = jobs >> 32, last = (uint32_t)jobs;
+        if (first >= last) return false;
+        unsigned int middle = last - (last - first + 1) / 2;
+        if (atomic_compare_exchange_weak(&victim->jobs, &jobs,
+                                         Pool_pack(first, middle))) {
+            atomic_store(&thief->jobs, Pool_pack(middle + 1, last));
+            *job = middle;
+            return true;
+        }
+    }
+}
+
+/**
+ * Runs the jobs of a thread, and then steals jobs until none is left.
+ *
+ * Since a stolen job is always run by its thief, a thread finding every
+ * deque empty can stop, even if some jobs are still being moved.
+ *
+ * @param data         The pool
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Pool_work_jobs(void *data,
+                    unsigned int index,
+                    unsigned int num_threads) {
+    struct Pool *pool = data;
+    struct PoolDeque *deque = &pool->deques[index];
+    unsigned int job;
+    while (true) {
+        while (Pool_pop(deque, &job)) {
+            pool->job(pool->job_data, job);
+        }
+        bool has_stolen = false;
+        for (unsigned int k = 1; k < num_threads && !has_stolen; ++k) {
+            has_stolen = Pool_steal(&pool->deques[(index + k) % num_threads],
+                                    deque, &job);
+        }
+        if (!has_stolen) return;
+        pool->job(pool->job_data, job);
+    }
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Pool *Pool_init(unsigned int num_threads) {
+    struct Pool *pool = malloc(sizeof(struct Pool));
+    pool->num_threads = num_threads > 0 ? num_threads : 1;
+    pool->workers = calloc(pool->num_threads, sizeof(pthread_t));
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->started, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+    pool->task = NULL;
+    pool->data = NULL;
+    pool->generation = 0;
+    pool->num_running = 0;
+    pool->is_stopping = false;
+    pool->deques = aligned_alloc(alignof(struct PoolDeque),
+                                 pool->num_threads * sizeof(struct PoolDeque));
+    for (unsigned int t = 0; t < pool->num_threads; ++t) {
+        atomic_init(&pool->deques[t].jobs, 0);
+    }
+    pool->job = NULL;
+    pool->job_data = NULL;
+    for (unsigned int t = 1; t < pool->num_threads; ++t) {
+        struct PoolWorker *worker = malloc(sizeof(struct PoolWorker));
+        worker->pool = pool;
+        worker->index = t;
+        pthread_create(&pool->workers[t - 1], NULL, Pool_work, worker);
+    }
+    return pool;
+}
+
+void Pool_run(struct Pool *pool, PoolTask task, void *data) {
+    if (pool->num_threads > 1) {
+        pthread_mutex_lock(&pool->mutex);
+        pool->task = task;
+        pool->data = data;
+        pool->num_running = pool->num_threads - 1;
+        ++pool->generation;
+        pthread_cond_broadcast(&pool->started);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    task(data, 0, pool->num_threads);
+    if (pool->num_threads > 1) {
+        pthread_mutex_lock(&pool->mutex);
+        while (pool->num_running > 0) {
+            pthread_cond_wait(&pool->finished, &pool->mutex);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+void Pool_run_jobs(struct Pool *pool,
+                   PoolJob job,
+                   void *data,
+                   unsigned int num_jobs) {
+    unsigned int num_threads = pool->num_threads;
+    for (unsigned int t = 0; t < num_threads; ++t) {
+        atomic_store(&pool->deques[t].jobs,
+                     Pool_pack((unsigned long)num_jobs * t / num_threads,
+                               (unsigned long)num_jobs * (t + 1) / num_threads));
+    }
+    pool->job = job;
+    pool->job_data = data;
+    Pool_run(pool, Pool_work_jobs, pool);
+}
+
+void Pool_free(struct Pool *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->is_stopping = true;
+    pthread_cond_broadcast(&pool->started);
+    pthread_mutex_unlock(&pool->mutex);
+    for (unsigned int t = 1; t < pool->num_threads; ++t) {
+        pthread_join(pool->workers[t - 1], NULL);
+    }
+    pthread_cond_destroy(&pool->started);
+    pthread_cond_destroy(&pool->finished);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->deques);
+    free(pool->workers);
+    free(pool);
+}
@@ -0,0 +1,118 @@
+/**
+ * Provides a persistent pool of threads running the same task in parallel.
+ *
+ * The threads are created once, and then wait for tasks. Running a task on
+ * `n` threads calls it `n` times in parallel, once per thread with a
+ * different index, the calling thread being one of them. The call returns
+ * once every thread has finished, which is the only synchronization point.
+ *
+ * A pool can also run a batch of independent jobs of uneven costs: the jobs
+ * are first split evenly between the threads, and a thread having run all of
+ * its jobs steals half of the remaining jobs of another one.
+ */
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A task run by each thread of a pool.
+ *
+ * @param data         The data shared by all threads
+ * @param index        The index of the thread, from 0 to `num_threads - 1`
+ * @param num_threads  The number of threads
+ */
+typedef void (*PoolTask)(void *data,
+                         unsigned int index,
+                         unsigned int num_threads);
+
+/**
+ * A job of a batch run by a pool.
+ *
+ * @param data  The data shared by all jobs
+ * @param job   The index of the job, from 0 to `num_jobs - 1`
+ */
+typedef void (*PoolJob)(void *data, unsigned int job);
+
+/**
+ * The jobs left to a thread of a pool.
+ *
+ * The range of jobs is packed into a single word, so that the owner taking
+ * its first job and a thief taking the last ones can both update it with an
+ * atomic compare-and-swap. Each deque lies on its own cache line.
+ */
+struct PoolDeque {
+    alignas(64) _Atomic uint64_t jobs;  /**< The first job << 32 | the last + 1 */
+};
+
+/**
+ * A pool of threads.
+ */
+struct Pool {
+    unsigned int num_threads;       /**< The number of threads, caller included */
+    pthread_t *workers;             /**< The threads, caller excluded */
+    pthread_mutex_t mutex;          /**< Protects the fields below */
+    pthread_cond_t started;         /**< Signaled when a task is started */
+    pthread_cond_t finished;        /**< Signaled when a worker is done */
+    PoolTask task;                  /**< The current task */
+    void *data;                     /**< The data of the current task */
+    unsigned long generation;       /**< The number of started tasks */
+    unsigned int num_running;       /**< The number of busy workers */
+    bool is_stopping;               /**< Are the workers asked to stop? */
+    struct PoolDeque *deques;       /**< The jobs left to each thread */
+    PoolJob job;                    /**< The job of the current batch */
+    void *job_data;                 /**< The data of the current batch */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates a pool of threads.
+ *
+ * @param num_threads  The number of threads, including the calling one
+ * @return             The pool
+ */
+struct Pool *Pool_init(unsigned int num_threads);
+
+/**
+ * Runs a task on every thread of a pool, and waits for all of them.
+ *
+ * @param pool  The pool
+ * @param task  The task
+ * @param data  The data passed to the task
+ */
+void Pool_run(struct Pool *pool, PoolTask task, void *data);
+
+/**
+ * Runs a batch of jobs on the threads of a pool, and waits for all of them.
+ *
+ * Every job is run exactly once, by any thread, in no particular order.
+ *
+ * @param pool      The pool
+ * @param job       The job
+ * @param data      The data passed to each job
+ * @param num_jobs  The number of jobs
+ */
+void Pool_run_jobs(struct Pool *pool,
+                   PoolJob job,
+                   void *data,
+                   unsigned int num_jobs);
+
+/**
+ * Stops the threads of a pool and frees it.
+ *
+ * @param pool  The pool to free
+ */
+void Pool_free(struct Pool *pool);
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * Implements random.h.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "random.h"
+#include <time.h>
+#include <unistd.h>
+
+// ------ //
+// Public //
+// ------ //
+
+void Random_alias_init(struct RandomAlias *alias,
+                       const unsigned int *weights,
+                       unsigned int num_values) {
+    // Each column holds a total weight of `sum`, the weights being scaled
+    // by the number of columns
+    uint64_t sum = 0;
+    uint64_t scaled[RANDOM_MAX_NUM_VALUES];
+    for (unsigned int k = 0; k < num_values; ++k) {
+        sum += weights[k];
+        scaled[k] = (uint64_t)weights[k] * num_values;
+    }
+    alias->num_values = num_values;
+    unsigned char small[RANDOM_MAX_NUM_VALUES], large[RANDOM_MAX_NUM_VALUES];
+    unsigned int num_small = 0, num_large = 0;
+    for (unsigned int k = 0; k < num_values; ++k) {
+        // A full column always gives its own value
+        alias->thresholds[k] = UINT32_MAX;
+        alias->aliases[k] = k;
+        if (scaled[k] < sum) {
+            small[num_small++] = k;
+        } else {
+            large[num_large++] = k;
+        }
+    }
+    while (num_small > 0 && num_large > 0) {
+        unsigned char k = small[--num_small];
+        unsigned char l = large[num_large - 1];
+        // The column k is filled up by the value l
+        alias->thresholds[k] = ((unsigned __int128)scaled[k] << 32) / sum;
+        alias->aliases[k] = l;
+        scaled[l] -= sum - scaled[k];
+        if (scaled[l] < sum) {
+            --num_large;
+            small[num_small++] = l;
+        }
+    }
+}
+
+void Random_fill(const struct RandomAlias *alias,
+                 uint64_t seed,
+                 uint64_t first_index,
+                 size_t num_cells,
+                 unsigned char *states) {
+    if (num_cells == 0) return;
+    // The counter of `Random_get`, advanced by a single addition
+    uint64_t counter = Random_mix(seed) + (first_index / 2 + 1) * RANDOM_GAMMA;
+    size_t k = 0;
+    if (first_index % 2 == 1) {
+        states[k++] = Random_draw(alias, Random_mix(counter) >> 32);
+        counter += RANDOM_GAMMA;
+    }
+    for (; k + 1 < num_cells; k += 2) {
+        uint64_t bits = Random_mix(counter);
+        states[k] = Random_draw(alias, bits);
+        states[k + 1] = Random_draw(alias, bits >> 32);
+        counter += RANDOM_GAMMA;
+    }
+    if (k < num_cells) {
+        states[k] = Random_draw(alias, Random_mix(counter));
+    }
+}
+
+uint64_t Random_time_seed(void) {
+    // The nanoseconds and the process distinguish runs within a second
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return Random_mix((uint64_t)now.tv_sec * 1000000000u + now.tv_nsec)
+         ^ (uint64_t)getpid();
+}
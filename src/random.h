@@ -0,0 +1,124 @@
+/**
+ * Provides a counter-based pseudo-random generator.
+ *
+ * The number of index `i` drawn from a seed is computed directly from the
+ * seed and `i`, with the mixing function of SplitMix64, instead of advancing
+ * a state. Hence, the numbers can be drawn in any order, e.g. by several
+ * threads, and a random grid only depends on its seed. The seeds of many
+ * independent simulations can themselves be drawn from a single base seed.
+ *
+ * The states of the cells are drawn from a distribution with an alias table
+ * (Walker's method), in constant time: the 32 random bits of a cell select a
+ * column of the table with their high part, and the state or the alias of
+ * the column with their fractional part. A number of 64 bits gives the cells
+ * `2 * i` and `2 * i + 1`.
+ */
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RANDOM_GAMMA 0x9e3779b97f4a7c15ull
+#define RANDOM_MAX_NUM_VALUES 16
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * An alias table drawing values from a discrete distribution.
+ *
+ * The column `k` holds the value `k` with the probability
+ * `thresholds[k] / 2^32`, and its alias otherwise.
+ */
+struct RandomAlias {
+    unsigned int num_values;        /**< The number of values */
+    /** The probability of each value in its column */
+    uint32_t thresholds[RANDOM_MAX_NUM_VALUES];
+    /** The other value of each column */
+    unsigned char aliases[RANDOM_MAX_NUM_VALUES];
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Mixes the bits of a word, as the output function of SplitMix64.
+ *
+ * @param x  The word
+ * @return   The mixed word
+ */
+static inline uint64_t Random_mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Returns the number of an index drawn from a seed.
+ *
+ * The seed is mixed first, so that close seeds give unrelated sequences.
+ *
+ * @param seed   The seed
+ * @param index  The index of the number
+ * @return       The number
+ */
+static inline uint64_t Random_get(uint64_t seed, uint64_t index) {
+    return Random_mix(Random_mix(seed) + (index + 1) * RANDOM_GAMMA);
+}
+
+/**
+ * Draws a value from an alias table.
+ *
+ * @param alias  The alias table
+ * @param bits   32 random bits
+ * @return       The value
+ */
+static inline unsigned char Random_draw(const struct RandomAlias *alias,
+                                        uint32_t bits) {
+    uint64_t scaled = (uint64_t)bits * alias->num_values;
+    unsigned int column = scaled >> 32;
+    // Without a branch, which would be mispredicted half of the time
+    unsigned int is_alias = (uint32_t)scaled >= alias->thresholds[column];
+    return column ^ ((column ^ alias->aliases[column]) & -is_alias);
+}
+
+/**
+ * Builds the alias table of a distribution.
+ *
+ * @param alias       The alias table
+ * @param weights     The nonnegative weight of each value, the values being
+ *                    uniform if they are all 0
+ * @param num_values  The number of values, at most `RANDOM_MAX_NUM_VALUES`
+ */
+void Random_alias_init(struct RandomAlias *alias,
+                       const unsigned int *weights,
+                       unsigned int num_values);
+
+/**
+ * Draws consecutive cells from a seed.
+ *
+ * The cell of index `i` is the same whatever the range it is drawn with.
+ *
+ * @param alias        The alias table of the distribution of the states
+ * @param seed         The seed
+ * @param first_index  The index of the first cell
+ * @param num_cells    The number of cells
+ * @param states       The drawn states
+ */
+void Random_fill(const struct RandomAlias *alias,
+                 uint64_t seed,
+                 uint64_t first_index,
+                 size_t num_cells,
+                 unsigned char *states);
+
+/**
+ * Returns a seed that differs from one run to another.
+ *
+ * @return  The seed
+ */
+uint64_t Random_time_seed(void);
+
+#endif
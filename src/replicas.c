@@ -0,0 +1,192 @@
+/**
+ * Implements replicas.h.
+ */
+#include "replicas.h"
+#include <stdlib.h>
+#include <string.h>
+#include "random.h"
+#include "utils.h"
+
+/**
+ * The data of the initialization of replicas.
+ */
+struct ReplicasLoad {
+    struct Replicas *replicas;          /**< The replicas */
+    const struct CellularAutomaton *model; /**< The model of the replicas */
+    const unsigned int *distribution;   /**< The initial distribution */
+};
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Sets the grids of a band of replicas.
+ *
+ * The bands are made of whole words of members, which can be loaded in
+ * parallel.
+ *
+ * @param data         The data of the initialization
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Replicas_load_band(void *data,
+                        unsigned int index,
+                        unsigned int num_threads) {
+    struct ReplicasLoad *load = data;
+    struct Replicas *replicas = load->replicas;
+    unsigned long num_words = (replicas->num_replicas + ENSEMBLE_WORD_SIZE - 1)
+                            / ENSEMBLE_WORD_SIZE;
+    unsigned int first_replica =
+        num_words * index / num_threads * ENSEMBLE_WORD_SIZE;
+    unsigned int last_replica = min(
+        num_words * (index + 1) / num_threads * ENSEMBLE_WORD_SIZE,
+        replicas->num_replicas);
+    if (first_replica >= last_replica) return;
+    struct CellularAutomaton *automaton = Cellular_duplicate(load->model);
+    for (unsigned int r = first_replica; r < last_replica; ++r) {
+        Cellular_set_random_seeded(automaton, load->distribution,
+                                   Random_get(replicas->seed, r), 1);
+        Ensemble_load(replicas->ensemble, r, automaton);
+    }
+    Cellular_free(automaton);
+}
+
+/**
+ * Computes the next step of a band of rows of the replicas.
+ *
+ * @param data         The replicas
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Replicas_step_band(void *data,
+                        unsigned int index,
+                        unsigned int num_threads) {
+    struct Replicas *replicas = data;
+    unsigned long num_rows = replicas->ensemble->num_rows;
+    unsigned int first_row = num_rows * index / num_threads;
+    unsigned int last_row = num_rows * (index + 1) / num_threads;
+    Ensemble_step_rows(replicas->ensemble, first_row, last_row - first_row);
+}
+
+/**
+ * Counts the populations of a band of rows of the replicas.
+ *
+ * @param data         The replicas
+ * @param index        The index of the thread
+ * @param num_threads  The number of threads
+ */
+void Replicas_count_band(void *data,
+                         unsigned int index,
+                         unsigned int num_threads) {
+    struct Replicas *replicas = data;
+    unsigned long num_rows = replicas->ensemble->num_rows;
+    unsigned int first_row = num_rows * index / num_threads;
+    unsigned int last_row = num_rows * (index + 1) / num_threads;
+    Ensemble_count_rows(replicas->ensemble, first_row, last_row - first_row,
+                        replicas->band_populations + (size_t)index
+                        * replicas->num_states * replicas->num_replicas);
+}
+
+/**
+ * Counts the populations of the replicas.
+ *
+ * @param replicas  The replicas
+ */
+void Replicas_count(struct Replicas *replicas) {
+    Pool_run(replicas->pool, Replicas_count_band, replicas);
+    const size_t size = (size_t)replicas->num_states * replicas->num_replicas;
+    memcpy(replicas->populations, replicas->band_populations,
+           size * sizeof(unsigned long));
+    for (unsigned int t = 1; t < replicas->pool->num_threads; ++t) {
+        const unsigned long *band = replicas->band_populations + t * size;
+        for (size_t k = 0; k < size; ++k) {
+            replicas->populations[k] += band[k];
+        }
+    }
+}
+
+/**
+ * Compares two populations, for `qsort`.
+ *
+ * @param a  The first population
+ * @param b  The second population
+ * @return   The sign of their difference
+ */
+int Replicas_compare(const void *a, const void *b) {
+    unsigned long x = *(const unsigned long *)a;
+    unsigned long y = *(const unsigned long *)b;
+    return (x > y) - (x < y);
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Replicas *Replicas_init(const struct CellularAutomaton *model,
+                               const unsigned int *distribution,
+                               unsigned int num_replicas,
+                               uint64_t seed,
+                               unsigned int num_threads) {
+    struct Ensemble *ensemble = Ensemble_alloc(model, num_replicas);
+    if (ensemble == NULL) return NULL;
+    struct Replicas *replicas = malloc(sizeof(struct Replicas));
+    replicas->num_replicas = num_replicas;
+    replicas->seed = seed;
+    replicas->num_states = ensemble->num_states;
+    replicas->ensemble = ensemble;
+    replicas->pool = Pool_init(num_threads);
+    const size_t size = (size_t)replicas->num_states * num_replicas;
+    replicas->populations = malloc(size * sizeof(unsigned long));
+    replicas->band_populations = malloc(num_threads * size
+                                        * sizeof(unsigned long));
+    replicas->sorted = malloc(num_replicas * sizeof(unsigned long));
+    struct ReplicasLoad load = {replicas, model, distribution};
+    Pool_run(replicas->pool, Replicas_load_band, &load);
+    Replicas_count(replicas);
+    return replicas;
+}
+
+void Replicas_step(struct Replicas *replicas, unsigned int num_steps) {
+    if (num_steps == 0) return;
+    for (unsigned int step = 0; step < num_steps; ++step) {
+        Ensemble_step_begin(replicas->ensemble);
+        Pool_run(replicas->pool, Replicas_step_band, replicas);
+        Ensemble_step_end(replicas->ensemble);
+    }
+    Replicas_count(replicas);
+}
+
+void Replicas_get_stats(struct Replicas *replicas,
+                        unsigned int state,
+                        struct ReplicasStats *stats) {
+    const unsigned int n = replicas->num_replicas;
+    unsigned long *sorted = replicas->sorted;
+    memcpy(sorted, replicas->populations + (size_t)state * n,
+           n * sizeof(unsigned long));
+    qsort(sorted, n, sizeof(unsigned long), Replicas_compare);
+    double sum = 0;
+    for (unsigned int r = 0; r < n; ++r) sum += sorted[r];
+    stats->mean = sum / n;
+    stats->min = sorted[0];
+    // The nearest rank of the quantile q is the ceiling of q * n
+    stats->first_quartile = sorted[(n + 3) / 4 - 1];
+    stats->median = sorted[(n + 1) / 2 - 1];
+    stats->third_quartile = sorted[(3 * (unsigned long)n + 3) / 4 - 1];
+    stats->max = sorted[n - 1];
+}
+
+void Replicas_store(const struct Replicas *replicas,
+                    unsigned int replica,
+                    struct CellularAutomaton *automaton) {
+    Ensemble_store(replicas->ensemble, replica, automaton);
+}
+
+void Replicas_free(struct Replicas *replicas) {
+    Ensemble_free(replicas->ensemble);
+    Pool_free(replicas->pool);
+    free(replicas->populations);
+    free(replicas->band_populations);
+    free(replicas->sorted);
+    free(replicas);
+}
@@ -0,0 +1,119 @@
+/**
+ * Provides Monte Carlo replicas of a simulation.
+ *
+ * The replicas are independent random grids of the same simulation, e.g. the
+ * same pandemy from different initial grids, which are stepped together as
+ * the members of an ensemble (see `ensemble.h`), by bands of rows spread over
+ * a pool of threads. Rather than the grids, the replicas provide the
+ * statistics of the population of each state over all the replicas.
+ *
+ * The grid of the replica `r` is set by `Cellular_set_random_seeded` from the
+ * seed `Random_get(seed, r)`, where `seed` is the base seed of the replicas,
+ * so that the same base seed always gives the same replicas, whatever the
+ * number of threads.
+ */
+#ifndef REPLICAS_H
+#define REPLICAS_H
+
+#include <stdint.h>
+#include "cellular.h"
+#include "ensemble.h"
+#include "pool.h"
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * The statistics of the population of a state over the replicas.
+ *
+ * The quartiles are taken by the nearest rank, so that they are populations
+ * of actual replicas.
+ */
+struct ReplicasStats {
+    double mean;                    /**< The mean population */
+    unsigned long min;              /**< The smallest population */
+    unsigned long first_quartile;   /**< The first quartile */
+    unsigned long median;           /**< The median */
+    unsigned long third_quartile;   /**< The third quartile */
+    unsigned long max;              /**< The largest population */
+};
+
+/**
+ * Replicas of a simulation.
+ */
+struct Replicas {
+    unsigned int num_replicas;      /**< The number of replicas */
+    uint64_t seed;                  /**< The base seed */
+    unsigned int num_states;        /**< The number of states */
+    struct Ensemble *ensemble;      /**< The grids of the replicas */
+    struct Pool *pool;              /**< The threads stepping the grids */
+    /** The population of the replica `r` in the state `s`, at the index
+        `s * num_replicas + r` */
+    unsigned long *populations;
+    unsigned long *band_populations; /**< The populations of each band */
+    unsigned long *sorted;          /**< The sorted populations of a state */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates random replicas of a simulation.
+ *
+ * The populations are counted on the initial grids.
+ *
+ * @param model         An automaton with the size, type, boundary and rule of
+ *                      the replicas, and a bounded boundary
+ * @param distribution  The probability distribution of the initial cells
+ * @param num_replicas  The number of replicas, at least 1
+ * @param seed          The base seed
+ * @param num_threads   The number of threads
+ * @return              The replicas, or NULL if the boundary is unbounded
+ */
+struct Replicas *Replicas_init(const struct CellularAutomaton *model,
+                               const unsigned int *distribution,
+                               unsigned int num_replicas,
+                               uint64_t seed,
+                               unsigned int num_threads);
+
+/**
+ * Computes the next steps of every replica, and counts their populations
+ * after the last one only.
+ *
+ * @param replicas   The replicas to update
+ * @param num_steps  The number of steps
+ */
+void Replicas_step(struct Replicas *replicas, unsigned int num_steps);
+
+/**
+ * Returns the statistics of the population of a state over the replicas.
+ *
+ * @param replicas  The replicas
+ * @param state     The state
+ * @param stats     The statistics
+ */
+void Replicas_get_stats(struct Replicas *replicas,
+                        unsigned int state,
+                        struct ReplicasStats *stats);
+
+/**
+ * Copies the cells of a replica into an automaton.
+ *
+ * @param replicas   The replicas
+ * @param replica    The index of the replica
+ * @param automaton  The automaton receiving the cells, of the same size
+ */
+void Replicas_store(const struct Replicas *replicas,
+                    unsigned int replica,
+                    struct CellularAutomaton *automaton);
+
+/**
+ * Frees replicas.
+ *
+ * @param replicas  The replicas to free
+ */
+void Replicas_free(struct Replicas *replicas);
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * Implements rule.h.
+ */
+#include "rule.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Allocates a rule whose table is filled with state 0.
+ *
+ * @param num_states  The number of states
+ * @return            The rule
+ */
+struct Rule *Rule_alloc(unsigned int num_states) {
+    struct Rule *rule = malloc(sizeof(struct Rule));
+    rule->num_states = num_states;
+    rule->shift = 4 * (num_states - 1);
+    rule->birth = 0;
+    rule->survival = 0;
+    rule->table = calloc((size_t)RULE_MAX_NUM_STATES << rule->shift,
+                         sizeof(unsigned char));
+    return rule;
+}
+
+/**
+ * Parses the digits of a rulestring, i.e. numbers of neighbors.
+ *
+ * @param s     The digits, followed by '/' or '\0'
+ * @param mask  The resulting mask, whose bit k is set if k is a digit
+ * @return      The first character after the digits, or NULL if invalid
+ */
+const char *Rule_parse_digits(const char *s, unsigned int *mask) {
+    *mask = 0;
+    for (; *s != '/' && *s != '\0'; ++s) {
+        if (*s < '0' || *s > '0' + RULE_NUM_NEIGHBORS) return NULL;
+        *mask |= 1u << (*s - '0');
+    }
+    return s;
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Rule *Rule_compile(unsigned int num_states, RuleFunction function) {
+    struct Rule *rule = Rule_alloc(num_states);
+    for (unsigned int state = 0; state < num_states; ++state) {
+        for (unsigned int h = 0; h < 1u << rule->shift; ++h) {
+            rule->table[state << rule->shift | h] = function(state, h);
+        }
+    }
+    return rule;
+}
+
+struct Rule *Rule_parse_life(const char *rulestring) {
+    unsigned int birth, survival;
+    const char *s = rulestring;
+    if (toupper((unsigned char)*s++) != 'B') return NULL;
+    s = Rule_parse_digits(s, &birth);
+    if (s == NULL || *s++ != '/') return NULL;
+    if (toupper((unsigned char)*s++) != 'S') return NULL;
+    s = Rule_parse_digits(s, &survival);
+    if (s == NULL || *s != '\0') return NULL;
+
+    struct Rule *rule = Rule_alloc(2);
+    rule->birth = birth;
+    rule->survival = survival;
+    for (unsigned int n = 0; n <= RULE_NUM_NEIGHBORS; ++n) {
+        rule->table[0 << rule->shift | n] = (birth >> n) & 1;
+        rule->table[1 << rule->shift | n] = (survival >> n) & 1;
+    }
+    return rule;
+}
+
+unsigned char Rule_apply(const struct Rule *rule,
+                         unsigned char state,
+                         uint16_t histogram) {
+    return rule->table[(state & (RULE_MAX_NUM_STATES - 1)) << rule->shift
+                       | histogram];
+}
+
+struct Rule *Rule_duplicate(const struct Rule *rule) {
+    struct Rule *copy = Rule_alloc(rule->num_states);
+    copy->birth = rule->birth;
+    copy->survival = rule->survival;
+    memcpy(copy->table, rule->table,
+           (size_t)RULE_MAX_NUM_STATES << rule->shift);
+    return copy;
+}
+
+void Rule_free(struct Rule *rule) {
+    free(rule->table);
+    free(rule);
+}
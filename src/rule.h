@@ -0,0 +1,102 @@
+/**
+ * Provides totalistic rules compiled into lookup tables.
+ *
+ * The next state of a cell only depends on its current state and on the
+ * histogram of the states of its 8 neighbors, as computed by
+ * `Stencil_histogram`. A rule is therefore a table indexed by both, so that
+ * applying any rule takes a single memory access, without any branch.
+ *
+ * Life-like rules, i.e. game-of-life variants, can be described by a
+ * rulestring such as "B36/S23": a dead cell is born if its number of live
+ * neighbors is one of the digits following `B`, and a live cell survives if
+ * it is one of the digits following `S`.
+ */
+#ifndef RULE_H
+#define RULE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RULE_MAX_NUM_STATES 4
+#define RULE_NUM_NEIGHBORS 8
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * A function giving the next state of a cell, from its current state and
+ * the histogram of the states of its neighbors.
+ */
+typedef unsigned char (*RuleFunction)(unsigned char state,
+                                      uint16_t histogram);
+
+/**
+ * A rule compiled into a lookup table.
+ *
+ * The histogram of a rule with `n` states only holds the counts of the
+ * states 1 to `n - 1`, i.e. its `shift = 4 * (n - 1)` low bits. The next
+ * state of a cell in state `s` is then `table[s << shift | histogram]`. The
+ * table has `RULE_MAX_NUM_STATES << shift` entries, so that any state can
+ * safely be looked up once masked with `RULE_MAX_NUM_STATES - 1`.
+ */
+struct Rule {
+    unsigned int num_states;        /**< The number of states */
+    unsigned int shift;             /**< The number of bits of a histogram */
+    unsigned int birth;             /**< If Life-like, bit k: born with k */
+    unsigned int survival;          /**< If Life-like, bit k: survives with k */
+    unsigned char *table;           /**< The next states */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Compiles a rule into a lookup table.
+ *
+ * @param num_states  The number of states, from 2 to `RULE_MAX_NUM_STATES`
+ * @param function    The function giving the next state of a cell
+ * @return            The compiled rule
+ */
+struct Rule *Rule_compile(unsigned int num_states, RuleFunction function);
+
+/**
+ * Compiles a Life-like rule from its rulestring.
+ *
+ * The rulestring is of the form "B<digits>/S<digits>", where the digits are
+ * numbers of live neighbors, from 0 to 8. The letters are case insensitive.
+ *
+ * @param rulestring  The rulestring, e.g. "B3/S23"
+ * @return            The compiled rule, or NULL if the rulestring is invalid
+ */
+struct Rule *Rule_parse_life(const char *rulestring);
+
+/**
+ * Returns the next state of a cell.
+ *
+ * @param rule       The rule
+ * @param state      The current state of the cell
+ * @param histogram  The histogram of the states of its neighbors
+ * @return           The next state
+ */
+unsigned char Rule_apply(const struct Rule *rule,
+                         unsigned char state,
+                         uint16_t histogram);
+
+/**
+ * Duplicates a rule.
+ *
+ * @param rule  The rule to duplicate
+ * @return      A copy of the rule
+ */
+struct Rule *Rule_duplicate(const struct Rule *rule);
+
+/**
+ * Frees a rule.
+ *
+ * @param rule  The rule to free
+ */
+void Rule_free(struct Rule *rule);
+
+#endif
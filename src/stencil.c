@@ -0,0 +1,380 @@
+/**
+ * Implements stencil.h.
+ *
+ * The vectorized kernels compare the 8 shifted neighbor vectors with the
+ * counted state. A matching byte is then equal to -1, so that subtracting the
+ * comparisons from an accumulator counts the matching neighbors of 16 or 32
+ * cells at once. The remaining cells of the row are counted by the scalar
+ * kernel. Histograms are computed the same way, with one accumulator per
+ * state, so that each neighbor is loaded only once.
+ *
+ * The SSE2 and AVX2 kernels are compiled with function-specific target
+ * attributes, so that the rest of the program does not require these
+ * instruction sets. They are only called if the processor supports them.
+ */
+#include "stencil.h"
+#include <stddef.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STENCIL_X86
+#include <immintrin.h>
+#endif
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * A function counting neighbors. See `Stencil_count` for the meaning of the
+ * parameters.
+ */
+typedef void (*StencilCountFunction)(const unsigned char *above,
+                                     const unsigned char *row,
+                                     const unsigned char *below,
+                                     unsigned int num_cells,
+                                     unsigned char state,
+                                     unsigned char *counts);
+
+/**
+ * A function computing histograms. See `Stencil_histogram` for the meaning
+ * of the parameters.
+ */
+typedef void (*StencilHistogramFunction)(const unsigned char *above,
+                                         const unsigned char *row,
+                                         const unsigned char *below,
+                                         unsigned int num_cells,
+                                         uint16_t *histograms);
+
+/**
+ * The functions of a kernel.
+ */
+struct StencilFunctions {
+    StencilCountFunction count;         /**< Counts the neighbors in a state */
+    StencilHistogramFunction histogram; /**< Counts the neighbors per state */
+};
+
+/**
+ * The contribution of a neighbor to a histogram, indexed by its state.
+ */
+static const uint16_t STENCIL_WEIGHTS[256] = {
+    [1] = 1 << STENCIL_HISTOGRAM_SHIFT(1),
+    [2] = 1 << STENCIL_HISTOGRAM_SHIFT(2),
+    [3] = 1 << STENCIL_HISTOGRAM_SHIFT(3)
+};
+
+/**
+ * Counts neighbors one cell at a time.
+ *
+ * See `Stencil_count` for the meaning of the parameters.
+ */
+void Stencil_count_scalar(const unsigned char *above,
+                          const unsigned char *row,
+                          const unsigned char *below,
+                          unsigned int num_cells,
+                          unsigned char state,
+                          unsigned char *counts) {
+    for (unsigned int j = 0; j < num_cells; ++j) {
+        const unsigned char *a = above + j, *r = row + j, *b = below + j;
+        counts[j] = (a[-1] == state) + (a[0] == state) + (a[1] == state)
+                  + (r[-1] == state)                   + (r[1] == state)
+                  + (b[-1] == state) + (b[0] == state) + (b[1] == state);
+    }
+}
+
+/**
+ * Computes histograms one cell at a time.
+ *
+ * See `Stencil_histogram` for the meaning of the parameters.
+ */
+void Stencil_histogram_scalar(const unsigned char *above,
+                              const unsigned char *row,
+                              const unsigned char *below,
+                              unsigned int num_cells,
+                              uint16_t *histograms) {
+    const uint16_t *w = STENCIL_WEIGHTS;
+    for (unsigned int j = 0; j < num_cells; ++j) {
+        const unsigned char *a = above + j, *r = row + j, *b = below + j;
+        histograms[j] = w[a[-1]] + w[a[0]] + w[a[1]]
+                      + w[r[-1]]           + w[r[1]]
+                      + w[b[-1]] + w[b[0]] + w[b[1]];
+    }
+}
+
+#ifdef STENCIL_X86
+
+/**
+ * Adds to `count` the 16 bytes at `p` that are equal to the bytes of `s`.
+ */
+#define STENCIL_SSE2_ADD(count, s, p)                                         \
+    count = _mm_sub_epi8(count, _mm_cmpeq_epi8(s,                             \
+        _mm_loadu_si128((const __m128i *)(p))))
+
+/**
+ * Adds to `count` the 32 bytes at `p` that are equal to the bytes of `s`.
+ */
+#define STENCIL_AVX2_ADD(count, s, p)                                         \
+    count = _mm256_sub_epi8(count, _mm256_cmpeq_epi8(s,                       \
+        _mm256_loadu_si256((const __m256i *)(p))))
+
+/**
+ * Adds the 16 bytes at `p` to the histograms of states 1, 2 and 3.
+ */
+#define STENCIL_SSE2_ADD_HISTOGRAM(counts, s, p) {                            \
+    __m128i v = _mm_loadu_si128((const __m128i *)(p));                        \
+    for (unsigned int k = 0; k < 3; ++k) {                                    \
+        counts[k] = _mm_sub_epi8(counts[k], _mm_cmpeq_epi8(s[k], v));         \
+    }                                                                         \
+}
+
+/**
+ * Adds the 32 bytes at `p` to the histograms of states 1, 2 and 3.
+ */
+#define STENCIL_AVX2_ADD_HISTOGRAM(counts, s, p) {                            \
+    __m256i v = _mm256_loadu_si256((const __m256i *)(p));                     \
+    for (unsigned int k = 0; k < 3; ++k) {                                    \
+        counts[k] = _mm256_sub_epi8(counts[k], _mm256_cmpeq_epi8(s[k], v));   \
+    }                                                                         \
+}
+
+/**
+ * Counts neighbors 16 cells at a time, with SSE2 instructions.
+ *
+ * See `Stencil_count` for the meaning of the parameters.
+ */
+__attribute__((target("sse2")))
+void Stencil_count_sse2(const unsigned char *above,
+                        const unsigned char *row,
+                        const unsigned char *below,
+                        unsigned int num_cells,
+                        unsigned char state,
+                        unsigned char *counts) {
+    const __m128i s = _mm_set1_epi8((char)state);
+    unsigned int j = 0;
+    for (; j + 16 <= num_cells; j += 16) {
+        const unsigned char *a = above + j, *r = row + j, *b = below + j;
+        __m128i count = _mm_setzero_si128();
+        STENCIL_SSE2_ADD(count, s, a - 1);
+        STENCIL_SSE2_ADD(count, s, a);
+        STENCIL_SSE2_ADD(count, s, a + 1);
+        STENCIL_SSE2_ADD(count, s, r - 1);
+        STENCIL_SSE2_ADD(count, s, r + 1);
+        STENCIL_SSE2_ADD(count, s, b - 1);
+        STENCIL_SSE2_ADD(count, s, b);
+        STENCIL_SSE2_ADD(count, s, b + 1);
+        _mm_storeu_si128((__m128i *)(counts + j), count);
+    }
+    Stencil_count_scalar(above + j, row + j, below + j, num_cells - j,
+                         state, counts + j);
+}
+
+/**
+ * Counts neighbors 32 cells at a time, with AVX2 instructions.
+ *
+ * See `Stencil_count` for the meaning of the parameters.
+ */
+__attribute__((target("avx2")))
+void Stencil_count_avx2(const unsigned char *above,
+                        const unsigned char *row,
+                        const unsigned char *below,
+                        unsigned int num_cells,
+                        unsigned char state,
+                        unsigned char *counts) {
+    const __m256i s = _mm256_set1_epi8((char)state);
+    unsigned int j = 0;
+    for (; j + 32 <= num_cells; j += 32) {
+        const unsigned char *a = above + j, *r = row + j, *b = below + j;
+        __m256i count = _mm256_setzero_si256();
+        STENCIL_AVX2_ADD(count, s, a - 1);
+        STENCIL_AVX2_ADD(count, s, a);
+        STENCIL_AVX2_ADD(count, s, a + 1);
+        STENCIL_AVX2_ADD(count, s, r - 1);
+        STENCIL_AVX2_ADD(count, s, r + 1);
+        STENCIL_AVX2_ADD(count, s, b - 1);
+        STENCIL_AVX2_ADD(count, s, b);
+        STENCIL_AVX2_ADD(count, s, b + 1);
+        _mm256_storeu_si256((__m256i *)(counts + j), count);
+    }
+    // Avoids the penalty of mixing AVX and legacy SSE instructions
+    _mm256_zeroupper();
+    Stencil_count_sse2(above + j, row + j, below + j, num_cells - j,
+                       state, counts + j);
+}
+
+/**
+ * Computes histograms 16 cells at a time, with SSE2 instructions.
+ *
+ * Each state is counted in its own byte, and the bytes are then packed into
+ * 16-bit histograms: the counts of states 1 and 2 share the low byte, since
+ * they are at most 8.
+ *
+ * See `Stencil_histogram` for the meaning of the parameters.
+ */
+__attribute__((target("sse2")))
+void Stencil_histogram_sse2(const unsigned char *above,
+                            const unsigned char *row,
+                            const unsigned char *below,
+                            unsigned int num_cells,
+                            uint16_t *histograms) {
+    const __m128i s[3] = {_mm_set1_epi8(1), _mm_set1_epi8(2),
+                          _mm_set1_epi8(3)};
+    unsigned int j = 0;
+    for (; j + 16 <= num_cells; j += 16) {
+        const unsigned char *a = above + j, *r = row + j, *b = below + j;
+        __m128i counts[3] = {_mm_setzero_si128(), _mm_setzero_si128(),
+                             _mm_setzero_si128()};
+        STENCIL_SSE2_ADD_HISTOGRAM(counts, s, a - 1);
+        STENCIL_SSE2_ADD_HISTOGRAM(counts, s, a);
+        STENCIL_SSE2_ADD_HISTOGRAM(counts, s, a + 1);
+        STENCIL_SSE2_ADD_HISTOGRAM(counts, s, r - 1);
+        STENCIL_SSE2_ADD_HISTOGRAM(counts, s, r + 1);
+        STENCIL_SSE2_ADD_HISTOGRAM(counts, s, b - 1);
+        STENCIL_SSE2_ADD_HISTOGRAM(counts, s, b);
+        STENCIL_SSE2_ADD_HISTOGRAM(counts, s, b + 1);
+        __m128i low = _mm_or_si128(counts[0],
+                                   _mm_slli_epi16(counts[1], 4));
+        __m128i *h = (__m128i *)(histograms + j);
+        _mm_storeu_si128(h, _mm_unpacklo_epi8(low, counts[2]));
+        _mm_storeu_si128(h + 1, _mm_unpackhi_epi8(low, counts[2]));
+    }
+    Stencil_histogram_scalar(above + j, row + j, below + j, num_cells - j,
+                             histograms + j);
+}
+
+/**
+ * Computes histograms 32 cells at a time, with AVX2 instructions.
+ *
+ * See `Stencil_histogram_sse2` for more details.
+ */
+__attribute__((target("avx2")))
+void Stencil_histogram_avx2(const unsigned char *above,
+                            const unsigned char *row,
+                            const unsigned char *below,
+                            unsigned int num_cells,
+                            uint16_t *histograms) {
+    const __m256i s[3] = {_mm256_set1_epi8(1), _mm256_set1_epi8(2),
+                          _mm256_set1_epi8(3)};
+    unsigned int j = 0;
+    for (; j + 32 <= num_cells; j += 32) {
+        const unsigned char *a = above + j, *r = row + j, *b = below + j;
+        __m256i counts[3] = {_mm256_setzero_si256(), _mm256_setzero_si256(),
+                             _mm256_setzero_si256()};
+        STENCIL_AVX2_ADD_HISTOGRAM(counts, s, a - 1);
+        STENCIL_AVX2_ADD_HISTOGRAM(counts, s, a);
+        STENCIL_AVX2_ADD_HISTOGRAM(counts, s, a + 1);
+        STENCIL_AVX2_ADD_HISTOGRAM(counts, s, r - 1);
+        STENCIL_AVX2_ADD_HISTOGRAM(counts, s, r + 1);
+        STENCIL_AVX2_ADD_HISTOGRAM(counts, s, b - 1);
+        STENCIL_AVX2_ADD_HISTOGRAM(counts, s, b);
+        STENCIL_AVX2_ADD_HISTOGRAM(counts, s, b + 1);
+        __m256i low = _mm256_or_si256(counts[0],
+                                      _mm256_slli_epi16(counts[1], 4));
+        // Unpacking works within 128-bit lanes, hence the permutations
+        __m256i first = _mm256_unpacklo_epi8(low, counts[2]);
+        __m256i second = _mm256_unpackhi_epi8(low, counts[2]);
+        __m256i *h = (__m256i *)(histograms + j);
+        _mm256_storeu_si256(h, _mm256_permute2x128_si256(first, second,
+                                                         0x20));
+        _mm256_storeu_si256(h + 1, _mm256_permute2x128_si256(first, second,
+                                                             0x31));
+    }
+    _mm256_zeroupper();
+    Stencil_histogram_sse2(above + j, row + j, below + j, num_cells - j,
+                           histograms + j);
+}
+
+#endif
+
+/**
+ * The available kernels, indexed by `enum StencilKernel`.
+ *
+ * The functions of a kernel are NULL if it is not compiled for this
+ * architecture.
+ */
+const struct StencilFunctions STENCIL_FUNCTIONS[STENCIL_NUM_KERNELS] = {
+    [STENCIL_SCALAR] = {Stencil_count_scalar, Stencil_histogram_scalar},
+#ifdef STENCIL_X86
+    [STENCIL_SSE2] = {Stencil_count_sse2, Stencil_histogram_sse2},
+    [STENCIL_AVX2] = {Stencil_count_avx2, Stencil_histogram_avx2}
+#endif
+};
+
+/**
+ * The kernel used by `Stencil_count`.
+ */
+static enum StencilKernel Stencil_kernel = STENCIL_SCALAR;
+
+/**
+ * Selects the fastest supported kernel, when the program starts.
+ */
+__attribute__((constructor))
+static void Stencil_select() {
+#ifdef STENCIL_X86
+    __builtin_cpu_init();
+#endif
+    for (int kernel = STENCIL_NUM_KERNELS - 1; kernel >= 0; --kernel) {
+        if (Stencil_use(kernel)) return;
+    }
+}
+
+// ------ //
+// Public //
+// ------ //
+
+void Stencil_count(const unsigned char *above,
+                   const unsigned char *row,
+                   const unsigned char *below,
+                   unsigned int num_cells,
+                   unsigned char state,
+                   unsigned char *counts) {
+    STENCIL_FUNCTIONS[Stencil_kernel].count(above, row, below, num_cells,
+                                            state, counts);
+}
+
+void Stencil_histogram(const unsigned char *above,
+                       const unsigned char *row,
+                       const unsigned char *below,
+                       unsigned int num_cells,
+                       uint16_t *histograms) {
+    STENCIL_FUNCTIONS[Stencil_kernel].histogram(above, row, below, num_cells,
+                                                histograms);
+}
+
+bool Stencil_supports(enum StencilKernel kernel) {
+    if (kernel >= STENCIL_NUM_KERNELS ||
+        STENCIL_FUNCTIONS[kernel].count == NULL) {
+        return false;
+    }
+    switch (kernel) {
+#ifdef STENCIL_X86
+        case STENCIL_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case STENCIL_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return true;
+    }
+}
+
+bool Stencil_use(enum StencilKernel kernel) {
+    if (!Stencil_supports(kernel)) return false;
+    Stencil_kernel = kernel;
+    return true;
+}
+
+enum StencilKernel Stencil_current() {
+    return Stencil_kernel;
+}
+
+const char *Stencil_name(enum StencilKernel kernel) {
+    switch (kernel) {
+        case STENCIL_SCALAR:
+            return "scalar";
+        case STENCIL_SSE2:
+            return "sse2";
+        case STENCIL_AVX2:
+            return "avx2";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,124 @@
+/**
+ * Provides vectorized kernels counting the neighbors of the cells of a row.
+ *
+ * Several implementations of the same kernel are available: a portable
+ * scalar one, and SSE2 and AVX2 ones on x86 processors, which respectively
+ * count the neighbors of 16 and 32 cells at once. The fastest kernel
+ * supported by the processor is selected at startup, but another supported
+ * kernel can be forced with `Stencil_use`.
+ *
+ * Besides the number of neighbors in a single state, a kernel can compute
+ * the histogram of the states of the neighbors, in a single pass. It is
+ * packed in 16 bits: the number of neighbors in state `s`, for `s` from 1 to
+ * 3, takes the 4 bits starting at `STENCIL_HISTOGRAM_SHIFT(s)`. The number of
+ * neighbors in state 0 is implicit, since there are 8 neighbors in total.
+ *
+ * All kernels produce exactly the same counts.
+ */
+#ifndef STENCIL_H
+#define STENCIL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * The position of the count of a state, from 1 to 3, in a histogram.
+ */
+#define STENCIL_HISTOGRAM_SHIFT(state) (4 * ((state) - 1))
+
+/**
+ * Returns the count of a state, from 1 to 3, in a histogram.
+ */
+#define STENCIL_HISTOGRAM_COUNT(histogram, state)                             \
+    (((histogram) >> STENCIL_HISTOGRAM_SHIFT(state)) & 0xF)
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * The implementation of a stencil kernel.
+ */
+enum StencilKernel {
+    STENCIL_SCALAR,                 /**< Portable, one cell at a time */
+    STENCIL_SSE2,                   /**< 16 cells at a time */
+    STENCIL_AVX2,                   /**< 32 cells at a time */
+    STENCIL_NUM_KERNELS             /**< The number of kernels */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Counts, for each cell of a row, the number of its 8 neighbors in a state.
+ *
+ * The rows above and below, as well as the cells at index -1 and `num_cells`
+ * of the three rows, must be readable: they are typically the halo of the
+ * automaton.
+ *
+ * @param above      The row above
+ * @param row        The row whose cells are considered
+ * @param below      The row below
+ * @param num_cells  The number of cells in the row
+ * @param state      The state of the counted neighbors
+ * @param counts     The resulting counts, one per cell
+ */
+void Stencil_count(const unsigned char *above,
+                   const unsigned char *row,
+                   const unsigned char *below,
+                   unsigned int num_cells,
+                   unsigned char state,
+                   unsigned char *counts);
+
+/**
+ * Computes, for each cell of a row, the histogram of the states of its 8
+ * neighbors.
+ *
+ * The states must be between 0 and 3. As for `Stencil_count`, the neighbors
+ * of every cell must be readable.
+ *
+ * @param above       The row above
+ * @param row         The row whose cells are considered
+ * @param below       The row below
+ * @param num_cells   The number of cells in the row
+ * @param histograms  The resulting histograms, one per cell
+ */
+void Stencil_histogram(const unsigned char *above,
+                       const unsigned char *row,
+                       const unsigned char *below,
+                       unsigned int num_cells,
+                       uint16_t *histograms);
+
+/**
+ * Returns true if a kernel is supported by the processor.
+ *
+ * @param kernel  The kernel
+ * @return        True if it can be used
+ */
+bool Stencil_supports(enum StencilKernel kernel);
+
+/**
+ * Selects the kernel used by `Stencil_count`.
+ *
+ * @param kernel  The kernel
+ * @return        True if it is supported and now used
+ */
+bool Stencil_use(enum StencilKernel kernel);
+
+/**
+ * Returns the kernel currently used by `Stencil_count`.
+ *
+ * @return  The kernel
+ */
+enum StencilKernel Stencil_current();
+
+/**
+ * Returns the name of a kernel.
+ *
+ * @param kernel  The kernel
+ * @return        Its name
+ */
+const char *Stencil_name(enum StencilKernel kernel);
+
+#endif
@@ -4,7 +4,9 @@
  * @author Alexandre Blondin Masse
  */
 #include "cellular.h"
+#include "stencil.h"
 #include "CUnit/Basic.h"
+#include <stdint.h>
 
 void test_random_game_of_life() {
     unsigned int num_rows = 20, num_cols = 30;
@@ -15,8 +17,8 @@ void test_random_game_of_life() {
     Cellular_set_random(automaton, distribution);
     for (unsigned int i = 0; i < num_rows; ++i) {
         for (unsigned int j = 0; j < num_cols; ++j) {
-            CU_ASSERT(automaton->cells[i][j] == '.' ||
-                      automaton->cells[i][j] == 'X');
+            CU_ASSERT(Cellular_get(automaton, i, j) == '.' ||
+                      Cellular_get(automaton, i, j) == 'X');
         }
     }
     Cellular_free(automaton);
@@ -31,9 +33,9 @@ void test_random_pandemy() {
     Cellular_set_random(automaton, distribution);
     for (unsigned int i = 0; i < num_rows; ++i) {
         for (unsigned int j = 0; j < num_cols; ++j) {
-            CU_ASSERT(automaton->cells[i][j] == '.' ||
-                      automaton->cells[i][j] == 'X' ||
-                      automaton->cells[i][j] == 'H');
+            CU_ASSERT(Cellular_get(automaton, i, j) == '.' ||
+                      Cellular_get(automaton, i, j) == 'X' ||
+                      Cellular_get(automaton, i, j) == 'H');
         }
     }
     Cellular_free(automaton);
@@ -48,15 +50,71 @@ void test_random_fire() {
     Cellular_set_random(automaton, distribution);
     for (unsigned int i = 0; i < num_rows; ++i) {
         for (unsigned int j = 0; j < num_cols; ++j) {
-            CU_ASSERT(automaton->cells[i][j] == '.' ||
-                      automaton->cells[i][j] == '_' ||
-                      automaton->cells[i][j] == 'B' ||
-                      automaton->cells[i][j] == 'b');
+            CU_ASSERT(Cellular_get(automaton, i, j) == '.' ||
+                      Cellular_get(automaton, i, j) == '_' ||
+                      Cellular_get(automaton, i, j) == 'B' ||
+                      Cellular_get(automaton, i, j) == 'b');
         }
     }
     Cellular_free(automaton);
 }
 
+void test_random_seeded() {
+    unsigned int num_rows = 20, num_cols = 30;
+    struct CellularAutomaton *first =
+        Cellular_init(num_rows, num_cols,
+                      CELLULAR_FIRE, CELLULAR_TRUNCATE, "._Bb");
+    struct CellularAutomaton *second = Cellular_duplicate(first);
+    unsigned int distribution[] = {3, 0, 1, 2};
+    Cellular_set_random_seeded(first, distribution, 12345, 1);
+    Cellular_set_random_seeded(second, distribution, 12345, 3);
+    unsigned int num_same = 0;
+    for (unsigned int i = 0; i < num_rows; ++i) {
+        for (unsigned int j = 0; j < num_cols; ++j) {
+            CU_ASSERT_NOT_EQUAL(Cellular_get(first, i, j), '_');
+            CU_ASSERT_EQUAL(Cellular_get(first, i, j),
+                            Cellular_get(second, i, j));
+        }
+    }
+    Cellular_set_random_seeded(second, distribution, 12346, 1);
+    for (unsigned int i = 0; i < num_rows; ++i) {
+        for (unsigned int j = 0; j < num_cols; ++j) {
+            num_same += Cellular_get(first, i, j) == Cellular_get(second, i, j);
+        }
+    }
+    CU_ASSERT(num_same < num_rows * num_cols);
+    Cellular_free(first);
+    Cellular_free(second);
+}
+
+void test_format() {
+    unsigned int num_rows = 5, num_cols = 37;
+    struct CellularAutomaton *automaton =
+        Cellular_init(num_rows, num_cols,
+                      CELLULAR_FIRE, CELLULAR_TRUNCATE, "._Bb");
+    unsigned int distribution[] = {1, 1, 1, 1};
+    Cellular_set_random_seeded(automaton, distribution, 7, 1);
+    unsigned char uninitialized = CELLULAR_UNINITIALIZED_STATE;
+    Cellular_set_states(automaton, 2, 20, 1, &uninitialized);
+    CU_ASSERT_EQUAL(Cellular_text_size(automaton), num_rows * (num_cols + 1));
+    char text[5 * 38];
+    enum StencilKernel best = Stencil_current();
+    for (int kernel = 0; kernel < STENCIL_NUM_KERNELS; ++kernel) {
+        if (!Stencil_use(kernel)) continue;
+        Cellular_format_rows(automaton, 1, 3, text);
+        for (unsigned int i = 0; i < 3; ++i) {
+            for (unsigned int j = 0; j < num_cols; ++j) {
+                CU_ASSERT_EQUAL(text[i * (num_cols + 1) + j],
+                                Cellular_get(automaton, i + 1, j));
+            }
+            CU_ASSERT_EQUAL(text[i * (num_cols + 1) + num_cols], '\n');
+        }
+        CU_ASSERT_EQUAL(text[num_cols + 1 + 20], UNINITIALIZED_CELL);
+    }
+    Stencil_use(best);
+    Cellular_free(automaton);
+}
+
 void test_num_cells() {
     CU_ASSERT_EQUAL(Cellular_num_cells(CELLULAR_GAME_OF_LIFE), 2);
     CU_ASSERT_EQUAL(Cellular_num_cells(CELLULAR_PANDEMY), 3);
@@ -69,6 +127,41 @@ void test_validity() {
     CU_ASSERT(Cellular_is_valid(CELLULAR_FIRE, "abcd"));
 }
 
+void test_contiguous_storage() {
+    unsigned int num_rows = 7, num_cols = 100;
+    struct CellularAutomaton *automaton =
+        Cellular_init(num_rows, num_cols,
+                      CELLULAR_GAME_OF_LIFE, CELLULAR_TRUNCATE, ".X");
+    CU_ASSERT(automaton->stride >= num_cols + 2);
+    CU_ASSERT_EQUAL(automaton->stride % CELLULAR_ALIGNMENT, 0);
+    for (unsigned int i = 0; i < num_rows; ++i) {
+        CU_ASSERT(automaton->cells[i] > automaton->data + automaton->stride);
+        CU_ASSERT_EQUAL((uintptr_t)automaton->cells[i] % CELLULAR_ALIGNMENT, 0);
+        if (i > 0) {
+            CU_ASSERT(automaton->cells[i] ==
+                      automaton->cells[i - 1] + automaton->stride);
+        }
+    }
+    Cellular_free(automaton);
+}
+
+void test_states() {
+    struct CellularAutomaton *automaton =
+        Cellular_init(2, 2, CELLULAR_FIRE, CELLULAR_TRUNCATE, "._Bb");
+    CU_ASSERT_EQUAL(Cellular_get(automaton, 0, 0), UNINITIALIZED_CELL);
+    CU_ASSERT(Cellular_set(automaton, 0, 0, '.'));
+    CU_ASSERT(Cellular_set(automaton, 0, 1, '_'));
+    CU_ASSERT(Cellular_set(automaton, 1, 0, 'B'));
+    CU_ASSERT(Cellular_set(automaton, 1, 1, 'b'));
+    CU_ASSERT(!Cellular_set(automaton, 1, 1, 'X'));
+    CU_ASSERT_EQUAL(automaton->cells[0][0], CELLULAR_FIRE_GROWING);
+    CU_ASSERT_EQUAL(automaton->cells[0][1], CELLULAR_FIRE_IGNITABLE);
+    CU_ASSERT_EQUAL(automaton->cells[1][0], CELLULAR_FIRE_BURNING);
+    CU_ASSERT_EQUAL(automaton->cells[1][1], CELLULAR_FIRE_BURNT);
+    CU_ASSERT_EQUAL(Cellular_get(automaton, 1, 0), 'B');
+    Cellular_free(automaton);
+}
+
 void test_duplication() {
     unsigned int num_rows = 20, num_cols = 30;
     struct CellularAutomaton *automaton =
@@ -90,22 +183,123 @@ void test_duplication() {
 void test_simulation() {
     struct CellularAutomaton *automaton =
         Cellular_init(3, 3, CELLULAR_PANDEMY, CELLULAR_TRUNCATE, ".XH");
-    char **a = automaton->cells;
-    a[0][0] = '.'; a[0][1] = 'X'; a[0][2] = '.';
-    a[1][0] = '.'; a[1][1] = 'X'; a[1][2] = '.';
-    a[2][0] = '.'; a[2][1] = 'X'; a[2][2] = '.';
+    const char *a[] = {".X.", ".X.", ".X."};
+    for (unsigned int i = 0; i < 3; ++i) {
+        for (unsigned int j = 0; j < 3; ++j) {
+            Cellular_set(automaton, i, j, a[i][j]);
+        }
+    }
+    struct CellularAutomaton *next = Cellular_next(automaton);
+    CU_ASSERT_EQUAL(Cellular_get(next, 0, 0), '.');
+    CU_ASSERT_EQUAL(Cellular_get(next, 0, 1), '.');
+    CU_ASSERT_EQUAL(Cellular_get(next, 0, 2), '.');
+    CU_ASSERT_EQUAL(Cellular_get(next, 1, 0), 'X');
+    CU_ASSERT_EQUAL(Cellular_get(next, 1, 1), 'X');
+    CU_ASSERT_EQUAL(Cellular_get(next, 1, 2), 'X');
+    CU_ASSERT_EQUAL(Cellular_get(next, 2, 0), '.');
+    CU_ASSERT_EQUAL(Cellular_get(next, 2, 1), '.');
+    CU_ASSERT_EQUAL(Cellular_get(next, 2, 2), '.');
+    Cellular_free(automaton);
+    Cellular_free(next);
+}
+
+void test_wrap_around_simulation() {
+    struct CellularAutomaton *automaton =
+        Cellular_init(5, 5, CELLULAR_GAME_OF_LIFE, CELLULAR_WRAP_AROUND, ".X");
+    for (unsigned int i = 0; i < 5; ++i) {
+        for (unsigned int j = 0; j < 5; ++j) {
+            Cellular_set(automaton, i, j, '.');
+        }
+    }
+    Cellular_set(automaton, 0, 4, 'X');
+    Cellular_set(automaton, 0, 0, 'X');
+    Cellular_set(automaton, 0, 1, 'X');
+    struct CellularAutomaton *next = Cellular_next(automaton);
+    for (unsigned int i = 0; i < 5; ++i) {
+        for (unsigned int j = 0; j < 5; ++j) {
+            bool live = j == 0 && (i == 4 || i == 0 || i == 1);
+            CU_ASSERT_EQUAL(Cellular_get(next, i, j), live ? 'X' : '.');
+        }
+    }
+    Cellular_free(automaton);
+    Cellular_free(next);
+}
+
+void test_step_into() {
+    unsigned int num_rows = 20, num_cols = 30;
+    struct CellularAutomaton *automaton =
+        Cellular_init(num_rows, num_cols,
+                      CELLULAR_PANDEMY, CELLULAR_WRAP_AROUND, ".XH");
+    unsigned int distribution[] = {2, 1, 1};
+    Cellular_set_random(automaton, distribution);
     struct CellularAutomaton *next = Cellular_next(automaton);
-    CU_ASSERT_EQUAL(next->cells[0][0], '.');
-    CU_ASSERT_EQUAL(next->cells[0][1], '.');
-    CU_ASSERT_EQUAL(next->cells[0][2], '.');
-    CU_ASSERT_EQUAL(next->cells[1][0], 'X');
-    CU_ASSERT_EQUAL(next->cells[1][1], 'X');
-    CU_ASSERT_EQUAL(next->cells[1][2], 'X');
-    CU_ASSERT_EQUAL(next->cells[2][0], '.');
-    CU_ASSERT_EQUAL(next->cells[2][1], '.');
-    CU_ASSERT_EQUAL(next->cells[2][2], '.');
+    struct CellularAutomaton *into = Cellular_duplicate(automaton);
+    Cellular_step_into(automaton, into);
+    for (unsigned int i = 0; i < num_rows; ++i) {
+        for (unsigned int j = 0; j < num_cols; ++j) {
+            CU_ASSERT_EQUAL(next->cells[i][j], into->cells[i][j]);
+        }
+    }
     Cellular_free(automaton);
     Cellular_free(next);
+    Cellular_free(into);
+}
+
+void test_morton_order() {
+    struct CellularAutomaton *automaton =
+        Cellular_init(128, 192, CELLULAR_GAME_OF_LIFE, CELLULAR_TRUNCATE, ".X");
+    struct CellularAutomaton *tiles =
+        Cellular_duplicate_as(automaton, CELLULAR_MORTON);
+    // The tiles of the first two rows, along the Z-order curve
+    unsigned int order[] = {0, 1, 3, 4, 2, 5};
+    CU_ASSERT_EQUAL(tiles->num_tile_cols, 3);
+    CU_ASSERT_PTR_NULL(tiles->cells);
+    for (unsigned int k = 0; k < 6; ++k) {
+        CU_ASSERT_EQUAL(tiles->tile_order[k], order[k]);
+        CU_ASSERT_EQUAL((uintptr_t)(tiles->data + tiles->tile_offsets[k])
+                        % CELLULAR_ALIGNMENT, 0);
+    }
+    Cellular_free(automaton);
+    Cellular_free(tiles);
+}
+
+void test_morton_layout() {
+    unsigned int sizes[][2] = {{1, 1}, {70, 130}, {128, 64}};
+    enum CellularBoundary boundaries[] = {CELLULAR_TRUNCATE,
+                                          CELLULAR_WRAP_AROUND};
+    unsigned int distribution[] = {2, 1, 1};
+    for (unsigned int k = 0; k < 3; ++k) {
+        unsigned int num_rows = sizes[k][0], num_cols = sizes[k][1];
+        for (unsigned int b = 0; b < 2; ++b) {
+            struct CellularAutomaton *automaton =
+                Cellular_init(num_rows, num_cols,
+                              CELLULAR_PANDEMY, boundaries[b], ".XH");
+            Cellular_set_random(automaton, distribution);
+            struct CellularAutomaton *tiles =
+                Cellular_duplicate_as(automaton, CELLULAR_MORTON);
+            for (unsigned int step = 0; step < 3; ++step) {
+                struct CellularAutomaton *next = Cellular_next(automaton);
+                struct CellularAutomaton *tiles_next = Cellular_next(tiles);
+                Cellular_free(automaton);
+                Cellular_free(tiles);
+                automaton = next;
+                tiles = tiles_next;
+            }
+            struct CellularAutomaton *rows =
+                Cellular_duplicate_as(tiles, CELLULAR_ROW_MAJOR);
+            for (unsigned int i = 0; i < num_rows; ++i) {
+                for (unsigned int j = 0; j < num_cols; ++j) {
+                    CU_ASSERT_EQUAL(Cellular_get(tiles, i, j),
+                                    Cellular_get(automaton, i, j));
+                    CU_ASSERT_EQUAL(rows->cells[i][j],
+                                    automaton->cells[i][j]);
+                }
+            }
+            Cellular_free(automaton);
+            Cellular_free(tiles);
+            Cellular_free(rows);
+        }
+    }
 }
 
 int main() {
@@ -134,6 +328,23 @@ int main() {
         CU_cleanup_registry();
         return CU_get_error();
     }
+    if (CU_add_test(pSuite, "Random grids drawn from a seed",
+                    test_random_seeded) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Text of the grids
+    pSuite = CU_add_suite("Formatting the rows", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Rows formatted by each kernel",
+                    test_format) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
 
     // Consistent cellular automata
     pSuite = CU_add_suite("Consistent size and cells", NULL, NULL);
@@ -151,6 +362,16 @@ int main() {
         CU_cleanup_registry();
         return CU_get_error();
     }
+    if (CU_add_test(pSuite, "Testing states and allowed cells",
+                    test_states) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Testing contiguous storage",
+                    test_contiguous_storage) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
 
     // Automaton from another
     pSuite = CU_add_suite("Producing a new automaton", NULL, NULL);
@@ -168,6 +389,34 @@ int main() {
         CU_cleanup_registry();
         return CU_get_error();
     }
+    if (CU_add_test(pSuite, "Testing one-step simulation on a torus",
+                    test_wrap_around_simulation) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Testing step into another automaton",
+                    test_step_into) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Morton layout
+    pSuite = CU_add_suite("Storing the cells along a Z-order curve",
+                          NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Testing the order of the tiles",
+                    test_morton_order) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Testing simulation with the Morton layout",
+                    test_morton_layout) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
 
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();
@@ -0,0 +1,588 @@
+/**
+ * Testing the `engine` module with CUnit.
+ */
+#include <sys/socket.h>
+#include "engine.h"
+#include "CUnit/Basic.h"
+
+/**
+ * Checks that an engine produces the same steps as `Cellular_step_into`.
+ *
+ * @param type           The type of engine
+ * @param cellular_type  The type of cellular automaton
+ * @param allowed_cells  The allowed cells
+ * @param rulestring     The rule, or NULL for the default rule
+ * @param num_rows       The number of rows
+ * @param num_cols       The number of columns
+ * @param num_threads    The number of threads of the engine
+ */
+void check_engine(enum EngineType type,
+                  enum CellularType cellular_type,
+                  const char *allowed_cells,
+                  const char *rulestring,
+                  unsigned int num_rows,
+                  unsigned int num_cols,
+                  unsigned int num_threads) {
+    unsigned int distribution[] = {1, 1, 1, 1};
+    enum CellularBoundary boundaries[] = {CELLULAR_TRUNCATE,
+                                          CELLULAR_WRAP_AROUND};
+    for (unsigned int b = 0; b < 2; ++b) {
+        if (!Engine_supports(type, cellular_type, boundaries[b])) continue;
+        struct CellularAutomaton *automaton =
+            Cellular_init(num_rows, num_cols, cellular_type, boundaries[b],
+                          allowed_cells);
+        Cellular_set_random(automaton, distribution);
+        if (rulestring != NULL) {
+            CU_ASSERT_TRUE(Cellular_set_rule(automaton, rulestring));
+        }
+        struct CellularAutomaton *next = Cellular_duplicate(automaton);
+        struct Engine *engine = Engine_init(automaton, type, num_threads);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(engine);
+        for (unsigned int step = 0; step < 10; ++step) {
+            Engine_step(engine, step % 3);
+            for (unsigned int k = 0; k < step % 3; ++k) {
+                Cellular_step_into(automaton, next);
+                struct CellularAutomaton *previous = automaton;
+                automaton = next;
+                next = previous;
+            }
+            const struct CellularAutomaton *current = Engine_get(engine);
+            for (unsigned int i = 0; i < num_rows; ++i) {
+                for (unsigned int j = 0; j < num_cols; ++j) {
+                    CU_ASSERT_EQUAL(Cellular_get(current, i, j),
+                                    Cellular_get(automaton, i, j));
+                }
+            }
+        }
+        Engine_free(engine);
+        Cellular_free(automaton);
+        Cellular_free(next);
+    }
+}
+
+/**
+ * Checks that a blocked engine produces the same steps as
+ * `Cellular_step_into`, for both boundaries.
+ *
+ * @param cellular_type  The type of cellular automaton
+ * @param allowed_cells  The allowed cells
+ * @param num_rows       The number of rows
+ * @param num_cols       The number of columns
+ * @param depth          The number of steps per pass
+ * @param num_threads    The number of threads of the engine
+ */
+void check_blocked(enum CellularType cellular_type,
+                   const char *allowed_cells,
+                   unsigned int num_rows,
+                   unsigned int num_cols,
+                   unsigned int depth,
+                   unsigned int num_threads) {
+    unsigned int distribution[] = {1, 1, 1, 1};
+    enum CellularBoundary boundaries[] = {CELLULAR_TRUNCATE,
+                                          CELLULAR_WRAP_AROUND};
+    for (unsigned int b = 0; b < 2; ++b) {
+        struct CellularAutomaton *automaton =
+            Cellular_init(num_rows, num_cols, cellular_type, boundaries[b],
+                          allowed_cells);
+        Cellular_set_random(automaton, distribution);
+        struct CellularAutomaton *next = Cellular_duplicate(automaton);
+        struct Engine *engine = Engine_init(automaton, ENGINE_BLOCKED,
+                                            num_threads);
+        Engine_set_block_depth(engine, depth);
+        for (unsigned int jump = 0; jump < 3; ++jump) {
+            // Neither a multiple of the depth nor smaller than it
+            unsigned int num_steps = 2 * depth + 1;
+            Engine_step(engine, num_steps);
+            for (unsigned int k = 0; k < num_steps; ++k) {
+                Cellular_step_into(automaton, next);
+                struct CellularAutomaton *previous = automaton;
+                automaton = next;
+                next = previous;
+            }
+            const struct CellularAutomaton *current = Engine_get(engine);
+            for (unsigned int i = 0; i < num_rows; ++i) {
+                for (unsigned int j = 0; j < num_cols; ++j) {
+                    CU_ASSERT_EQUAL(Cellular_get(current, i, j),
+                                    Cellular_get(automaton, i, j));
+                }
+            }
+        }
+        Engine_free(engine);
+        Cellular_free(automaton);
+        Cellular_free(next);
+    }
+}
+
+void test_supports() {
+    CU_ASSERT_TRUE(Engine_supports(ENGINE_GENERIC, CELLULAR_FIRE,
+                                   CELLULAR_TRUNCATE));
+    CU_ASSERT_TRUE(Engine_supports(ENGINE_BITLIFE, CELLULAR_GAME_OF_LIFE,
+                                   CELLULAR_WRAP_AROUND));
+    CU_ASSERT_FALSE(Engine_supports(ENGINE_BITLIFE, CELLULAR_PANDEMY,
+                                    CELLULAR_TRUNCATE));
+    CU_ASSERT_TRUE(Engine_supports(ENGINE_HASHLIFE, CELLULAR_GAME_OF_LIFE,
+                                   CELLULAR_WRAP_AROUND));
+    CU_ASSERT_FALSE(Engine_supports(ENGINE_HASHLIFE, CELLULAR_GAME_OF_LIFE,
+                                    CELLULAR_TRUNCATE));
+    CU_ASSERT_TRUE(Engine_supports(ENGINE_AUTO, CELLULAR_PANDEMY,
+                                   CELLULAR_UNBOUNDED));
+    CU_ASSERT_FALSE(Engine_supports(ENGINE_SPARSE, CELLULAR_FIRE,
+                                    CELLULAR_UNBOUNDED));
+    CU_ASSERT_FALSE(Engine_supports(ENGINE_TILED, CELLULAR_GAME_OF_LIFE,
+                                    CELLULAR_UNBOUNDED));
+    CU_ASSERT_FALSE(Engine_supports(ENGINE_PROCESSES, CELLULAR_PANDEMY,
+                                    CELLULAR_UNBOUNDED));
+    CU_ASSERT_TRUE(Engine_supports(ENGINE_MEMOIZED, CELLULAR_FIRE,
+                                   CELLULAR_WRAP_AROUND));
+    CU_ASSERT_FALSE(Engine_supports(ENGINE_MEMOIZED, CELLULAR_PANDEMY,
+                                    CELLULAR_UNBOUNDED));
+    CU_ASSERT_TRUE(Engine_supports(ENGINE_FRONTIER, CELLULAR_FIRE,
+                                   CELLULAR_WRAP_AROUND));
+    CU_ASSERT_FALSE(Engine_supports(ENGINE_FRONTIER, CELLULAR_FIRE,
+                                    CELLULAR_UNBOUNDED));
+    CU_ASSERT_FALSE(Engine_supports(ENGINE_FRONTIER, CELLULAR_GAME_OF_LIFE,
+                                    CELLULAR_TRUNCATE));
+    struct CellularAutomaton *automaton =
+        Cellular_init(3, 3, CELLULAR_FIRE, CELLULAR_TRUNCATE, ".TFB");
+    CU_ASSERT_PTR_NULL(Engine_init(automaton, ENGINE_BITLIFE, 1));
+    struct Engine *engine = Engine_init(automaton, ENGINE_AUTO, 1);
+    CU_ASSERT_STRING_EQUAL(Engine_name(engine), "generic");
+    Engine_free(engine);
+    Cellular_free(automaton);
+}
+
+void test_generic() {
+    check_engine(ENGINE_GENERIC, CELLULAR_PANDEMY, ".XH", NULL, 7, 9, 1);
+    check_engine(ENGINE_GENERIC, CELLULAR_FIRE, ".TFB", NULL, 9, 7, 1);
+}
+
+void test_bitlife() {
+    unsigned int sizes[][2] = {{1, 1}, {3, 70}, {65, 128}, {33, 129}};
+    for (unsigned int k = 0; k < 4; ++k) {
+        check_engine(ENGINE_BITLIFE, CELLULAR_GAME_OF_LIFE, ".X", NULL,
+                     sizes[k][0], sizes[k][1], 1);
+    }
+}
+
+void test_threads() {
+    for (unsigned int num_threads = 2; num_threads <= 5; ++num_threads) {
+        check_engine(ENGINE_GENERIC, CELLULAR_PANDEMY, ".XH", NULL, 7, 9,
+                     num_threads);
+        check_engine(ENGINE_GENERIC, CELLULAR_FIRE, ".TFB", NULL, 2, 7,
+                     num_threads);
+        check_engine(ENGINE_BITLIFE, CELLULAR_GAME_OF_LIFE, ".X", NULL,
+                     17, 100, num_threads);
+    }
+}
+
+void test_tiled() {
+    unsigned int sizes[][2] = {{1, 1}, {64, 64}, {65, 130}, {200, 70}};
+    for (unsigned int k = 0; k < 4; ++k) {
+        for (unsigned int num_threads = 1; num_threads <= 3; ++num_threads) {
+            check_engine(ENGINE_TILED, CELLULAR_GAME_OF_LIFE, ".X", NULL,
+                         sizes[k][0], sizes[k][1], num_threads);
+            check_engine(ENGINE_TILED, CELLULAR_PANDEMY, ".XH", NULL,
+                         sizes[k][0], sizes[k][1], num_threads);
+            check_engine(ENGINE_TILED, CELLULAR_FIRE, ".TFB", NULL,
+                         sizes[k][0], sizes[k][1], num_threads);
+        }
+    }
+}
+
+void test_hashlife() {
+    unsigned int sizes[][2] = {{1, 1}, {8, 8}, {16, 16}, {64, 64},
+                               {13, 40}, {70, 33}};
+    for (unsigned int k = 0; k < 6; ++k) {
+        check_engine(ENGINE_HASHLIFE, CELLULAR_GAME_OF_LIFE, ".X", NULL,
+                     sizes[k][0], sizes[k][1], 1);
+        check_engine(ENGINE_HASHLIFE, CELLULAR_GAME_OF_LIFE, ".X", "B36/S23",
+                     sizes[k][0], sizes[k][1], 1);
+    }
+}
+
+void test_blocked() {
+    unsigned int sizes[][2] = {{1, 1}, {3, 5}, {64, 256}, {130, 300}};
+    unsigned int depths[] = {1, 4, 7};
+    for (unsigned int k = 0; k < 4; ++k) {
+        for (unsigned int d = 0; d < 3; ++d) {
+            check_blocked(CELLULAR_GAME_OF_LIFE, ".X", sizes[k][0],
+                          sizes[k][1], depths[d], 1);
+            check_blocked(CELLULAR_PANDEMY, ".XH", sizes[k][0],
+                          sizes[k][1], depths[d], 1);
+            check_blocked(CELLULAR_FIRE, ".TFB", sizes[k][0],
+                          sizes[k][1], depths[d], 1);
+        }
+    }
+    check_engine(ENGINE_BLOCKED, CELLULAR_GAME_OF_LIFE, ".X", NULL, 70, 80, 1);
+    check_blocked(CELLULAR_PANDEMY, ".XH", 200, 600, BLOCKING_MAX_DEPTH, 3);
+}
+
+void test_sparse() {
+    // A glider crossing the window of the plane, then leaving it
+    struct CellularAutomaton *automaton =
+        Cellular_init(40, 40, CELLULAR_GAME_OF_LIFE, CELLULAR_UNBOUNDED, ".X");
+    unsigned int distribution[] = {1, 0};
+    Cellular_set_random(automaton, distribution);
+    Cellular_set(automaton, 0, 1, 'X');
+    Cellular_set(automaton, 1, 2, 'X');
+    Cellular_set(automaton, 2, 0, 'X');
+    Cellular_set(automaton, 2, 1, 'X');
+    Cellular_set(automaton, 2, 2, 'X');
+    struct Engine *engine = Engine_init(automaton, ENGINE_AUTO, 1);
+    CU_ASSERT_STRING_EQUAL(Engine_name(engine), "sparse");
+    Engine_step(engine, 4 * 30);
+    const struct CellularAutomaton *current = Engine_get(engine);
+    for (unsigned int i = 0; i < 40; ++i) {
+        for (unsigned int j = 0; j < 40; ++j) {
+            char expected = i >= 30 && j >= 30 && i < 33 && j < 33
+                          ? Cellular_get(automaton, i - 30, j - 30) : '.';
+            CU_ASSERT_EQUAL(Cellular_get(current, i, j), expected);
+        }
+    }
+    Engine_step(engine, 4 * 10);
+    current = Engine_get(engine);
+    for (unsigned int i = 0; i < 40; ++i) {
+        for (unsigned int j = 0; j < 40; ++j) {
+            CU_ASSERT_EQUAL(Cellular_get(current, i, j), '.');
+        }
+    }
+    Engine_free(engine);
+    Cellular_free(automaton);
+}
+
+void test_tiled_stats() {
+    // A single blinker in the corner of a 3 x 3 grid of tiles
+    struct CellularAutomaton *automaton =
+        Cellular_init(3 * TILING_TILE_ROWS, 3 * TILING_TILE_COLS,
+                      CELLULAR_GAME_OF_LIFE, CELLULAR_TRUNCATE, ".X");
+    unsigned int distribution[] = {1, 0};
+    Cellular_set_random(automaton, distribution);
+    for (unsigned int j = 0; j < 3; ++j) {
+        Cellular_set(automaton, 10, 10 + j, 'X');
+    }
+    struct Engine *engine = Engine_init(automaton, ENGINE_TILED, 1);
+    Engine_step(engine, 1);
+    CU_ASSERT_EQUAL(engine->last_step.num_active_tiles, 9);
+    CU_ASSERT_EQUAL(engine->last_step.num_tiles, 9);
+    Engine_step(engine, 1);
+    CU_ASSERT_EQUAL(engine->last_step.num_active_tiles, 4);
+    Engine_step(engine, 2);
+    CU_ASSERT_EQUAL(engine->last_step.num_active_tiles, 4);
+    CU_ASSERT_EQUAL(engine->all_steps.num_active_tiles, 9 + 3 * 4);
+    CU_ASSERT_EQUAL(engine->all_steps.num_tiles, 4 * 9);
+    CU_ASSERT_DOUBLE_EQUAL(Engine_active_fraction(&engine->last_step),
+                           4.0 / 9, 1e-9);
+    CU_ASSERT_EQUAL(Cellular_get(Engine_get(engine), 9, 11), '.');
+    CU_ASSERT_EQUAL(Cellular_get(Engine_get(engine), 10, 10), 'X');
+    Engine_free(engine);
+    Cellular_free(automaton);
+}
+
+void test_bitlife_rules() {
+    const char *rulestrings[] = {"B36/S23", "B0/S8", "B2/S", "B1357/S1357",
+                                 "B012345678/S012345678"};
+    for (unsigned int r = 0; r < 5; ++r) {
+        check_engine(ENGINE_BITLIFE, CELLULAR_GAME_OF_LIFE, ".X",
+                     rulestrings[r], 5, 70, 1);
+    }
+}
+
+void test_processes() {
+    unsigned int sizes[][2] = {{1, 1}, {3, 5}, {70, 130}};
+    unsigned int num_workers[] = {1, 2, 3, 8};
+    for (unsigned int k = 0; k < 3; ++k) {
+        for (unsigned int w = 0; w < 4; ++w) {
+            check_engine(ENGINE_PROCESSES, CELLULAR_PANDEMY, ".XH", NULL,
+                         sizes[k][0], sizes[k][1], num_workers[w]);
+            check_engine(ENGINE_PROCESSES, CELLULAR_FIRE, ".TFB", NULL,
+                         sizes[k][0], sizes[k][1], num_workers[w]);
+        }
+    }
+    check_engine(ENGINE_PROCESSES, CELLULAR_GAME_OF_LIFE, ".X", "B36/S23",
+                 40, 50, 4);
+}
+
+void test_failed_process() {
+    unsigned int distribution[] = {1, 1, 1};
+    struct CellularAutomaton *automaton =
+        Cellular_init(30, 20, CELLULAR_PANDEMY, CELLULAR_WRAP_AROUND, ".XH");
+    Cellular_set_random_seeded(automaton, distribution, 17, 1);
+    struct Engine *engine = Engine_init(automaton, ENGINE_PROCESSES, 3);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(engine);
+    Engine_step(engine, 2);
+    CU_ASSERT_FALSE(engine->has_failed);
+    struct CellularAutomaton *expected = Cellular_duplicate(Engine_get(engine));
+
+    // The second worker exits with a failure on an empty call, while the
+    // others wait for its halo rows until they are killed
+    unsigned int num_steps = 0;
+    struct Domain *domain = engine->domain;
+    CU_ASSERT_EQUAL(send(domain->channels[1], &num_steps, sizeof(num_steps),
+                         0), sizeof(num_steps));
+    Engine_step(engine, 3);
+    CU_ASSERT_TRUE(engine->has_failed);
+    CU_ASSERT_TRUE(domain->has_failed);
+    for (unsigned int k = 0; k < domain->num_workers; ++k) {
+        CU_ASSERT_EQUAL(domain->pids[k], 0);
+    }
+    CU_ASSERT_FALSE(Domain_step(domain, 1));
+    // The states are those before the failed steps
+    Domain_store(domain, automaton);
+    for (unsigned int i = 0; i < 30; ++i) {
+        for (unsigned int j = 0; j < 20; ++j) {
+            CU_ASSERT_EQUAL(Cellular_get(automaton, i, j),
+                            Cellular_get(expected, i, j));
+        }
+    }
+    Engine_free(engine);
+    Cellular_free(expected);
+    Cellular_free(automaton);
+}
+
+void test_memoized() {
+    unsigned int sizes[][2] = {{1, 1}, {3, 5}, {8, 12}, {70, 130}};
+    for (unsigned int k = 0; k < 4; ++k) {
+        check_engine(ENGINE_MEMOIZED, CELLULAR_GAME_OF_LIFE, ".X", NULL,
+                     sizes[k][0], sizes[k][1], 1);
+        check_engine(ENGINE_MEMOIZED, CELLULAR_PANDEMY, ".XH", NULL,
+                     sizes[k][0], sizes[k][1], 1);
+        check_engine(ENGINE_MEMOIZED, CELLULAR_FIRE, ".TFB", NULL,
+                     sizes[k][0], sizes[k][1], 3);
+    }
+    check_engine(ENGINE_MEMOIZED, CELLULAR_GAME_OF_LIFE, ".X", "B36/S23",
+                 41, 67, 4);
+
+    // Every tile of a uniform periodic grid hits the single cached entry,
+    // after the first miss
+    struct CellularAutomaton *automaton =
+        Cellular_init(64, 64, CELLULAR_FIRE, CELLULAR_WRAP_AROUND, ".TFB");
+    unsigned int distribution[] = {0, 1, 0, 0};
+    Cellular_set_random(automaton, distribution);
+    struct Engine *engine = Engine_init(automaton, ENGINE_MEMOIZED, 1);
+    Engine_step(engine, 3);
+    struct MemoStats stats;
+    Engine_get_cache_stats(engine, &stats);
+    CU_ASSERT_EQUAL(stats.num_lookups, 3 * 16 * 16);
+    CU_ASSERT_EQUAL(stats.num_entries, 1);
+    CU_ASSERT_EQUAL(stats.num_hits, 3 * 16 * 16 - 1);
+    CU_ASSERT_EQUAL(engine->last_step.num_active_tiles, 0);
+    CU_ASSERT_TRUE(stats.memory_size > 0);
+    Engine_free(engine);
+    Cellular_free(automaton);
+}
+
+void test_frontier() {
+    unsigned int sizes[][2] = {{1, 1}, {1, 2}, {2, 3}, {9, 7}, {45, 95}};
+    for (unsigned int k = 0; k < 5; ++k) {
+        check_engine(ENGINE_FRONTIER, CELLULAR_FIRE, ".TFB", NULL,
+                     sizes[k][0], sizes[k][1], 1);
+    }
+
+    // Only the burning cells are counted as active, in a forest where the
+    // fire spreads to the 8 neighbors of each of them
+    unsigned int trees[] = {0, 1, 0, 0};
+    struct CellularAutomaton *automaton =
+        Cellular_init(10, 10, CELLULAR_FIRE, CELLULAR_TRUNCATE, ".TFB");
+    Cellular_set_random_seeded(automaton, trees, 1, 1);
+    Cellular_set(automaton, 2, 3, 'F');
+    Cellular_set(automaton, 7, 7, 'F');
+    struct Engine *engine = Engine_init(automaton, ENGINE_FRONTIER, 1);
+    Engine_step(engine, 1);
+    CU_ASSERT_EQUAL(engine->last_step.num_active_tiles, 2);
+    CU_ASSERT_EQUAL(engine->last_step.num_tiles, 100);
+    const struct CellularAutomaton *current = Engine_get(engine);
+    unsigned int num_burning = 0;
+    for (unsigned int i = 0; i < 10; ++i) {
+        for (unsigned int j = 0; j < 10; ++j) {
+            num_burning += Cellular_get(current, i, j) == 'F';
+        }
+    }
+    CU_ASSERT_EQUAL(num_burning, 16);
+    Engine_step(engine, 1);
+    CU_ASSERT_EQUAL(engine->last_step.num_active_tiles, 16);
+    CU_ASSERT_EQUAL(engine->last_step.num_tiles, 100);
+    Engine_free(engine);
+    Cellular_free(automaton);
+}
+
+void test_morton() {
+    enum EngineType types[] = {ENGINE_GENERIC, ENGINE_BITLIFE, ENGINE_TILED,
+                               ENGINE_HASHLIFE, ENGINE_SPARSE, ENGINE_BLOCKED,
+                               ENGINE_MEMOIZED};
+    enum CellularBoundary boundaries[] = {CELLULAR_TRUNCATE,
+                                          CELLULAR_WRAP_AROUND,
+                                          CELLULAR_UNBOUNDED};
+    unsigned int sizes[][2] = {{70, 130}, {128, 128}};
+    unsigned int distribution[] = {1, 1};
+    for (unsigned int t = 0; t < 7; ++t) {
+        for (unsigned int b = 0; b < 3; ++b) {
+            if (!Engine_supports(types[t], CELLULAR_GAME_OF_LIFE,
+                                 boundaries[b])) continue;
+            for (unsigned int k = 0; k < 2; ++k) {
+                struct CellularAutomaton *automaton =
+                    Cellular_init(sizes[k][0], sizes[k][1],
+                                  CELLULAR_GAME_OF_LIFE, boundaries[b], ".X");
+                Cellular_set_random(automaton, distribution);
+                struct CellularAutomaton *tiles =
+                    Cellular_duplicate_as(automaton, CELLULAR_MORTON);
+                struct Engine *expected = Engine_init(automaton, types[t], 2);
+                struct Engine *engine = Engine_init(tiles, types[t], 2);
+                Engine_step(expected, 5);
+                Engine_step(engine, 5);
+                const struct CellularAutomaton *current = Engine_get(engine);
+                CU_ASSERT_EQUAL(current->layout, CELLULAR_MORTON);
+                for (unsigned int i = 0; i < sizes[k][0]; ++i) {
+                    for (unsigned int j = 0; j < sizes[k][1]; ++j) {
+                        CU_ASSERT_EQUAL(Cellular_get(current, i, j),
+                                        Cellular_get(Engine_get(expected),
+                                                     i, j));
+                    }
+                }
+                Engine_free(expected);
+                Engine_free(engine);
+                Cellular_free(automaton);
+                Cellular_free(tiles);
+            }
+        }
+    }
+}
+
+void test_placed() {
+    enum EngineType types[] = {ENGINE_GENERIC, ENGINE_BITLIFE, ENGINE_TILED,
+                               ENGINE_BLOCKED, ENGINE_HASHLIFE};
+    enum CellularLayout layouts[] = {CELLULAR_ROW_MAJOR, CELLULAR_MORTON};
+    unsigned int distribution[] = {1, 1};
+    Numa_set_huge_pages(true);
+    for (unsigned int t = 0; t < 5; ++t) {
+        for (unsigned int l = 0; l < 2; ++l) {
+            struct CellularAutomaton *automaton =
+                Cellular_init(130, 70, CELLULAR_GAME_OF_LIFE,
+                              CELLULAR_WRAP_AROUND, ".X");
+            Cellular_set_random(automaton, distribution);
+            struct CellularAutomaton *copy =
+                Cellular_duplicate_as(automaton, layouts[l]);
+            struct Engine *expected = Engine_init(automaton, types[t], 3);
+            struct Engine *engine = Engine_init(copy, types[t], 3);
+            Engine_step(expected, 2);
+            Engine_step(engine, 2);
+            Engine_place(engine);
+            CU_ASSERT_PTR_NOT_NULL_FATAL(engine->topology);
+            for (unsigned int k = 0; k < engine->pool->num_threads; ++k) {
+                CU_ASSERT_TRUE(engine->cpus[k] >= -1);
+            }
+            Engine_step(expected, 5);
+            Engine_step(engine, 5);
+            const struct CellularAutomaton *current = Engine_get(engine);
+            for (unsigned int i = 0; i < 130; ++i) {
+                for (unsigned int j = 0; j < 70; ++j) {
+                    CU_ASSERT_EQUAL(Cellular_get(current, i, j),
+                                    Cellular_get(Engine_get(expected), i, j));
+                }
+            }
+            Engine_free(expected);
+            Engine_free(engine);
+            Cellular_free(automaton);
+            Cellular_free(copy);
+        }
+    }
+    Numa_set_huge_pages(false);
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Engines
+    pSuite = CU_add_suite("Engines", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Supported automata",
+                    test_supports) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Generic engine",
+                    test_generic) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Bit-parallel game of life",
+                    test_bitlife) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Bit-parallel Life-like rules",
+                    test_bitlife_rules) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Tiled engine",
+                    test_tiled) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Hashlife engine",
+                    test_hashlife) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Temporally blocked engine",
+                    test_blocked) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Sparse engine on an unbounded plane",
+                    test_sparse) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Tiled engine statistics",
+                    test_tiled_stats) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Multi-process engine",
+                    test_processes) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Failed worker process",
+                    test_failed_process) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Memoized engine",
+                    test_memoized) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Frontier engine",
+                    test_frontier) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Engines on the Morton layout",
+                    test_morton) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Engines placed on the NUMA nodes",
+                    test_placed) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Multithreaded engines",
+                    test_threads) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
@@ -0,0 +1,218 @@
+/**
+ * Testing the `ensemble` module with CUnit.
+ */
+#include <stdlib.h>
+#include "ensemble.h"
+#include "random.h"
+#include "stencil.h"
+#include "CUnit/Basic.h"
+
+/**
+ * Checks that the members of an ensemble follow the same steps as
+ * `Cellular_step_into` on each of them.
+ *
+ * @param type           The type of cellular automaton
+ * @param boundary       The boundary
+ * @param allowed_cells  The allowed cells
+ * @param rulestring     The rule, or NULL for the default rule
+ * @param num_rows       The number of rows
+ * @param num_cols       The number of columns
+ * @param num_members    The number of members
+ */
+void check_ensemble(enum CellularType type,
+                    enum CellularBoundary boundary,
+                    const char *allowed_cells,
+                    const char *rulestring,
+                    unsigned int num_rows,
+                    unsigned int num_cols,
+                    unsigned int num_members) {
+    const uint64_t seed = 2024;
+    unsigned int distribution[] = {2, 1, 1, 1};
+    struct CellularAutomaton **members =
+        malloc(num_members * sizeof(struct CellularAutomaton*));
+    for (unsigned int m = 0; m < num_members; ++m) {
+        members[m] = Cellular_init(num_rows, num_cols, type, boundary,
+                                   allowed_cells);
+        // Each member is drawn apart, so that the bit lanes differ
+        Cellular_set_random_seeded(members[m], distribution,
+                                   Random_get(seed, m), 1);
+        if (rulestring != NULL) {
+            CU_ASSERT_TRUE(Cellular_set_rule(members[m], rulestring));
+        }
+    }
+    struct Ensemble *ensemble =
+        Ensemble_init((const struct CellularAutomaton *const *)members,
+                      num_members);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(ensemble);
+    struct CellularAutomaton *next = Cellular_duplicate(members[0]);
+    struct CellularAutomaton *stored = Cellular_duplicate(members[0]);
+    for (unsigned int step = 0; step < 6; ++step) {
+        Ensemble_step(ensemble);
+        for (unsigned int m = 0; m < num_members; ++m) {
+            Cellular_step_into(members[m], next);
+            struct CellularAutomaton *previous = members[m];
+            members[m] = next;
+            next = previous;
+            Ensemble_store(ensemble, m, stored);
+            for (unsigned int i = 0; i < num_rows; ++i) {
+                for (unsigned int j = 0; j < num_cols; ++j) {
+                    CU_ASSERT_EQUAL(Cellular_get(stored, i, j),
+                                    Cellular_get(members[m], i, j));
+                }
+            }
+        }
+    }
+    Ensemble_free(ensemble);
+    for (unsigned int m = 0; m < num_members; ++m) {
+        Cellular_free(members[m]);
+    }
+    Cellular_free(next);
+    Cellular_free(stored);
+    free(members);
+}
+
+/**
+ * Checks an ensemble of each type, for both boundaries.
+ *
+ * @param num_rows     The number of rows
+ * @param num_cols     The number of columns
+ * @param num_members  The number of members
+ */
+void check_types(unsigned int num_rows,
+                 unsigned int num_cols,
+                 unsigned int num_members) {
+    enum CellularBoundary boundaries[] = {CELLULAR_TRUNCATE,
+                                          CELLULAR_WRAP_AROUND};
+    for (unsigned int b = 0; b < 2; ++b) {
+        check_ensemble(CELLULAR_GAME_OF_LIFE, boundaries[b], ".X", NULL,
+                       num_rows, num_cols, num_members);
+        check_ensemble(CELLULAR_PANDEMY, boundaries[b], ".XH", NULL,
+                       num_rows, num_cols, num_members);
+        check_ensemble(CELLULAR_FIRE, boundaries[b], ".TFB", NULL,
+                       num_rows, num_cols, num_members);
+    }
+}
+
+void test_types() {
+    check_types(1, 1, 1);
+    check_types(2, 3, 5);
+    check_types(9, 7, 64);
+    check_types(13, 17, 70);
+}
+
+void test_rules() {
+    const char *rules[] = {"B36/S23", "B0/S8", "B2/S", "B1357/S02468"};
+    for (unsigned int r = 0; r < 4; ++r) {
+        check_ensemble(CELLULAR_GAME_OF_LIFE, CELLULAR_TRUNCATE, ".X",
+                       rules[r], 8, 9, 65);
+        check_ensemble(CELLULAR_GAME_OF_LIFE, CELLULAR_WRAP_AROUND, ".X",
+                       rules[r], 8, 9, 3);
+    }
+}
+
+void test_kernels() {
+    enum StencilKernel best = Stencil_current();
+    for (int kernel = 0; kernel < STENCIL_NUM_KERNELS; ++kernel) {
+        if (!Stencil_use(kernel)) continue;
+        check_types(6, 11, 300);
+    }
+    Stencil_use(best);
+}
+
+void test_different() {
+    struct CellularAutomaton *members[3];
+    members[0] = Cellular_init(4, 5, CELLULAR_PANDEMY, CELLULAR_TRUNCATE,
+                               ".XH");
+    members[1] = Cellular_init(4, 5, CELLULAR_PANDEMY, CELLULAR_TRUNCATE,
+                               "abc");
+    members[2] = Cellular_init(4, 6, CELLULAR_PANDEMY, CELLULAR_TRUNCATE,
+                               ".XH");
+    const struct CellularAutomaton *const *all =
+        (const struct CellularAutomaton *const *)members;
+    struct Ensemble *ensemble = Ensemble_init(all, 2);
+    CU_ASSERT_PTR_NOT_NULL(ensemble);
+    Ensemble_free(ensemble);
+    CU_ASSERT_PTR_NULL(Ensemble_init(all, 3));
+    for (unsigned int m = 0; m < 3; ++m) {
+        Cellular_free(members[m]);
+    }
+
+    members[0] = Cellular_init(4, 5, CELLULAR_GAME_OF_LIFE,
+                               CELLULAR_TRUNCATE, ".X");
+    members[1] = Cellular_init(4, 5, CELLULAR_GAME_OF_LIFE,
+                               CELLULAR_TRUNCATE, ".X");
+    members[2] = Cellular_init(4, 5, CELLULAR_GAME_OF_LIFE,
+                               CELLULAR_WRAP_AROUND, ".X");
+    Cellular_set_rule(members[1], "B36/S23");
+    CU_ASSERT_PTR_NULL(Ensemble_init(all, 2));
+    CU_ASSERT_PTR_NULL(Ensemble_init(all + 1, 2));
+    for (unsigned int m = 0; m < 3; ++m) {
+        Cellular_free(members[m]);
+    }
+}
+
+void test_circuit() {
+    // A fire only counts the burning neighbors
+    struct CellularAutomaton *automaton =
+        Cellular_init(3, 3, CELLULAR_FIRE, CELLULAR_TRUNCATE, ".TFB");
+    const struct CellularAutomaton *members[] = {automaton};
+    struct Ensemble *ensemble = Ensemble_init(members, 1);
+    CU_ASSERT_EQUAL(ensemble->num_planes, 2);
+    CU_ASSERT_EQUAL(ensemble->num_counts, 1);
+    CU_ASSERT_EQUAL(ensemble->counts[0], CELLULAR_FIRE_BURNING);
+    CU_ASSERT_EQUAL(ensemble->num_words, ENSEMBLE_VECTOR_SIZE);
+    Ensemble_free(ensemble);
+    Cellular_free(automaton);
+
+    automaton = Cellular_init(3, 3, CELLULAR_PANDEMY, CELLULAR_TRUNCATE,
+                              ".XH");
+    members[0] = automaton;
+    ensemble = Ensemble_init(members, 1);
+    CU_ASSERT_EQUAL(ensemble->num_counts, 2);
+    Ensemble_free(ensemble);
+    Cellular_free(automaton);
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Bit-sliced ensembles
+    pSuite = CU_add_suite("Bit-sliced ensembles", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Members of each type",
+                    test_types) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Life-like rules",
+                    test_rules) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Every neighbor-counting kernel",
+                    test_kernels) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Members that differ",
+                    test_different) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Compiled circuits",
+                    test_circuit) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
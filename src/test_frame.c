@@ -0,0 +1,106 @@
+/**
+ * Testing the `frame` module with CUnit.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "frame.h"
+#include "CUnit/Basic.h"
+
+/**
+ * Writes a frame to a temporary file and reads it back.
+ *
+ * @param frame  The frame, emptied
+ * @param size   The number of characters read
+ * @return       The characters, to free
+ */
+char *read_back(struct Frame *frame, size_t *size) {
+    FILE *stream = tmpfile();
+    Frame_write(frame, stream);
+    *size = ftell(stream);
+    rewind(stream);
+    char *text = malloc(*size + 1);
+    CU_ASSERT_EQUAL(fread(text, 1, *size, stream), *size);
+    text[*size] = '\0';
+    fclose(stream);
+    return text;
+}
+
+void test_printf() {
+    struct Frame *frame = Frame_init(1);
+    Frame_printf(frame, "Step %d\n", 12);
+    // Longer than the initial capacity
+    char *long_text = malloc(10001);
+    memset(long_text, 'a', 10000);
+    long_text[10000] = '\0';
+    Frame_printf(frame, "%s", long_text);
+    Frame_printf(frame, "%c", '!');
+    size_t size;
+    char *text = read_back(frame, &size);
+    CU_ASSERT_EQUAL(size, 8 + 10000 + 1);
+    CU_ASSERT_EQUAL(strncmp(text, "Step 12\naaa", 11), 0);
+    CU_ASSERT_EQUAL(text[size - 1], '!');
+    CU_ASSERT_EQUAL(frame->size, 0);
+    free(text);
+    free(long_text);
+    Frame_free(frame);
+}
+
+void test_grids() {
+    unsigned int distribution[] = {1, 1, 1};
+    unsigned int sizes[][2] = {{0, 4}, {3, 0}, {2, 5}, {1100, 1000}};
+    for (unsigned int k = 0; k < 4; ++k) {
+        struct CellularAutomaton *automaton =
+            Cellular_init(sizes[k][0], sizes[k][1], CELLULAR_PANDEMY,
+                          CELLULAR_TRUNCATE, ".XH");
+        Cellular_set_random_seeded(automaton, distribution, k, 1);
+        size_t expected_size = Cellular_text_size(automaton);
+        char *expected = malloc(expected_size + 1);
+        Cellular_format_rows(automaton, 0, sizes[k][0], expected);
+        unsigned int num_threads[] = {1, 3};
+        for (unsigned int t = 0; t < 2; ++t) {
+            struct Frame *frame = Frame_init(num_threads[t]);
+            for (unsigned int step = 0; step < 2; ++step) {
+                Frame_printf(frame, "Step %u\n", step);
+                Frame_add_grid(frame, automaton);
+                size_t size;
+                char *text = read_back(frame, &size);
+                CU_ASSERT_EQUAL(size, 7 + expected_size);
+                CU_ASSERT_EQUAL(text[5], (char)('0' + step));
+                CU_ASSERT_EQUAL(memcmp(text + 7, expected, expected_size), 0);
+                free(text);
+            }
+            Frame_free(frame);
+        }
+        free(expected);
+        Cellular_free(automaton);
+    }
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Frames
+    pSuite = CU_add_suite("Frames written at once", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Formatted text",
+                    test_printf) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Grids formatted by several threads",
+                    test_grids) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
@@ -0,0 +1,167 @@
+/**
+ * Testing the `frontier` module with CUnit.
+ */
+#include "frontier.h"
+#include "stencil.h"
+#include "CUnit/Basic.h"
+
+/**
+ * Returns a forest of ignitable cells with a single burning cell.
+ *
+ * @param num_rows  The number of rows
+ * @param num_cols  The number of columns
+ * @param boundary  The boundary type
+ * @param row       The row of the burning cell
+ * @param col       The column of the burning cell
+ * @return          The automaton
+ */
+struct CellularAutomaton *forest(unsigned int num_rows,
+                                 unsigned int num_cols,
+                                 enum CellularBoundary boundary,
+                                 unsigned int row,
+                                 unsigned int col) {
+    struct CellularAutomaton *automaton =
+        Cellular_init(num_rows, num_cols, CELLULAR_FIRE, boundary, ".TFB");
+    for (unsigned int i = 0; i < num_rows; ++i) {
+        for (unsigned int j = 0; j < num_cols; ++j) {
+            Cellular_set(automaton, i, j, 'T');
+        }
+    }
+    Cellular_set(automaton, row, col, 'F');
+    return automaton;
+}
+
+/**
+ * Checks that the steps of a fire are those of `Cellular_step_into`.
+ *
+ * @param automaton  The automaton of the fire
+ * @param num_steps  The number of steps
+ */
+void check_steps(const struct CellularAutomaton *automaton,
+                 unsigned int num_steps) {
+    struct CellularAutomaton *current = Cellular_duplicate(automaton);
+    struct CellularAutomaton *next = Cellular_duplicate(automaton);
+    struct CellularAutomaton *stored = Cellular_duplicate(automaton);
+    struct Frontier *frontier = Frontier_init(automaton);
+    for (unsigned int step = 0; step < num_steps; ++step) {
+        Frontier_step(frontier);
+        Cellular_step_into(current, next);
+        struct CellularAutomaton *previous = current;
+        current = next;
+        next = previous;
+        Frontier_store(frontier, stored);
+        for (unsigned int i = 0; i < automaton->num_rows; ++i) {
+            for (unsigned int j = 0; j < automaton->num_cols; ++j) {
+                CU_ASSERT_EQUAL(Cellular_get(stored, i, j),
+                                Cellular_get(current, i, j));
+            }
+        }
+    }
+    Frontier_free(frontier);
+    Cellular_free(current);
+    Cellular_free(next);
+    Cellular_free(stored);
+}
+
+void test_spread() {
+    struct CellularAutomaton *automaton =
+        forest(5, 7, CELLULAR_TRUNCATE, 2, 3);
+    struct Frontier *frontier = Frontier_init(automaton);
+    CU_ASSERT_EQUAL(frontier->num_burning, 1);
+    Frontier_step(frontier);
+    CU_ASSERT_EQUAL(frontier->num_burning, 8);
+    Frontier_step(frontier);
+    CU_ASSERT_EQUAL(frontier->num_burning, 16);
+    Frontier_store(frontier, automaton);
+    CU_ASSERT_EQUAL(Cellular_get(automaton, 2, 3), '.');
+    CU_ASSERT_EQUAL(Cellular_get(automaton, 1, 2), 'B');
+    CU_ASSERT_EQUAL(Cellular_get(automaton, 0, 1), 'F');
+    CU_ASSERT_EQUAL(Cellular_get(automaton, 0, 0), 'T');
+    Frontier_free(frontier);
+    Cellular_free(automaton);
+
+    // The fire crosses the edges of a torus
+    automaton = forest(4, 6, CELLULAR_WRAP_AROUND, 0, 0);
+    frontier = Frontier_init(automaton);
+    Frontier_step(frontier);
+    Frontier_store(frontier, automaton);
+    CU_ASSERT_EQUAL(Cellular_get(automaton, 3, 5), 'F');
+    CU_ASSERT_EQUAL(Cellular_get(automaton, 1, 1), 'F');
+    CU_ASSERT_EQUAL(Cellular_get(automaton, 2, 3), 'T');
+    Frontier_free(frontier);
+    Cellular_free(automaton);
+}
+
+void test_extinct() {
+    struct CellularAutomaton *automaton =
+        forest(3, 3, CELLULAR_TRUNCATE, 1, 1);
+    for (unsigned int j = 0; j < 3; ++j) {
+        Cellular_set(automaton, 0, j, '.');
+        Cellular_set(automaton, 2, j, '.');
+    }
+    Cellular_set(automaton, 1, 0, '.');
+    Cellular_set(automaton, 1, 2, '.');
+    struct Frontier *frontier = Frontier_init(automaton);
+    Frontier_step(frontier);
+    CU_ASSERT_EQUAL(frontier->num_burning, 0);
+    Frontier_step(frontier);
+    CU_ASSERT_EQUAL(frontier->num_burning, 0);
+    check_steps(automaton, 6);
+    Frontier_free(frontier);
+    Cellular_free(automaton);
+}
+
+void test_random() {
+    unsigned int distribution[] = {1, 4, 1, 1};
+    unsigned int sizes[][2] = {{1, 1}, {1, 3}, {2, 2}, {17, 33}, {64, 40}};
+    enum CellularBoundary boundaries[] = {CELLULAR_TRUNCATE,
+                                          CELLULAR_WRAP_AROUND};
+    enum StencilKernel kernels[] = {STENCIL_SCALAR, Stencil_current()};
+    for (unsigned int s = 0; s < 2; ++s) {
+        Stencil_use(kernels[s]);
+        for (unsigned int k = 0; k < 5; ++k) {
+            for (unsigned int b = 0; b < 2; ++b) {
+                struct CellularAutomaton *automaton =
+                    Cellular_init(sizes[k][0], sizes[k][1], CELLULAR_FIRE,
+                                  boundaries[b], ".TFB");
+                Cellular_set_random(automaton, distribution);
+                check_steps(automaton, 12);
+                Cellular_free(automaton);
+            }
+        }
+    }
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Frontier of a fire
+    pSuite = CU_add_suite("Frontier of a fire", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Fire spreading from a single cell",
+                    test_spread) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Fire dying out",
+                    test_extinct) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Random fires",
+                    test_random) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
@@ -0,0 +1,119 @@
+/**
+ * Testing the `hashlife` module with CUnit.
+ */
+#include "hashlife.h"
+#include "bitlife.h"
+#include "CUnit/Basic.h"
+
+/**
+ * Checks that long jumps give the same cells as the bit-parallel game of
+ * life.
+ *
+ * @param num_rows       The number of rows
+ * @param num_cols       The number of columns
+ * @param max_num_nodes  The number of nodes triggering a collection
+ * @param num_steps      The number of steps of each jump
+ */
+void check_jumps(unsigned int num_rows,
+                 unsigned int num_cols,
+                 size_t max_num_nodes,
+                 unsigned int num_steps) {
+    unsigned int distribution[] = {2, 1};
+    struct CellularAutomaton *automaton =
+        Cellular_init(num_rows, num_cols, CELLULAR_GAME_OF_LIFE,
+                      CELLULAR_WRAP_AROUND, ".X");
+    Cellular_set_random(automaton, distribution);
+    struct CellularAutomaton *expected = Cellular_duplicate(automaton);
+    struct Hashlife *hashlife = Hashlife_init(automaton, max_num_nodes);
+    struct Bitlife *bitlife = Bitlife_init(automaton);
+    for (unsigned int jump = 0; jump < 3; ++jump) {
+        Hashlife_step(hashlife, num_steps);
+        for (unsigned int step = 0; step < num_steps; ++step) {
+            Bitlife_step(bitlife);
+        }
+        Hashlife_store(hashlife, automaton);
+        Bitlife_store(bitlife, expected);
+        for (unsigned int i = 0; i < num_rows; ++i) {
+            for (unsigned int j = 0; j < num_cols; ++j) {
+                CU_ASSERT_EQUAL(Cellular_get(automaton, i, j),
+                                Cellular_get(expected, i, j));
+            }
+        }
+    }
+    Bitlife_free(bitlife);
+    Hashlife_free(hashlife);
+    Cellular_free(expected);
+    Cellular_free(automaton);
+}
+
+void test_jumps() {
+    check_jumps(32, 32, HASHLIFE_DEFAULT_MAX_NUM_NODES, 1000);
+    check_jumps(32, 32, HASHLIFE_DEFAULT_MAX_NUM_NODES, 77);
+    check_jumps(20, 45, HASHLIFE_DEFAULT_MAX_NUM_NODES, 333);
+}
+
+void test_collect() {
+    check_jumps(64, 64, 100, 500);
+    check_jumps(50, 30, 100, 500);
+}
+
+void test_periodic() {
+    // A blinker across the corners comes back after an even number of steps
+    struct CellularAutomaton *automaton =
+        Cellular_init(1024, 1024, CELLULAR_GAME_OF_LIFE,
+                      CELLULAR_WRAP_AROUND, ".X");
+    unsigned int distribution[] = {1, 0};
+    Cellular_set_random(automaton, distribution);
+    Cellular_set(automaton, 1023, 1023, 'X');
+    Cellular_set(automaton, 1023, 0, 'X');
+    Cellular_set(automaton, 1023, 1, 'X');
+    struct Hashlife *hashlife = Hashlife_init(automaton,
+                                              HASHLIFE_DEFAULT_MAX_NUM_NODES);
+    Hashlife_step(hashlife, 1000000000);
+    struct CellularAutomaton *expected = Cellular_duplicate(automaton);
+    Hashlife_store(hashlife, automaton);
+    for (unsigned int i = 0; i < 1024; ++i) {
+        for (unsigned int j = 0; j < 1024; ++j) {
+            CU_ASSERT_EQUAL(Cellular_get(automaton, i, j),
+                            Cellular_get(expected, i, j));
+        }
+    }
+    CU_ASSERT_TRUE(hashlife->num_nodes < 1000);
+    Hashlife_free(hashlife);
+    Cellular_free(expected);
+    Cellular_free(automaton);
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Hashlife
+    pSuite = CU_add_suite("Hashlife", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Jumping over many steps",
+                    test_jumps) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Garbage collection of the nodes",
+                    test_collect) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Billion steps of a periodic pattern",
+                    test_periodic) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
@@ -0,0 +1,194 @@
+/**
+ * Testing the `mapped` module with CUnit.
+ */
+#include "mapped.h"
+#include <stdlib.h>
+#include "CUnit/Basic.h"
+
+/**
+ * The directory of the mapped grids.
+ */
+const char *directory() {
+    const char *tmpdir = getenv("TMPDIR");
+    return tmpdir != NULL ? tmpdir : "/tmp";
+}
+
+/**
+ * Checks that a mapped automaton produces the same steps as
+ * `Cellular_step_into`, for both bounded boundaries.
+ *
+ * @param cellular_type  The type of cellular automaton
+ * @param allowed_cells  The allowed cells
+ * @param num_rows       The number of rows
+ * @param num_cols       The number of columns
+ * @param num_threads    The number of threads
+ */
+void check_mapped(enum CellularType cellular_type,
+                  const char *allowed_cells,
+                  unsigned int num_rows,
+                  unsigned int num_cols,
+                  unsigned int num_threads) {
+    unsigned int distribution[] = {1, 1, 1, 1};
+    enum CellularBoundary boundaries[] = {CELLULAR_TRUNCATE,
+                                          CELLULAR_WRAP_AROUND};
+    for (unsigned int b = 0; b < 2; ++b) {
+        struct CellularAutomaton *automaton =
+            Cellular_init(num_rows, num_cols, cellular_type, boundaries[b],
+                          allowed_cells);
+        Cellular_set_random(automaton, distribution);
+        struct Mapped *mapped =
+            Mapped_init(directory(), num_rows, num_cols, cellular_type,
+                        boundaries[b], allowed_cells, NULL, num_threads);
+        CU_ASSERT_PTR_NOT_NULL_FATAL(mapped);
+        for (unsigned int i = 0; i < num_rows; ++i) {
+            for (unsigned int j = 0; j < num_cols; ++j) {
+                CU_ASSERT_TRUE(Mapped_set(mapped, i, j,
+                                          Cellular_get(automaton, i, j)));
+            }
+        }
+        struct CellularAutomaton *next = Cellular_duplicate(automaton);
+        for (unsigned int step = 0; step < 4; ++step) {
+            Mapped_step(mapped, step);
+            for (unsigned int k = 0; k < step; ++k) {
+                Cellular_step_into(automaton, next);
+                struct CellularAutomaton *previous = automaton;
+                automaton = next;
+                next = previous;
+            }
+            for (unsigned int i = 0; i < num_rows; ++i) {
+                for (unsigned int j = 0; j < num_cols; ++j) {
+                    CU_ASSERT_EQUAL(Mapped_get(mapped, i, j),
+                                    Cellular_get(automaton, i, j));
+                }
+            }
+        }
+        Mapped_free(mapped);
+        Cellular_free(automaton);
+        Cellular_free(next);
+    }
+}
+
+void test_steps() {
+    unsigned int sizes[][2] = {{1, 1}, {3, 5}, {70, 130}};
+    for (unsigned int k = 0; k < 3; ++k) {
+        check_mapped(CELLULAR_GAME_OF_LIFE, ".X", sizes[k][0], sizes[k][1], 1);
+        check_mapped(CELLULAR_PANDEMY, ".XH", sizes[k][0], sizes[k][1], 1);
+        check_mapped(CELLULAR_FIRE, ".TFB", sizes[k][0], sizes[k][1], 1);
+    }
+}
+
+void test_threads() {
+    check_mapped(CELLULAR_PANDEMY, ".XH", 70, 130, 3);
+    check_mapped(CELLULAR_GAME_OF_LIFE, ".X", 2, 40, 8);
+}
+
+void test_random() {
+    unsigned int distribution[] = {4, 1, 2};
+    struct CellularAutomaton *automaton =
+        Cellular_init(37, 51, CELLULAR_PANDEMY, CELLULAR_TRUNCATE, ".XH");
+    Cellular_set_random_seeded(automaton, distribution, 99, 1);
+    struct Mapped *mapped = Mapped_init(directory(), 37, 51, CELLULAR_PANDEMY,
+                                        CELLULAR_TRUNCATE, ".XH", NULL, 3);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(mapped);
+    Mapped_set_random(mapped, distribution, 99);
+    for (unsigned int i = 0; i < 37; ++i) {
+        for (unsigned int j = 0; j < 51; ++j) {
+            CU_ASSERT_EQUAL(Mapped_get(mapped, i, j),
+                            Cellular_get(automaton, i, j));
+        }
+    }
+    Mapped_free(mapped);
+    Cellular_free(automaton);
+}
+
+void test_invalid() {
+    CU_ASSERT_PTR_NULL(Mapped_init("/nonexistent", 4, 4, CELLULAR_PANDEMY,
+                                   CELLULAR_TRUNCATE, ".XH", NULL, 1));
+    CU_ASSERT_PTR_NULL(Mapped_init(directory(), 4, 4, CELLULAR_PANDEMY,
+                                   CELLULAR_UNBOUNDED, ".XH", NULL, 1));
+    CU_ASSERT_PTR_NULL(Mapped_init(directory(), 4, 4, CELLULAR_PANDEMY,
+                                   CELLULAR_TRUNCATE, ".X", NULL, 1));
+}
+
+void test_shared_directory() {
+    const unsigned int distribution[] = {1, 1, 1};
+    struct Mapped *first = Mapped_init(directory(), 20, 30, CELLULAR_PANDEMY,
+                                       CELLULAR_TRUNCATE, ".XH", NULL, 1);
+    struct Mapped *second = Mapped_init(directory(), 20, 30, CELLULAR_PANDEMY,
+                                        CELLULAR_TRUNCATE, ".XH", NULL, 1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(first);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(second);
+    // The grids of the second automaton leave the first one untouched
+    Mapped_set_random(first, distribution, 5);
+    Mapped_set_random(second, distribution, 6);
+    struct CellularAutomaton *automaton =
+        Cellular_init(20, 30, CELLULAR_PANDEMY, CELLULAR_TRUNCATE, ".XH");
+    Cellular_set_random_seeded(automaton, distribution, 5, 1);
+    for (unsigned int i = 0; i < 20; ++i) {
+        for (unsigned int j = 0; j < 30; ++j) {
+            CU_ASSERT_EQUAL(Mapped_get(first, i, j),
+                            Cellular_get(automaton, i, j));
+        }
+    }
+    Mapped_free(first);
+    Mapped_free(second);
+    Cellular_free(automaton);
+}
+
+void test_empty() {
+    struct Mapped *mapped = Mapped_init(directory(), 0, 5,
+                                        CELLULAR_GAME_OF_LIFE,
+                                        CELLULAR_WRAP_AROUND, ".X", NULL, 4);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(mapped);
+    Mapped_step(mapped, 3);
+    Mapped_free(mapped);
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Mapped grids
+    pSuite = CU_add_suite("Mapped grids", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Steps of the mapped grids",
+                    test_steps) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Bands streamed by several threads",
+                    test_threads) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Random grids drawn from a seed",
+                    test_random) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Invalid arguments",
+                    test_invalid) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Automata sharing a directory",
+                    test_shared_directory) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Empty grid",
+                    test_empty) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
@@ -0,0 +1,137 @@
+/**
+ * Testing the `memo` module with CUnit.
+ */
+#include "memo.h"
+#include "CUnit/Basic.h"
+
+/**
+ * Computes the next step of a tile through a cache, and checks it against
+ * `Cellular_step_into`.
+ *
+ * @param memo       The caches
+ * @param automaton  The automaton, whose halo is up to date
+ * @param first_col  The first column of the tile, on the first row
+ */
+void check_tile(struct Memo *memo,
+                const struct CellularAutomaton *automaton,
+                unsigned int first_col) {
+    struct CellularAutomaton *expected = Cellular_duplicate(automaton);
+    struct CellularAutomaton *next = Cellular_duplicate(automaton);
+    Cellular_step_into(automaton, expected);
+    Memo_step_tile(memo, 0, automaton, next, 0, first_col);
+    for (unsigned int i = 0; i < MEMO_TILE_SIZE; ++i) {
+        for (unsigned int j = first_col; j < first_col + MEMO_TILE_SIZE; ++j) {
+            CU_ASSERT_EQUAL(Cellular_get(next, i, j),
+                            Cellular_get(expected, i, j));
+        }
+    }
+    Cellular_free(expected);
+    Cellular_free(next);
+}
+
+/**
+ * Returns an automaton whose three tiles have distinct windows.
+ *
+ * @return  The automaton
+ */
+struct CellularAutomaton *three_tiles() {
+    struct CellularAutomaton *automaton =
+        Cellular_init(4, 12, CELLULAR_PANDEMY, CELLULAR_TRUNCATE, ".XH");
+    for (unsigned int i = 0; i < 4; ++i) {
+        for (unsigned int j = 0; j < 12; ++j) {
+            Cellular_set(automaton, i, j, '.');
+        }
+    }
+    Cellular_set(automaton, 1, 5, 'H');
+    Cellular_set(automaton, 2, 10, 'X');
+    Cellular_set(automaton, 3, 11, 'H');
+    Cellular_refresh_halo(automaton);
+    return automaton;
+}
+
+void test_hits() {
+    struct CellularAutomaton *automaton = three_tiles();
+    struct Memo *memo = Memo_init(16, 1);
+    struct MemoStats stats;
+    unsigned int cols[] = {0, 4, 8, 0, 4, 8, 8};
+    for (unsigned int k = 0; k < 7; ++k) {
+        check_tile(memo, automaton, cols[k]);
+    }
+    Memo_get_stats(memo, &stats);
+    CU_ASSERT_EQUAL(stats.num_lookups, 7);
+    CU_ASSERT_EQUAL(stats.num_hits, 4);
+    CU_ASSERT_EQUAL(stats.num_entries, 3);
+    Memo_free(memo);
+    Cellular_free(automaton);
+}
+
+void test_eviction() {
+    struct CellularAutomaton *automaton = three_tiles();
+    struct Memo *memo = Memo_init(2, 1);
+    struct MemoStats stats;
+    // The tile 4 is the least recently used one when 8 is added, then 0
+    // when 4 is added again
+    unsigned int cols[] = {0, 4, 0, 8, 4, 0};
+    bool hits[] = {false, false, true, false, false, false};
+    for (unsigned int k = 0; k < 6; ++k) {
+        Memo_get_stats(memo, &stats);
+        unsigned long num_hits = stats.num_hits;
+        check_tile(memo, automaton, cols[k]);
+        Memo_get_stats(memo, &stats);
+        CU_ASSERT_EQUAL(stats.num_hits - num_hits, hits[k]);
+        CU_ASSERT_TRUE(stats.num_entries <= 2);
+    }
+    Memo_free(memo);
+    Cellular_free(automaton);
+}
+
+void test_threads() {
+    struct CellularAutomaton *automaton = three_tiles();
+    struct CellularAutomaton *next = Cellular_duplicate(automaton);
+    struct Memo *memo = Memo_init(4, 2);
+    struct MemoStats stats;
+    Memo_step_tile(memo, 0, automaton, next, 0, 0);
+    Memo_step_tile(memo, 1, automaton, next, 0, 0);
+    Memo_step_tile(memo, 1, automaton, next, 0, 0);
+    Memo_get_stats(memo, &stats);
+    CU_ASSERT_EQUAL(stats.num_lookups, 3);
+    CU_ASSERT_EQUAL(stats.num_hits, 1);
+    CU_ASSERT_EQUAL(stats.num_entries, 2);
+    Memo_free(memo);
+    Cellular_free(automaton);
+    Cellular_free(next);
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Memoized tiles
+    pSuite = CU_add_suite("Memoized tiles", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Tiles found in the cache",
+                    test_hits) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Least recently used tiles evicted",
+                    test_eviction) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "A cache per thread",
+                    test_threads) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
@@ -0,0 +1,114 @@
+/**
+ * Testing the `numa` module with CUnit.
+ */
+#include "numa.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CUnit/Basic.h"
+
+void test_topology() {
+    struct NumaTopology *topology = Numa_init();
+    CU_ASSERT_TRUE(topology->num_cpus >= 1);
+    CU_ASSERT_TRUE(topology->num_nodes >= 1);
+    CU_ASSERT_TRUE(topology->num_nodes <= topology->num_cpus);
+    for (unsigned int k = 1; k < topology->num_cpus; ++k) {
+        CU_ASSERT_TRUE(topology->nodes[k - 1] <= topology->nodes[k]);
+    }
+    for (unsigned int k = 0; k < topology->num_cpus; ++k) {
+        CU_ASSERT_EQUAL(Numa_node_of_cpu(topology, topology->cpus[k]),
+                        (int)topology->nodes[k]);
+    }
+    Numa_free(topology);
+}
+
+void test_spread() {
+    struct NumaTopology *topology = Numa_init();
+    unsigned int num_cpus = topology->num_cpus;
+    for (unsigned int num_threads = 1; num_threads <= 2 * num_cpus;
+         ++num_threads) {
+        unsigned int previous = 0;
+        for (unsigned int index = 0; index < num_threads; ++index) {
+            unsigned int cpu = Numa_cpu(topology, index, num_threads);
+            CU_ASSERT_TRUE(Numa_node_of_cpu(topology, cpu) >= 0);
+            if (num_threads <= num_cpus && index > 0) {
+                // Distinct CPUs, in the order of the nodes
+                CU_ASSERT_NOT_EQUAL(cpu, previous);
+                CU_ASSERT_TRUE(Numa_node_of_cpu(topology, cpu)
+                               >= Numa_node_of_cpu(topology, previous));
+            }
+            previous = cpu;
+        }
+    }
+    CU_ASSERT_TRUE(Numa_pin(Numa_cpu(topology, 0, 1)));
+    Numa_free(topology);
+}
+
+void test_alloc() {
+    size_t sizes[] = {1, 4096, 3 * NUMA_HUGE_PAGE_SIZE + 1};
+    for (unsigned int h = 0; h < 2; ++h) {
+        Numa_set_huge_pages(h == 1);
+        CU_ASSERT_EQUAL(Numa_huge_pages(), h == 1);
+        for (unsigned int k = 0; k < 3; ++k) {
+            unsigned char *memory = Numa_alloc(64, sizes[k]);
+            CU_ASSERT_PTR_NOT_NULL_FATAL(memory);
+            CU_ASSERT_EQUAL((uintptr_t)memory % 64, 0);
+            memset(memory, 1, sizes[k]);
+            CU_ASSERT_TRUE(Numa_node_of_address(memory) >= -1);
+            free(memory);
+        }
+    }
+    Numa_set_huge_pages(false);
+    CU_ASSERT_TRUE(Numa_huge_pages_size() >= -1);
+}
+
+void test_copy_band() {
+    unsigned char source[7 * 3], target[7 * 3];
+    for (unsigned int k = 0; k < sizeof(source); ++k) {
+        source[k] = k;
+    }
+    memset(target, 0, sizeof(target));
+    for (unsigned int index = 0; index < 4; ++index) {
+        Numa_copy_band(target, source, 7, 3, index, 4);
+    }
+    CU_ASSERT_EQUAL(memcmp(source, target, sizeof(source)), 0);
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // NUMA placement
+    pSuite = CU_add_suite("NUMA placement", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Topology of the CPUs",
+                    test_topology) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Threads spread over the CPUs",
+                    test_spread) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Allocations with huge pages",
+                    test_alloc) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Copy of bands",
+                    test_copy_band) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
@@ -51,6 +51,60 @@ void test_size_long_options() {
     free_arguments(arguments);
 }
 
+void test_printed_steps() {
+    char *argv[] = {"bin/automaton", "-n", "20", "--print-every", "4",
+                    "--skip-to", "6", NULL};
+    int argc = 7;
+    struct Arguments *arguments = parse_arguments(argc, argv);
+    CU_ASSERT_EQUAL(arguments->status,      TP2_OK);
+    CU_ASSERT_EQUAL(arguments->print_every, 4);
+    CU_ASSERT_EQUAL(arguments->skip_to,     6);
+    CU_ASSERT_EQUAL(next_printed_step(arguments, 0),  6);
+    CU_ASSERT_EQUAL(next_printed_step(arguments, 6),  6);
+    CU_ASSERT_EQUAL(next_printed_step(arguments, 7),  10);
+    CU_ASSERT_EQUAL(next_printed_step(arguments, 18), 18);
+    CU_ASSERT_EQUAL(next_printed_step(arguments, 19), 20);
+    arguments->final_only = true;
+    CU_ASSERT_EQUAL(next_printed_step(arguments, 0),  19);
+    CU_ASSERT_EQUAL(next_printed_step(arguments, 20), 20);
+    arguments->final_only = false;
+    arguments->skip_to = 30;
+    CU_ASSERT_EQUAL(next_printed_step(arguments, 0),  20);
+    free_arguments(arguments);
+
+    char *wrong_argv[] = {"bin/automaton", "-p", "0", NULL};
+    arguments = parse_arguments(3, wrong_argv);
+    CU_ASSERT_EQUAL(arguments->status, TP2_WRONG_PRINT_EVERY);
+    free_arguments(arguments);
+    char *skip_argv[] = {"bin/automaton", "-n", "20", "-J", "20", NULL};
+    arguments = parse_arguments(5, skip_argv);
+    CU_ASSERT_EQUAL(arguments->status, TP2_WRONG_SKIP_TO);
+    free_arguments(arguments);
+    char *no_step_argv[] = {"bin/automaton", "-n", "0", NULL};
+    arguments = parse_arguments(3, no_step_argv);
+    CU_ASSERT_EQUAL(arguments->status, TP2_OK);
+    free_arguments(arguments);
+    char *interactive_argv[] = {"bin/automaton", "-i", "-f", NULL};
+    arguments = parse_arguments(3, interactive_argv);
+    CU_ASSERT_EQUAL(arguments->status, TP2_INCONSISTENT_ARGS);
+    free_arguments(arguments);
+}
+
+void test_final_grids() {
+    char *argv[] = {"bin/automaton", "-E", "100", "-F", NULL};
+    struct Arguments *arguments = parse_arguments(4, argv);
+    CU_ASSERT_EQUAL(arguments->status,      TP2_OK);
+    CU_ASSERT_EQUAL(arguments->num_members, 100);
+    CU_ASSERT_EQUAL(arguments->final_grids, true);
+    free_arguments(arguments);
+
+    // Only an ensemble prints its grids at the last step
+    char *single_argv[] = {"bin/automaton", "-F", NULL};
+    arguments = parse_arguments(2, single_argv);
+    CU_ASSERT_EQUAL(arguments->status, TP2_INCONSISTENT_ARGS);
+    free_arguments(arguments);
+}
+
 int main() {
     CU_pSuite pSuite = NULL;
     if (CU_initialize_registry() != CUE_SUCCESS )
@@ -77,6 +131,16 @@ int main() {
         CU_cleanup_registry();
         return CU_get_error();
     }
+    if (CU_add_test(pSuite, "Checking the printed steps",
+                    test_printed_steps) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Checking the final grids of an ensemble",
+                    test_final_grids) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
 
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();
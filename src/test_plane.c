@@ -0,0 +1,132 @@
+/**
+ * Testing the `plane` module with CUnit.
+ */
+#include "plane.h"
+#include "CUnit/Basic.h"
+
+/**
+ * Checks that a glider travels across the chunks of a plane.
+ *
+ * @param cells      The 3 x 3 cells of the glider, row by row
+ * @param direction  The move of the glider along each axis every 4 steps
+ */
+void check_glider(const char *cells, int direction) {
+    struct Rule *rule = Rule_parse_life("B3/S23");
+    struct Plane *plane = Plane_init(rule);
+    for (unsigned int i = 0; i < 3; ++i) {
+        for (unsigned int j = 0; j < 3; ++j) {
+            Plane_set(plane, i, j, cells[3 * i + j] == 'X');
+        }
+    }
+    unsigned int num_moves = 3 * PLANE_CHUNK_SIZE;
+    for (unsigned int step = 0; step < 4 * num_moves; ++step) {
+        Plane_step(plane);
+        CU_ASSERT_TRUE(plane->num_chunks <= 4);
+    }
+    int64_t shift = direction * (int64_t)num_moves;
+    for (int64_t i = -1; i < 4; ++i) {
+        for (int64_t j = -1; j < 4; ++j) {
+            unsigned char expected = 0 <= i && i < 3 && 0 <= j && j < 3 &&
+                                     cells[3 * i + j] == 'X';
+            CU_ASSERT_EQUAL(Plane_get(plane, shift + i, shift + j), expected);
+        }
+    }
+    CU_ASSERT_EQUAL(Plane_get(plane, 0, 1), 0);
+    Plane_free(plane);
+    Rule_free(rule);
+}
+
+void test_glider() {
+    check_glider(".X...XXXX", 1);
+    check_glider("XXXX...X.", -1);
+}
+
+void test_free_chunks() {
+    struct Rule *rule = Rule_parse_life("B3/S23");
+    struct Plane *plane = Plane_init(rule);
+    Plane_set(plane, -1, -1, 1);
+    Plane_set(plane, PLANE_CHUNK_SIZE, 0, 1);
+    CU_ASSERT_EQUAL(plane->num_chunks, 2);
+    Plane_step(plane);
+    CU_ASSERT_EQUAL(plane->num_chunks, 0);
+    CU_ASSERT_EQUAL(Plane_get(plane, -1, -1), 0);
+    Plane_free(plane);
+    Rule_free(rule);
+}
+
+void test_supports() {
+    struct Rule *rule = Rule_parse_life("B3/S23");
+    CU_ASSERT_TRUE(Plane_supports(rule));
+    Rule_free(rule);
+    rule = Rule_parse_life("B013/S23");
+    CU_ASSERT_FALSE(Plane_supports(rule));
+    Rule_free(rule);
+}
+
+void test_window() {
+    struct Rule *rule = Rule_parse_life("B3/S23");
+    struct Plane *plane = Plane_init(rule);
+    struct CellularAutomaton *automaton =
+        Cellular_init(70, 130, CELLULAR_GAME_OF_LIFE, CELLULAR_UNBOUNDED,
+                      ".X");
+    unsigned int distribution[] = {1, 0};
+    Cellular_set_random(automaton, distribution);
+    Cellular_set(automaton, 69, 129, 'X');
+    Cellular_set(automaton, 64, 0, 'X');
+    Plane_load(plane, automaton);
+    Plane_set(plane, 70, 0, 1);
+    Plane_set(plane, -1, 0, 1);
+    CU_ASSERT_EQUAL(plane->num_chunks, 3);
+    Cellular_set(automaton, 69, 129, '.');
+    Cellular_set(automaton, 64, 0, '.');
+    Plane_store(plane, automaton);
+    for (unsigned int i = 0; i < 70; ++i) {
+        for (unsigned int j = 0; j < 130; ++j) {
+            char expected = (i == 69 && j == 129) || (i == 64 && j == 0)
+                          ? 'X' : '.';
+            CU_ASSERT_EQUAL(Cellular_get(automaton, i, j), expected);
+        }
+    }
+    Cellular_free(automaton);
+    Plane_free(plane);
+    Rule_free(rule);
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Plane
+    pSuite = CU_add_suite("Plane", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Gliders travelling across the chunks",
+                    test_glider) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Freeing the empty chunks",
+                    test_free_chunks) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Supported rules",
+                    test_supports) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Loading and storing the window",
+                    test_window) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
@@ -0,0 +1,96 @@
+/**
+ * Testing the `pool` module with CUnit.
+ */
+#include "pool.h"
+#include "CUnit/Basic.h"
+
+#define TEST_POOL_NUM_RUNS 100
+#define TEST_POOL_MAX_NUM_THREADS 8
+#define TEST_POOL_MAX_NUM_JOBS 1000
+
+/**
+ * Counts the calls of each thread.
+ *
+ * Note: the assertions are only checked by the main thread, since CUnit is
+ * not thread-safe.
+ */
+void count_calls(void *data, unsigned int index, unsigned int num_threads) {
+    unsigned int *calls = data;
+    if (index < num_threads) ++calls[index];
+}
+
+void test_run() {
+    for (unsigned int num_threads = 1;
+         num_threads <= TEST_POOL_MAX_NUM_THREADS; ++num_threads) {
+        unsigned int calls[TEST_POOL_MAX_NUM_THREADS] = {0};
+        struct Pool *pool = Pool_init(num_threads);
+        for (unsigned int run = 0; run < TEST_POOL_NUM_RUNS; ++run) {
+            Pool_run(pool, count_calls, calls);
+        }
+        Pool_free(pool);
+        for (unsigned int t = 0; t < TEST_POOL_MAX_NUM_THREADS; ++t) {
+            CU_ASSERT_EQUAL(calls[t], t < num_threads ? TEST_POOL_NUM_RUNS
+                                                      : 0);
+        }
+    }
+}
+
+/**
+ * Counts the runs of a job, the first jobs being much longer.
+ */
+void count_runs(void *data, unsigned int job) {
+    _Atomic unsigned int *runs = data;
+    for (unsigned int k = 0; k < (job < 10 ? 100000 : 1); ++k) {
+        atomic_fetch_add(&runs[job], 1);
+    }
+}
+
+void test_run_jobs() {
+    unsigned int num_jobs[] = {0, 1, 7, TEST_POOL_MAX_NUM_JOBS};
+    for (unsigned int num_threads = 1;
+         num_threads <= TEST_POOL_MAX_NUM_THREADS; ++num_threads) {
+        struct Pool *pool = Pool_init(num_threads);
+        for (unsigned int k = 0; k < 4; ++k) {
+            static _Atomic unsigned int runs[TEST_POOL_MAX_NUM_JOBS];
+            for (unsigned int job = 0; job < TEST_POOL_MAX_NUM_JOBS; ++job) {
+                atomic_init(&runs[job], 0);
+            }
+            Pool_run_jobs(pool, count_runs, runs, num_jobs[k]);
+            for (unsigned int job = 0; job < TEST_POOL_MAX_NUM_JOBS; ++job) {
+                unsigned int expected = job >= num_jobs[k] ? 0
+                                      : job < 10 ? 100000 : 1;
+                CU_ASSERT_EQUAL(atomic_load(&runs[job]), expected);
+            }
+        }
+        Pool_free(pool);
+    }
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Thread pool
+    pSuite = CU_add_suite("Thread pool", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Running a task on every thread",
+                    test_run) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Running a batch of jobs with work stealing",
+                    test_run_jobs) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
@@ -0,0 +1,86 @@
+/**
+ * Testing the `random` module with CUnit.
+ */
+#include "random.h"
+#include "CUnit/Basic.h"
+
+void test_alias() {
+    const unsigned int weights[] = {5, 0, 1, 2};
+    struct RandomAlias alias;
+    Random_alias_init(&alias, weights, 4);
+    unsigned long counts[4] = {0};
+    const unsigned long num_draws = 800000;
+    for (unsigned long k = 0; k < num_draws; ++k) {
+        ++counts[Random_draw(&alias, Random_get(1, k))];
+    }
+    CU_ASSERT_EQUAL(counts[1], 0);
+    for (unsigned int v = 0; v < 4; ++v) {
+        // Within 1% of the drawn values
+        double expected = (double)num_draws * weights[v] / 8;
+        CU_ASSERT_DOUBLE_EQUAL(counts[v], expected, num_draws / 100.0);
+    }
+
+    // The extreme fractional parts of the columns
+    const unsigned int single[] = {0, 0, 7};
+    Random_alias_init(&alias, single, 3);
+    CU_ASSERT_EQUAL(Random_draw(&alias, 0), 2);
+    CU_ASSERT_EQUAL(Random_draw(&alias, UINT32_MAX), 2);
+    CU_ASSERT_EQUAL(Random_draw(&alias, UINT32_MAX / 2), 2);
+    const unsigned int zeros[] = {0, 0};
+    Random_alias_init(&alias, zeros, 2);
+    CU_ASSERT_EQUAL(Random_draw(&alias, 0), 0);
+    CU_ASSERT_EQUAL(Random_draw(&alias, UINT32_MAX), 1);
+}
+
+void test_fill() {
+    const unsigned int weights[] = {1, 1, 1};
+    struct RandomAlias alias;
+    Random_alias_init(&alias, weights, 3);
+    unsigned char all[101], part[101];
+    Random_fill(&alias, 42, 10, 101, all);
+    // Any range gives the same cells, whatever the parity of its ends
+    for (unsigned int first = 0; first < 4; ++first) {
+        for (unsigned int num_cells = 0; first + num_cells <= 101;
+             num_cells += 7) {
+            Random_fill(&alias, 42, 10 + first, num_cells, part);
+            for (unsigned int k = 0; k < num_cells; ++k) {
+                CU_ASSERT_EQUAL(part[k], all[first + k]);
+            }
+        }
+    }
+    Random_fill(&alias, 43, 10, 101, part);
+    unsigned int num_same = 0;
+    for (unsigned int k = 0; k < 101; ++k) {
+        num_same += part[k] == all[k];
+    }
+    CU_ASSERT(num_same < 101);
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Counter-based random numbers
+    pSuite = CU_add_suite("Counter-based random numbers", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Alias table of a distribution",
+                    test_alias) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Cells drawn by ranges",
+                    test_fill) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
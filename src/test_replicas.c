@@ -0,0 +1,185 @@
+/**
+ * Testing the `replicas` module with CUnit.
+ */
+#include <stdlib.h>
+#include "replicas.h"
+#include "random.h"
+#include "CUnit/Basic.h"
+
+/**
+ * Checks that the populations of replicas are those of their grids stepped
+ * alone by `Cellular_step_into`.
+ *
+ * @param type           The type of cellular automaton
+ * @param boundary       The boundary
+ * @param allowed_cells  The allowed cells
+ * @param num_rows       The number of rows
+ * @param num_cols       The number of columns
+ * @param num_replicas   The number of replicas
+ * @param num_threads    The number of threads
+ */
+void check_replicas(enum CellularType type,
+                    enum CellularBoundary boundary,
+                    const char *allowed_cells,
+                    unsigned int num_rows,
+                    unsigned int num_cols,
+                    unsigned int num_replicas,
+                    unsigned int num_threads) {
+    const uint64_t seed = 2024;
+    unsigned int distribution[] = {3, 1, 2, 1};
+    struct CellularAutomaton *model = Cellular_init(num_rows, num_cols, type,
+                                                    boundary, allowed_cells);
+    struct Replicas *replicas = Replicas_init(model, distribution,
+                                              num_replicas, seed, num_threads);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(replicas);
+    struct CellularAutomaton **grids =
+        malloc(num_replicas * sizeof(struct CellularAutomaton*));
+    for (unsigned int r = 0; r < num_replicas; ++r) {
+        grids[r] = Cellular_duplicate(model);
+        Cellular_set_random_seeded(grids[r], distribution,
+                                   Random_get(seed, r), 1);
+    }
+    struct CellularAutomaton *next = Cellular_duplicate(model);
+    for (unsigned int step = 0; step < 5; ++step) {
+        for (unsigned int r = 0; r < num_replicas; ++r) {
+            unsigned long populations[RULE_MAX_NUM_STATES] = {0};
+            for (unsigned int i = 0; i < num_rows; ++i) {
+                for (unsigned int j = 0; j < num_cols; ++j) {
+                    ++populations[*Cellular_cell(grids[r], i, j)];
+                }
+            }
+            for (unsigned int s = 0; s < replicas->num_states; ++s) {
+                CU_ASSERT_EQUAL(replicas->populations[s * num_replicas + r],
+                                populations[s]);
+            }
+            Cellular_step_into(grids[r], next);
+            struct CellularAutomaton *previous = grids[r];
+            grids[r] = next;
+            next = previous;
+        }
+        Replicas_step(replicas, 1);
+    }
+    for (unsigned int r = 0; r < num_replicas; ++r) {
+        Cellular_free(grids[r]);
+    }
+    Cellular_free(next);
+    Cellular_free(model);
+    free(grids);
+    Replicas_free(replicas);
+}
+
+void test_populations() {
+    enum CellularBoundary boundaries[] = {CELLULAR_TRUNCATE,
+                                          CELLULAR_WRAP_AROUND};
+    for (unsigned int b = 0; b < 2; ++b) {
+        check_replicas(CELLULAR_GAME_OF_LIFE, boundaries[b], ".X",
+                       1, 1, 1, 1);
+        check_replicas(CELLULAR_GAME_OF_LIFE, boundaries[b], ".X",
+                       9, 7, 70, 3);
+        check_replicas(CELLULAR_PANDEMY, boundaries[b], ".XH",
+                       5, 12, 130, 2);
+        check_replicas(CELLULAR_FIRE, boundaries[b], ".TFB",
+                       11, 6, 300, 4);
+    }
+}
+
+void test_reproducible() {
+    unsigned int distribution[] = {2, 1, 1};
+    struct CellularAutomaton *model =
+        Cellular_init(16, 20, CELLULAR_PANDEMY, CELLULAR_TRUNCATE, ".XH");
+    struct Replicas *first = Replicas_init(model, distribution, 200, 7, 1);
+    struct Replicas *second = Replicas_init(model, distribution, 200, 7, 3);
+    struct Replicas *other = Replicas_init(model, distribution, 200, 8, 1);
+    bool is_other_same = true;
+    for (unsigned int step = 0; step < 4; ++step) {
+        for (unsigned int k = 0; k < 3 * 200; ++k) {
+            CU_ASSERT_EQUAL(first->populations[k], second->populations[k]);
+            is_other_same = is_other_same &&
+                            first->populations[k] == other->populations[k];
+        }
+        Replicas_step(first, 1);
+        Replicas_step(second, 1);
+        Replicas_step(other, 1);
+    }
+    CU_ASSERT_FALSE(is_other_same);
+    // Several steps at once, counted after the last one only
+    struct Replicas *jumped = Replicas_init(model, distribution, 200, 7, 2);
+    Replicas_step(jumped, 4);
+    for (unsigned int k = 0; k < 3 * 200; ++k) {
+        CU_ASSERT_EQUAL(jumped->populations[k], first->populations[k]);
+    }
+    Replicas_step(jumped, 0);
+    Replicas_step(first, 1);
+    Replicas_step(jumped, 1);
+    for (unsigned int k = 0; k < 3 * 200; ++k) {
+        CU_ASSERT_EQUAL(jumped->populations[k], first->populations[k]);
+    }
+    Replicas_free(jumped);
+    Replicas_free(first);
+    Replicas_free(second);
+    Replicas_free(other);
+    Cellular_free(model);
+}
+
+void test_stats() {
+    unsigned int distribution[] = {1, 1};
+    struct CellularAutomaton *model =
+        Cellular_init(3, 3, CELLULAR_GAME_OF_LIFE, CELLULAR_TRUNCATE, ".X");
+    struct Replicas *replicas = Replicas_init(model, distribution, 5, 1, 1);
+    const unsigned long populations[] = {5, 1, 4, 2, 3};
+    for (unsigned int r = 0; r < 5; ++r) {
+        replicas->populations[5 + r] = populations[r];
+    }
+    struct ReplicasStats stats;
+    Replicas_get_stats(replicas, 1, &stats);
+    CU_ASSERT_DOUBLE_EQUAL(stats.mean, 3.0, 1e-9);
+    CU_ASSERT_EQUAL(stats.min, 1);
+    CU_ASSERT_EQUAL(stats.first_quartile, 2);
+    CU_ASSERT_EQUAL(stats.median, 3);
+    CU_ASSERT_EQUAL(stats.third_quartile, 4);
+    CU_ASSERT_EQUAL(stats.max, 5);
+    // The populations of both states always sum to the number of cells
+    Replicas_get_stats(replicas, 0, &stats);
+    CU_ASSERT_TRUE(stats.max <= 9);
+    Replicas_free(replicas);
+    Cellular_free(model);
+
+    model = Cellular_init(3, 3, CELLULAR_GAME_OF_LIFE, CELLULAR_UNBOUNDED,
+                          ".X");
+    CU_ASSERT_PTR_NULL(Replicas_init(model, distribution, 5, 1, 1));
+    Cellular_free(model);
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Monte Carlo replicas
+    pSuite = CU_add_suite("Monte Carlo replicas", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Populations of each replica",
+                    test_populations) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Replicas drawn from a seed",
+                    test_reproducible) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Statistics of the populations",
+                    test_stats) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
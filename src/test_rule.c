@@ -0,0 +1,92 @@
+/**
+ * Testing the `rule` module with CUnit.
+ */
+#include "rule.h"
+#include "stencil.h"
+#include "CUnit/Basic.h"
+
+/**
+ * A three-state rule: a cell takes the state of the majority of its
+ * non-zero neighbors, or state 0 if there is none.
+ */
+unsigned char majority(unsigned char state, uint16_t histogram) {
+    (void)state;
+    unsigned int num_ones = STENCIL_HISTOGRAM_COUNT(histogram, 1);
+    unsigned int num_twos = STENCIL_HISTOGRAM_COUNT(histogram, 2);
+    if (num_ones == 0 && num_twos == 0) return 0;
+    return num_ones >= num_twos ? 1 : 2;
+}
+
+void test_parse_life() {
+    struct Rule *rule = Rule_parse_life("B3/S23");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(rule);
+    CU_ASSERT_EQUAL(rule->num_states, 2);
+    CU_ASSERT_EQUAL(rule->birth, 1u << 3);
+    CU_ASSERT_EQUAL(rule->survival, 1u << 2 | 1u << 3);
+    for (unsigned int n = 0; n <= RULE_NUM_NEIGHBORS; ++n) {
+        CU_ASSERT_EQUAL(Rule_apply(rule, 0, n), n == 3);
+        CU_ASSERT_EQUAL(Rule_apply(rule, 1, n), n == 2 || n == 3);
+    }
+    Rule_free(rule);
+    rule = Rule_parse_life("b/s");
+    CU_ASSERT_PTR_NOT_NULL_FATAL(rule);
+    CU_ASSERT_EQUAL(rule->birth, 0);
+    CU_ASSERT_EQUAL(rule->survival, 0);
+    Rule_free(rule);
+}
+
+void test_invalid_life() {
+    const char *rulestrings[] = {"", "B3", "S23/B3", "B3/S29", "B3/S23/",
+                                 "23/3", "B3 /S23"};
+    for (unsigned int r = 0; r < 7; ++r) {
+        CU_ASSERT_PTR_NULL(Rule_parse_life(rulestrings[r]));
+    }
+}
+
+void test_compile() {
+    struct Rule *rule = Rule_compile(3, majority);
+    CU_ASSERT_EQUAL(rule->shift, 8);
+    CU_ASSERT_EQUAL(Rule_apply(rule, 0, 0x00), 0);
+    CU_ASSERT_EQUAL(Rule_apply(rule, 2, 0x12), 1);
+    CU_ASSERT_EQUAL(Rule_apply(rule, 1, 0x31), 2);
+    struct Rule *copy = Rule_duplicate(rule);
+    for (unsigned int h = 0; h < 1u << rule->shift; ++h) {
+        CU_ASSERT_EQUAL(Rule_apply(copy, 1, h), Rule_apply(rule, 1, h));
+    }
+    Rule_free(rule);
+    Rule_free(copy);
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Rules
+    pSuite = CU_add_suite("Compiling rules", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Parsing Life-like rulestrings",
+                    test_parse_life) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Rejecting invalid rulestrings",
+                    test_invalid_life) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Compiling a rule function",
+                    test_compile) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
@@ -0,0 +1,128 @@
+/**
+ * Testing the `stencil` module with CUnit.
+ */
+#include "stencil.h"
+#include "CUnit/Basic.h"
+#include <stdlib.h>
+
+#define TEST_STENCIL_NUM_CELLS 100
+
+void test_scalar_counts() {
+    // Three rows of 3 cells, surrounded by a halo of state 0
+    unsigned char rows[3][5] = {{0, 1, 1, 1, 0},
+                                {0, 1, 2, 1, 0},
+                                {0, 2, 1, 0, 0}};
+    unsigned char counts[3];
+    CU_ASSERT_TRUE(Stencil_use(STENCIL_SCALAR));
+    Stencil_count(rows[0] + 1, rows[1] + 1, rows[2] + 1, 3, 1, counts);
+    CU_ASSERT_EQUAL(counts[0], 3);
+    CU_ASSERT_EQUAL(counts[1], 6);
+    CU_ASSERT_EQUAL(counts[2], 3);
+    Stencil_count(rows[0] + 1, rows[1] + 1, rows[2] + 1, 3, 2, counts);
+    CU_ASSERT_EQUAL(counts[0], 2);
+    CU_ASSERT_EQUAL(counts[1], 1);
+    CU_ASSERT_EQUAL(counts[2], 1);
+}
+
+void test_kernels() {
+    unsigned char rows[3][TEST_STENCIL_NUM_CELLS + 2];
+    unsigned char expected[TEST_STENCIL_NUM_CELLS];
+    unsigned char counts[TEST_STENCIL_NUM_CELLS];
+    srand(42);
+    for (unsigned int r = 0; r < 3; ++r) {
+        for (unsigned int j = 0; j < TEST_STENCIL_NUM_CELLS + 2; ++j) {
+            rows[r][j] = rand() % 4;
+        }
+    }
+    for (int kernel = 0; kernel < STENCIL_NUM_KERNELS; ++kernel) {
+        if (!Stencil_use(kernel)) continue;
+        // Every length, to exercise the vectorized loops and their tails
+        for (unsigned int n = 0; n <= TEST_STENCIL_NUM_CELLS; ++n) {
+            for (unsigned char state = 0; state < 4; ++state) {
+                Stencil_use(STENCIL_SCALAR);
+                Stencil_count(rows[0] + 1, rows[1] + 1, rows[2] + 1, n,
+                              state, expected);
+                Stencil_use(kernel);
+                Stencil_count(rows[0] + 1, rows[1] + 1, rows[2] + 1, n,
+                              state, counts);
+                for (unsigned int j = 0; j < n; ++j) {
+                    CU_ASSERT_EQUAL(counts[j], expected[j]);
+                }
+            }
+        }
+    }
+}
+
+void test_histograms() {
+    unsigned char rows[3][TEST_STENCIL_NUM_CELLS + 2];
+    unsigned char counts[TEST_STENCIL_NUM_CELLS];
+    uint16_t histograms[TEST_STENCIL_NUM_CELLS];
+    srand(7);
+    for (unsigned int r = 0; r < 3; ++r) {
+        for (unsigned int j = 0; j < TEST_STENCIL_NUM_CELLS + 2; ++j) {
+            rows[r][j] = rand() % 4;
+        }
+    }
+    for (int kernel = 0; kernel < STENCIL_NUM_KERNELS; ++kernel) {
+        if (!Stencil_use(kernel)) continue;
+        for (unsigned int n = 0; n <= TEST_STENCIL_NUM_CELLS; ++n) {
+            Stencil_histogram(rows[0] + 1, rows[1] + 1, rows[2] + 1, n,
+                              histograms);
+            for (unsigned char state = 1; state < 4; ++state) {
+                Stencil_count(rows[0] + 1, rows[1] + 1, rows[2] + 1, n,
+                              state, counts);
+                for (unsigned int j = 0; j < n; ++j) {
+                    CU_ASSERT_EQUAL(
+                        STENCIL_HISTOGRAM_COUNT(histograms[j], state),
+                        counts[j]);
+                }
+            }
+        }
+    }
+}
+
+void test_names() {
+    CU_ASSERT_TRUE(Stencil_supports(STENCIL_SCALAR));
+    CU_ASSERT_FALSE(Stencil_supports(STENCIL_NUM_KERNELS));
+    CU_ASSERT_STRING_EQUAL(Stencil_name(STENCIL_SCALAR), "scalar");
+    CU_ASSERT_STRING_EQUAL(Stencil_name(STENCIL_AVX2), "avx2");
+}
+
+int main() {
+    CU_pSuite pSuite = NULL;
+    if (CU_initialize_registry() != CUE_SUCCESS )
+        return CU_get_error();
+
+    // Neighbor counting
+    pSuite = CU_add_suite("Neighbor counting", NULL, NULL);
+    if (pSuite == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Scalar counts",
+                    test_scalar_counts) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Identical counts for every kernel",
+                    test_kernels) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Histograms consistent with counts",
+                    test_histograms) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if (CU_add_test(pSuite, "Supported kernels and names",
+                    test_names) == NULL) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    unsigned int num_failures = CU_get_number_of_failures();
+    CU_cleanup_registry();
+    return num_failures;
+}
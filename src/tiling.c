@@ -0,0 +1,128 @@
+/**
+ * Implements tiling.h.
+ */
+#include "tiling.h"
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+
+// ------- //
+// Private //
+// ------- //
+
+/**
+ * Returns the neighboring index of a tile along one dimension.
+ *
+ * @param index     The index of the tile along the dimension
+ * @param offset    The offset of the neighbor, -1, 0 or 1
+ * @param size      The number of tiles along the dimension
+ * @param boundary  The boundary type
+ * @return          The index of the neighbor, or `size` if there is none
+ */
+unsigned int Tiling_neighbor(unsigned int index,
+                             int offset,
+                             unsigned int size,
+                             enum CellularBoundary boundary) {
+    if (offset < 0 && index == 0) {
+        return boundary == CELLULAR_WRAP_AROUND ? size - 1 : size;
+    } else if (offset > 0 && index == size - 1) {
+        return boundary == CELLULAR_WRAP_AROUND ? 0 : size;
+    } else {
+        return index + offset;
+    }
+}
+
+/**
+ * Tells if a tile or one of its neighbors changed during the last step.
+ *
+ * @param tiling  The tiling
+ * @param i       The row of the tile
+ * @param j       The column of the tile
+ * @return        True if and only if the tile is active
+ */
+bool Tiling_is_active(const struct Tiling *tiling,
+                      unsigned int i,
+                      unsigned int j) {
+    for (int di = -1; di <= 1; ++di) {
+        unsigned int k = Tiling_neighbor(i, di, tiling->num_rows,
+                                         tiling->boundary);
+        if (k == tiling->num_rows) continue;
+        for (int dj = -1; dj <= 1; ++dj) {
+            unsigned int l = Tiling_neighbor(j, dj, tiling->num_cols,
+                                             tiling->boundary);
+            if (l == tiling->num_cols) continue;
+            if (tiling->has_changed[k * tiling->num_cols + l]) return true;
+        }
+    }
+    return false;
+}
+
+// ------ //
+// Public //
+// ------ //
+
+struct Tiling *Tiling_init(unsigned int num_rows,
+                           unsigned int num_cols,
+                           enum CellularBoundary boundary) {
+    struct Tiling *tiling = malloc(sizeof(struct Tiling));
+    tiling->num_rows = (num_rows + TILING_TILE_ROWS - 1) / TILING_TILE_ROWS;
+    tiling->num_cols = (num_cols + TILING_TILE_COLS - 1) / TILING_TILE_COLS;
+    tiling->num_cell_rows = num_rows;
+    tiling->num_cell_cols = num_cols;
+    tiling->boundary = boundary;
+    unsigned int num_tiles = Tiling_num_tiles(tiling);
+    tiling->has_changed = malloc(max(num_tiles, 1) * sizeof(bool));
+    tiling->will_change = calloc(max(num_tiles, 1), sizeof(bool));
+    tiling->active = malloc(max(num_tiles, 1) * sizeof(unsigned int));
+    tiling->num_active = 0;
+    for (unsigned int tile = 0; tile < num_tiles; ++tile) {
+        tiling->has_changed[tile] = true;
+    }
+    return tiling;
+}
+
+unsigned int Tiling_num_tiles(const struct Tiling *tiling) {
+    return tiling->num_rows * tiling->num_cols;
+}
+
+void Tiling_schedule(struct Tiling *tiling) {
+    tiling->num_active = 0;
+    for (unsigned int i = 0; i < tiling->num_rows; ++i) {
+        for (unsigned int j = 0; j < tiling->num_cols; ++j) {
+            if (Tiling_is_active(tiling, i, j)) {
+                tiling->active[tiling->num_active++] = i * tiling->num_cols + j;
+            }
+        }
+    }
+    memset(tiling->will_change, false,
+           Tiling_num_tiles(tiling) * sizeof(bool));
+}
+
+void Tiling_get_cells(const struct Tiling *tiling,
+                      unsigned int tile,
+                      unsigned int *first_row,
+                      unsigned int *num_rows,
+                      unsigned int *first_col,
+                      unsigned int *num_cols) {
+    *first_row = tile / tiling->num_cols * TILING_TILE_ROWS;
+    *first_col = tile % tiling->num_cols * TILING_TILE_COLS;
+    *num_rows = min(TILING_TILE_ROWS, tiling->num_cell_rows - *first_row);
+    *num_cols = min(TILING_TILE_COLS, tiling->num_cell_cols - *first_col);
+}
+
+void Tiling_mark_changed(struct Tiling *tiling, unsigned int tile) {
+    tiling->will_change[tile] = true;
+}
+
+void Tiling_end_step(struct Tiling *tiling) {
+    bool *has_changed = tiling->has_changed;
+    tiling->has_changed = tiling->will_change;
+    tiling->will_change = has_changed;
+}
+
+void Tiling_free(struct Tiling *tiling) {
+    free(tiling->has_changed);
+    free(tiling->will_change);
+    free(tiling->active);
+    free(tiling);
+}
@@ -0,0 +1,119 @@
+/**
+ * Provides the tracking of the active tiles of a cellular automaton.
+ *
+ * The grid is split into tiles of `TILING_TILE_ROWS` by `TILING_TILE_COLS`
+ * cells, each having a flag telling if one of its cells changed during the
+ * last step. Since the next state of a cell only depends on its neighbors, a
+ * tile whose cells and whose neighboring tiles did not change cannot change
+ * either: only the other tiles, said to be active, need to be updated.
+ *
+ * Note: a tile of the first row or column borders the last one when the
+ * boundary wraps around.
+ */
+#ifndef TILING_H
+#define TILING_H
+
+#include <stdbool.h>
+#include "cellular.h"
+
+#define TILING_TILE_ROWS 32
+#define TILING_TILE_COLS 256
+
+// ----- //
+// Types //
+// ----- //
+
+/**
+ * The tiles of a grid.
+ *
+ * Tiles are numbered row by row, i.e. the tile `(i, j)` is the tile
+ * `i * num_cols + j`.
+ */
+struct Tiling {
+    unsigned int num_rows;          /**< The number of rows of tiles */
+    unsigned int num_cols;          /**< The number of columns of tiles */
+    unsigned int num_cell_rows;     /**< The number of rows of cells */
+    unsigned int num_cell_cols;     /**< The number of columns of cells */
+    enum CellularBoundary boundary; /**< The boundary type */
+    bool *has_changed;              /**< Did each tile change last step? */
+    bool *will_change;              /**< Does each tile change this step? */
+    unsigned int *active;           /**< The active tiles of this step */
+    unsigned int num_active;        /**< The number of active tiles */
+};
+
+// --------- //
+// Functions //
+// --------- //
+
+/**
+ * Creates the tiling of a grid, all of whose tiles are active.
+ *
+ * @param num_rows  The number of rows of cells
+ * @param num_cols  The number of columns of cells
+ * @param boundary  The boundary type
+ * @return          The tiling
+ */
+struct Tiling *Tiling_init(unsigned int num_rows,
+                           unsigned int num_cols,
+                           enum CellularBoundary boundary);
+
+/**
+ * Returns the number of tiles of a tiling.
+ *
+ * @param tiling  The tiling
+ * @return        The number of tiles
+ */
+unsigned int Tiling_num_tiles(const struct Tiling *tiling);
+
+/**
+ * Lists the active tiles of the next step into `tiling->active`.
+ *
+ * Every tile is then assumed to be unchanged by the step, until marked
+ * otherwise with `Tiling_mark_changed`.
+ *
+ * @param tiling  The tiling
+ */
+void Tiling_schedule(struct Tiling *tiling);
+
+/**
+ * Retrieves the cells of a tile.
+ *
+ * @param tiling     The tiling
+ * @param tile       The index of the tile
+ * @param first_row  The first row of the tile
+ * @param num_rows   The number of rows of the tile
+ * @param first_col  The first column of the tile
+ * @param num_cols   The number of columns of the tile
+ */
+void Tiling_get_cells(const struct Tiling *tiling,
+                      unsigned int tile,
+                      unsigned int *first_row,
+                      unsigned int *num_rows,
+                      unsigned int *first_col,
+                      unsigned int *num_cols);
+
+/**
+ * Marks a tile as changed by the current step.
+ *
+ * Distinct tiles can be marked in parallel.
+ *
+ * @param tiling  The tiling
+ * @param tile    The index of the tile
+ */
+void Tiling_mark_changed(struct Tiling *tiling, unsigned int tile);
+
+/**
+ * Ends the current step, whose changes decide the next active tiles.
+ *
+ * @param tiling  The tiling
+ */
+void Tiling_end_step(struct Tiling *tiling);
+
+/**
+ * Frees a tiling.
+ *
+ * @param tiling  The tiling to free
+ */
+void Tiling_free(struct Tiling *tiling);
+
+#endif